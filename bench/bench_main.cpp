@@ -0,0 +1,375 @@
+// Benchmarks for the propagation, screening and output hot paths.
+//
+// Runs inside a scratch directory (NOVA_BENCH_WORKDIR) holding a copy of the
+// built-in catalogs, so the writers' fixed tests/ paths never touch the
+// source tree. Machine-readable results:
+//   nova_genesis_orbitalguard_bench --benchmark_out=bench.json --benchmark_out_format=json
+
+#include <benchmark/benchmark.h>
+#include <filesystem>
+#include <map>
+
+#include "synthetic_catalog.h"
+#include "simplified_core.h"
+#include "propagation.h"
+#include "track_export.h"
+#include "orbit_prefilter.h"
+#include "lazy_ephemeris.h"
+#include "compact_store.h"
+
+namespace fs = std::filesystem;
+
+namespace {
+
+const uint64_t SEED = 20241223;
+
+// Synthetic catalogs, generated once per size and shared by every benchmark
+const vector<TLE>& catalog_records(size_t n) {
+    static map<size_t, vector<TLE>> cache;
+    auto it = cache.find(n);
+    if (it == cache.end()) {
+        it = cache.emplace(n, vector<TLE>()).first;
+        synthetic_catalog(n, SEED, it->second);
+    }
+    return it->second;
+}
+
+const vector<OrbitalElements>& catalog_elements(size_t n) {
+    static map<size_t, vector<OrbitalElements>> cache;
+    auto it = cache.find(n);
+    if (it == cache.end()) it = cache.emplace(n, synthetic_elements(catalog_records(n))).first;
+    return it->second;
+}
+
+// Screening windows: 6 h at 60 s, propagated once per catalog size
+const double WINDOW_STEP_S = 60.0;
+const size_t WINDOW_STEPS = 6 * 60 + 1;
+
+const TrajectoryStore& catalog_store(size_t n) {
+    static map<size_t, TrajectoryStore> cache;
+    auto it = cache.find(n);
+    if (it == cache.end()) {
+        it = cache.emplace(n, TrajectoryStore()).first;
+        const vector<OrbitalElements>& elements = catalog_elements(n);
+        propagate_batch(elements.data(), elements.size(), SYNTHETIC_EPOCH_MS, WINDOW_STEP_S,
+                        WINDOW_STEPS, it->second);
+        const vector<TLE>& records = catalog_records(n);
+        for (size_t i = 0; i < it->second.count; ++i) store_add_id(it->second, i, records[i].name, false);
+    }
+    return it->second;
+}
+
+void BM_ParseTLEFile(benchmark::State& state) {
+    const size_t n = static_cast<size_t>(state.range(0));
+    const string path = "synthetic_" + to_string(n) + ".tle";
+    const string text = synthetic_catalog_text(catalog_records(n));
+    {
+        ofstream out(path, ios::binary | ios::trunc);
+        out << text;
+    }
+    size_t parsed = 0;
+    for (auto _ : state) {
+        vector<TLE> tles = parseTLEfile(path);
+        parsed = tles.size();
+        benchmark::DoNotOptimize(tles.data());
+    }
+    if (parsed != n) state.SkipWithError("parsed record count does not match the catalog");
+    state.SetItemsProcessed(static_cast<int64_t>(state.iterations() * n));
+    state.SetBytesProcessed(static_cast<int64_t>(state.iterations() * text.size()));
+    fs::remove(path);
+}
+BENCHMARK(BM_ParseTLEFile)->Arg(1000)->Arg(10000)->Arg(50000)->Unit(benchmark::kMillisecond);
+
+// Discards cout while alive (the pipeline loaders report progress there)
+struct QuietCout {
+    streambuf* saved = cout.rdbuf(nullptr);
+    ~QuietCout() { cout.rdbuf(saved); }
+};
+
+// Built-in catalogs from data/, as the pipeline runs them; items are states
+void BM_PropagateCoordsOnly(benchmark::State& state) {
+    const double hours = static_cast<double>(state.range(0));
+    TrajectoryStore store;
+    for (auto _ : state) {
+        QuietCout quiet;
+        if (!propagate_coords_only(store, SYNTHETIC_EPOCH_MS, WINDOW_STEP_S, hours)) {
+            state.SkipWithError("invalid time grid");
+            break;
+        }
+        benchmark::DoNotOptimize(store.data.data());
+    }
+    if (store.count == 0) state.SkipWithError("built-in catalogs not found under data/");
+    state.SetItemsProcessed(static_cast<int64_t>(state.iterations() * store.count * store.steps));
+    state.counters["objects"] = static_cast<double>(store.count);
+}
+BENCHMARK(BM_PropagateCoordsOnly)->Arg(6)->Arg(24)->Unit(benchmark::kMillisecond);
+
+// Batch propagation of a synthetic catalog: args are objects and worker threads
+void BM_PropagateBatch(benchmark::State& state) {
+    const size_t n = static_cast<size_t>(state.range(0));
+    const unsigned threads = static_cast<unsigned>(state.range(1));
+    const vector<OrbitalElements>& elements = catalog_elements(n);
+    TrajectoryStore store;
+    for (auto _ : state) {
+        propagate_batch(elements.data(), elements.size(), SYNTHETIC_EPOCH_MS, WINDOW_STEP_S,
+                        WINDOW_STEPS, store, threads);
+        benchmark::DoNotOptimize(store.data.data());
+    }
+    state.SetItemsProcessed(static_cast<int64_t>(state.iterations() * elements.size() * WINDOW_STEPS));
+}
+BENCHMARK(BM_PropagateBatch)
+    ->ArgNames({"objects", "threads"})
+    ->Args({1000, 1})->Args({10000, 1})->Args({10000, 0})
+    ->Unit(benchmark::kMillisecond);
+
+// Grid screening: args are objects, threshold (m) and worker threads; items
+// are pair-steps (every pair at every step the broad phase stands in for)
+void BM_ScreenByThreshold(benchmark::State& state) {
+    const size_t n = static_cast<size_t>(state.range(0));
+    const double threshold_m = static_cast<double>(state.range(1));
+    const TrajectoryStore& store = catalog_store(n);
+    ScreeningOptions options;
+    options.threads = static_cast<unsigned>(state.range(2));
+    size_t encounters = 0;
+    for (auto _ : state) {
+        vector<Encounter> found = screen_by_threshold(store, threshold_m, options);
+        encounters = found.size();
+        benchmark::DoNotOptimize(found.data());
+    }
+    const double pairs = static_cast<double>(store.count) * (store.count - 1) / 2.0;
+    state.SetItemsProcessed(static_cast<int64_t>(state.iterations() * pairs * store.steps));
+    state.counters["encounters"] = static_cast<double>(encounters);
+}
+BENCHMARK(BM_ScreenByThreshold)
+    ->ArgNames({"objects", "threshold_m", "threads"})
+    ->Args({1000, 5000, 1})->Args({1000, 25000, 1})
+    ->Args({4000, 1000, 1})->Args({4000, 5000, 1})->Args({4000, 25000, 1})
+    ->Args({4000, 5000, 0})
+    ->Unit(benchmark::kMillisecond);
+
+// 1 / 5 / 25 km tiers in one pass: args are objects and worker threads (compare
+// with the sum of the three BM_ScreenByThreshold runs)
+void BM_ScreenByThresholds(benchmark::State& state) {
+    const TrajectoryStore& store = catalog_store(static_cast<size_t>(state.range(0)));
+    ScreeningOptions options;
+    options.threads = static_cast<unsigned>(state.range(1));
+    const vector<double> thresholds = {1000.0, 5000.0, 25000.0};
+    size_t encounters = 0;
+    for (auto _ : state) {
+        vector<EncounterTier> tiers = screen_by_thresholds(store, thresholds, options);
+        encounters = tiers.back().encounters.size();
+        benchmark::DoNotOptimize(tiers.data());
+    }
+    const double pairs = static_cast<double>(store.count) * (store.count - 1) / 2.0;
+    state.SetItemsProcessed(static_cast<int64_t>(state.iterations() * pairs * store.steps));
+    state.counters["encounters"] = static_cast<double>(encounters);
+}
+BENCHMARK(BM_ScreenByThresholds)
+    ->ArgNames({"objects", "threads"})
+    ->Args({4000, 1})
+    ->Unit(benchmark::kMillisecond);
+
+// Grid screening against pair-by-pair stepping over the same prefiltered
+// pairs: args are objects, threshold (m) and mode (0 = grid, 1 = adaptive)
+void BM_ScreenPrefiltered(benchmark::State& state) {
+    const size_t n = static_cast<size_t>(state.range(0));
+    const double threshold_m = static_cast<double>(state.range(1));
+    const TrajectoryStore& store = catalog_store(n);
+    PairPrefilter prefilter;
+    const double hours = (WINDOW_STEPS - 1) * WINDOW_STEP_S / 3600.0;
+    if (build_pair_prefilter(catalog_elements(n), SYNTHETIC_EPOCH_MS, hours,
+                             threshold_m + PREFILTER_PAD_M, prefilter) != PREFILTER_SUCCESS) {
+        state.SkipWithError("prefilter failed");
+        return;
+    }
+    ScreeningOptions options;
+    options.prefilter = &prefilter;
+    size_t encounters = 0;
+    for (auto _ : state) {
+        vector<Encounter> found = state.range(2) ? screen_by_threshold_adaptive(store, threshold_m, options)
+                                                 : screen_by_threshold(store, threshold_m, options);
+        encounters = found.size();
+        benchmark::DoNotOptimize(found.data());
+    }
+    state.counters["pairs"] = static_cast<double>(prefilter.partners.size());
+    state.counters["encounters"] = static_cast<double>(encounters);
+}
+BENCHMARK(BM_ScreenPrefiltered)
+    ->ArgNames({"objects", "threshold_m", "adaptive"})
+    ->Args({4000, 5000, 0})->Args({4000, 5000, 1})
+    ->Args({4000, 25000, 0})->Args({4000, 25000, 1})
+    ->Unit(benchmark::kMillisecond);
+
+// On-demand propagation and screening over prefiltered pairs (no TCA
+// refinement): args are objects and cache size (MB); compare the cache's
+// peak with the eager store (objects * steps * 48 bytes)
+void BM_ScreenLazy(benchmark::State& state) {
+    const size_t n = static_cast<size_t>(state.range(0));
+    const double threshold_m = 5000.0;
+    const double hours = (WINDOW_STEPS - 1) * WINDOW_STEP_S / 3600.0;
+    PipelineCatalog catalog;
+    catalog.elements = catalog_elements(n);
+    for (const TLE& record : catalog_records(n)) catalog.ids.push_back(record.name);
+    catalog.isDebris.assign(n, false);
+    PairPrefilter prefilter;
+    if (build_pair_prefilter(catalog.elements, SYNTHETIC_EPOCH_MS, hours,
+                             threshold_m + PREFILTER_PAD_M, prefilter) != PREFILTER_SUCCESS) {
+        state.SkipWithError("prefilter failed");
+        return;
+    }
+    ScreeningOptions options;
+    options.prefilter = &prefilter;
+    LazyEphemeris eph;
+    size_t encounters = 0;
+    for (auto _ : state) {
+        lazy_ephemeris_open(eph, catalog, SYNTHETIC_EPOCH_MS, WINDOW_STEP_S, hours,
+                            static_cast<size_t>(state.range(1)) << 20);
+        vector<Encounter> found = screen_lazy(eph, threshold_m, options);
+        encounters = found.size();
+        benchmark::DoNotOptimize(found.data());
+    }
+    const double chunkBytes = static_cast<double>(eph.chunkSteps * STORE_COMPONENTS * sizeof(double));
+    state.counters["peak_mb"] = eph.stats.peakChunks * chunkBytes / 1e6;
+    state.counters["chunks_propagated"] = static_cast<double>(eph.stats.misses);
+    state.counters["encounters"] = static_cast<double>(encounters);
+}
+BENCHMARK(BM_ScreenLazy)
+    ->ArgNames({"objects", "cache_mb"})
+    ->Args({4000, 16})->Args({4000, 1024})
+    ->Unit(benchmark::kMillisecond);
+
+// Float32 store screened with exact double rechecks (no TCA refinement):
+// args are objects and threshold (m); compare with BM_ScreenByThreshold
+void BM_ScreenCompact(benchmark::State& state) {
+    const size_t n = static_cast<size_t>(state.range(0));
+    const double threshold_m = static_cast<double>(state.range(1));
+    const double hours = (WINDOW_STEPS - 1) * WINDOW_STEP_S / 3600.0;
+    PipelineCatalog catalog;
+    catalog.elements = catalog_elements(n);
+    for (const TLE& record : catalog_records(n)) catalog.ids.push_back(record.name);
+    catalog.isDebris.assign(n, false);
+    CompactStore compact;
+    if (compact_store_propagate(catalog, SYNTHETIC_EPOCH_MS, WINDOW_STEP_S, hours, compact, 1) !=
+        COMPACT_STORE_SUCCESS) {
+        state.SkipWithError("propagation failed");
+        return;
+    }
+    ScreeningOptions options;
+    options.threads = 1;
+    size_t encounters = 0;
+    for (auto _ : state) {
+        vector<Encounter> found = screen_compact(compact, threshold_m, options);
+        encounters = found.size();
+        benchmark::DoNotOptimize(found.data());
+    }
+    const double pairs = static_cast<double>(compact.count) * (compact.count - 1) / 2.0;
+    state.SetItemsProcessed(static_cast<int64_t>(state.iterations() * pairs * compact.steps));
+    state.counters["store_mb"] = compact.data.size() * sizeof(float) / 1e6;
+    state.counters["encounters"] = static_cast<double>(encounters);
+}
+BENCHMARK(BM_ScreenCompact)
+    ->ArgNames({"objects", "threshold_m"})
+    ->Args({4000, 1000})->Args({4000, 5000})->Args({4000, 25000})
+    ->Unit(benchmark::kMillisecond);
+
+// coordinates.json writer over a screened window: arg is objects
+void BM_WriteTracksJSON(benchmark::State& state) {
+    const TrajectoryStore& store = catalog_store(static_cast<size_t>(state.range(0)));
+    const string path = "tests/coordinates.json";
+    TrackExportOptions options;
+    for (auto _ : state) {
+        if (write_tracks_json(path, store, options) != TRACK_EXPORT_SUCCESS) {
+            state.SkipWithError("could not write tests/coordinates.json");
+            break;
+        }
+    }
+    state.SetBytesProcessed(static_cast<int64_t>(state.iterations() * fs::file_size(path)));
+}
+BENCHMARK(BM_WriteTracksJSON)->Arg(1000)->Arg(4000)->Unit(benchmark::kMillisecond);
+
+// conjunctions.json writer: arg is encounters
+void BM_WriteEncountersJSON(benchmark::State& state) {
+    const size_t count = static_cast<size_t>(state.range(0));
+    const TrajectoryStore& store = catalog_store(1000);
+    vector<Encounter> encounters(count);
+    for (size_t e = 0; e < count; ++e) {
+        Encounter& enc = encounters[e];
+        enc.aIndex = static_cast<uint32_t>(e % (store.count - 1));
+        enc.bIndex = enc.aIndex + 1;
+        enc.t = SYNTHETIC_EPOCH_MS + (e % WINDOW_STEPS) * WINDOW_STEP_S * 1000.0;
+        enc.miss_m = 1234.5678 + e;
+        enc.rel_mps = 7654.321;
+        enc.severity = static_cast<int>(e % 4);
+        enc.pc = e % 2 ? 1.0e-5 : numeric_limits<double>::quiet_NaN();
+    }
+    for (auto _ : state) {
+        writeEncountersJSON(encounters, store.ids, SYNTHETIC_EPOCH_MS);
+    }
+    state.SetBytesProcessed(static_cast<int64_t>(state.iterations() * fs::file_size("tests/conjunctions.json")));
+}
+BENCHMARK(BM_WriteEncountersJSON)->Arg(1000)->Arg(100000)->Unit(benchmark::kMillisecond);
+
+// Risk ranking: args are encounters, k (0 = full sort_encounters_by_risk)
+// and worker threads; Pc values are spread so ties are rare
+void BM_RankEncounters(benchmark::State& state) {
+    const size_t count = static_cast<size_t>(state.range(0));
+    const size_t k = static_cast<size_t>(state.range(1));
+    const unsigned threads = static_cast<unsigned>(state.range(2));
+    vector<Encounter> encounters(count);
+    uint64_t x = SEED;
+    for (size_t e = 0; e < count; ++e) {
+        x = x * 6364136223846793005ULL + 1442695040888963407ULL;
+        Encounter& enc = encounters[e];
+        enc.aIndex = static_cast<uint32_t>(e % 4000);
+        enc.bIndex = enc.aIndex + 1;
+        enc.t = SYNTHETIC_EPOCH_MS + (e % WINDOW_STEPS) * WINDOW_STEP_S * 1000.0;
+        enc.miss_m = static_cast<double>(x >> 52);
+        enc.rel_mps = 7654.321;
+        enc.severity = static_cast<int>(x % 5);
+        enc.pc = x % 8 ? ldexp(static_cast<double>(x >> 40), -60) : numeric_limits<double>::quiet_NaN();
+    }
+    vector<Encounter> work;
+    for (auto _ : state) {
+        if (k) {
+            work = top_encounters_by_risk(encounters.data(), count, k, 0.0, threads);
+        } else {
+            work = encounters;
+            sort_encounters_by_risk(work.data(), count, threads);
+        }
+        benchmark::DoNotOptimize(work.data());
+    }
+    state.SetItemsProcessed(static_cast<int64_t>(state.iterations() * count));
+}
+BENCHMARK(BM_RankEncounters)
+    ->ArgNames({"encounters", "k", "threads"})
+    ->Args({1000000, 100, 1})->Args({1000000, 100, 0})
+    ->Args({1000000, 0, 1})->Args({1000000, 0, 0})
+    ->Unit(benchmark::kMillisecond);
+
+// Scratch directory with tests/ and a copy of data/*.tle
+bool enter_workdir() {
+    error_code ec;
+    const fs::path work = NOVA_BENCH_WORKDIR;
+    fs::create_directories(work / "tests", ec);
+    fs::create_directories(work / "data", ec);
+    const fs::path source = fs::path(NOVA_SOURCE_DIR) / "data";
+    for (const char* name : {"satellites_1000.tle", "debris_3000.tle"}) {
+        fs::copy_file(source / name, work / "data" / name, fs::copy_options::overwrite_existing, ec);
+    }
+    fs::current_path(work, ec);
+    return !ec;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    if (!enter_workdir()) {
+        cerr << "cannot use benchmark directory " << NOVA_BENCH_WORKDIR << endl;
+        return 1;
+    }
+    benchmark::Initialize(&argc, argv);
+    if (benchmark::ReportUnrecognizedArguments(argc, argv)) return 1;
+    benchmark::RunSpecifiedBenchmarks();
+    benchmark::Shutdown();
+    return 0;
+}
@@ -0,0 +1,117 @@
+#include "synthetic_catalog.h"
+#include "propagation.h"
+#include "constants.h"
+#include <cstdio>
+#include <cstring>
+
+namespace {
+
+// splitmix64: small, fast and identical on every platform (unlike the
+// standard distributions)
+struct SplitMix {
+    uint64_t state;
+    uint64_t next() {
+        uint64_t z = (state += 0x9e3779b97f4a7c15ull);
+        z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ull;
+        z = (z ^ (z >> 27)) * 0x94d049bb133111ebull;
+        return z ^ (z >> 31);
+    }
+    double uniform(double lo, double hi) {
+        return lo + (hi - lo) * static_cast<double>(next() >> 11) * (1.0 / 9007199254740992.0);
+    }
+};
+
+// Orbit family: share of the catalog, altitude (km) and eccentricity ranges
+struct Regime {
+    double share;
+    double altLo, altHi;
+    double eccLo, eccHi;
+};
+
+// Roughly the mix generate_tle_data.py produces: mostly LEO, some MEO and
+// debris on eccentric LEO orbits, a few HEO/GTO objects
+const Regime REGIMES[] = {
+    {0.65, 400.0, 1400.0, 0.0001, 0.0200},
+    {0.20, 300.0, 1800.0, 0.0050, 0.1000},
+    {0.10, 2000.0, 24000.0, 0.0001, 0.0500},
+    {0.05, 300.0, 40000.0, 0.6000, 0.7300},
+};
+
+// TLE line checksum: digits plus one per minus sign, mod 10
+int tle_checksum(const char* line, size_t len) {
+    int sum = 0;
+    for (size_t c = 0; c < len; ++c) {
+        if (line[c] >= '0' && line[c] <= '9') sum += line[c] - '0';
+        else if (line[c] == '-') sum += 1;
+    }
+    return sum % 10;
+}
+
+} // namespace
+
+void synthetic_catalog(size_t count, uint64_t seed, vector<TLE>& out) {
+    out.clear();
+    out.reserve(count);
+    SplitMix rng = {seed};
+    for (size_t i = 0; i < count; ++i) {
+        const double pick = rng.uniform(0.0, 1.0);
+        const Regime* regime = &REGIMES[0];
+        double acc = 0.0;
+        for (const Regime& r : REGIMES) {
+            regime = &r;
+            acc += r.share;
+            if (pick < acc) break;
+        }
+
+        // Apogee altitude from the regime; perigee kept above 150 km
+        const double ecc0 = rng.uniform(regime->eccLo, regime->eccHi);
+        const double apogee = EARTH_RADIUS + rng.uniform(regime->altLo, regime->altHi);
+        const double a = max(apogee / (1.0 + ecc0), EARTH_RADIUS + 150.0);
+        const double ecc = min(ecc0, 1.0 - (EARTH_RADIUS + 150.0) / a);
+        const double meanMotion = sqrt(MU / (a * a * a)) * 86400.0 / TWO_PI;
+
+        const unsigned norad = static_cast<unsigned>(10001 + i % 89999);
+        const double inc = rng.uniform(0.0, 180.0);
+        const double raan = rng.uniform(0.0, 360.0);
+        const double argp = rng.uniform(0.0, 360.0);
+        const double ma = rng.uniform(0.0, 360.0);
+
+        TLE tle;
+        char name[32];
+        snprintf(name, sizeof(name), "SYN-%06zu", i + 1);
+        tle.name = name;
+        int n = snprintf(tle.line1, sizeof(tle.line1),
+                         "1 %05uU 24001A   24358.00000000  .00000000  00000-0  00000-0 0  %03u",
+                         norad, static_cast<unsigned>(i % 1000));
+        snprintf(tle.line1 + n, sizeof(tle.line1) - n, "%d", tle_checksum(tle.line1, n));
+        n = snprintf(tle.line2, sizeof(tle.line2), "2 %05u %8.4f %8.4f %07d %8.4f %8.4f %11.8f%05u",
+                     norad, inc, raan, static_cast<int>(ecc * 1e7), argp, ma, meanMotion,
+                     static_cast<unsigned>(i % 100000));
+        snprintf(tle.line2 + n, sizeof(tle.line2) - n, "%d", tle_checksum(tle.line2, n));
+        out.push_back(tle);
+    }
+}
+
+string synthetic_catalog_text(const vector<TLE>& records) {
+    string text;
+    text.reserve(records.size() * 168);
+    for (const TLE& tle : records) {
+        text += tle.name;
+        text += '\n';
+        text += tle.line1;
+        text += '\n';
+        text += tle.line2;
+        text += '\n';
+    }
+    return text;
+}
+
+vector<OrbitalElements> synthetic_elements(const vector<TLE>& records) {
+    vector<OrbitalElements> elements;
+    elements.reserve(records.size());
+    for (const TLE& tle : records) {
+        OrbitalElements el;
+        if (tle_to_elements(&tle, &el) == PROPAGATION_SUCCESS) elements.push_back(el);
+    }
+    return elements;
+}
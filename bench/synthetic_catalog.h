@@ -0,0 +1,27 @@
+#ifndef SYNTHETIC_CATALOG_H
+#define SYNTHETIC_CATALOG_H
+
+#include "types.h"
+
+// Epoch of every synthetic record: 2024 day 358.0 (2024-12-23T00:00Z), the
+// same day the pipeline screens by default
+const double SYNTHETIC_EPOCH_MS = 1734912000000.0;
+
+/**
+ * Deterministic catalog of count objects spread over LEO, MEO and a few
+ * eccentric orbits, in the 3-line format of generate_tle_data.py (with
+ * valid checksums). The same count and seed always give the same records.
+ *
+ * @param count Number of objects (NORAD numbers 10001 onwards, wrapping at 99999)
+ * @param seed Generator seed
+ * @param out Output records
+ */
+void synthetic_catalog(size_t count, uint64_t seed, vector<TLE>& out);
+
+// Catalog text as parseTLEfile reads it
+string synthetic_catalog_text(const vector<TLE>& records);
+
+// Parsed elements of the records, in order (records that fail to parse are skipped)
+vector<OrbitalElements> synthetic_elements(const vector<TLE>& records);
+
+#endif // SYNTHETIC_CATALOG_H
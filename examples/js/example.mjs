@@ -0,0 +1,58 @@
+/**
+ * WebAssembly example for the OrbitalGuard C ABI (include/og_capi.h)
+ *
+ * Prerequisites:
+ * 1. Build the module: see examples/js/README.md (writes frontend/public/wasm/)
+ * 2. Run from the repository root: node examples/js/example.mjs
+ */
+import { readFileSync } from 'node:fs';
+
+const OG_SCREEN_PREFILTER = 1;
+const OG_SCREEN_REFINE = 2;
+const OG_SCREEN_PC = 4;
+const OG_PLANE_X = 0;
+
+// Copy a TLE file's text into the heap and append its records
+function addCatalog(og, ctx, path, isDebris) {
+    const bytes = readFileSync(path);
+    const ptr = og._malloc(bytes.length);
+    og.HEAPU8.set(bytes, ptr);
+    const code = og._og_add_tle_text(ctx, ptr, bytes.length, isDebris);
+    og._free(ptr);
+    if (code !== 0) throw new Error(`og_add_tle_text failed with error ${code}`);
+}
+
+const { default: createOrbitalGuard } = await import('../../frontend/public/wasm/orbitalguard.js');
+const og = await createOrbitalGuard();
+const ctx = og._og_create();
+
+addCatalog(og, ctx, 'data/satellites_1000.tle', 0);
+addCatalog(og, ctx, 'data/debris_3000.tle', 1);
+const count = og._og_object_count(ctx);
+console.log(`Loaded ${count} objects`);
+
+if (og._og_propagate(ctx, Date.UTC(2025, 0, 1), 60, 24) !== 0) throw new Error('og_propagate failed');
+const steps = og._og_store_steps(ctx);
+
+// Zero-copy view of the x plane: object i at step k is x[k * count + i]
+const x = new Float64Array(og.HEAPU8.buffer, og._og_store_plane(ctx, OG_PLANE_X), steps * count);
+console.log(`Propagated ${steps} steps; object 0 starts at x = ${x[0].toFixed(3)} km`);
+
+if (og._og_screen(ctx, 5000, OG_SCREEN_PREFILTER | OG_SCREEN_REFINE | OG_SCREEN_PC) !== 0) {
+    throw new Error('og_screen failed');
+}
+
+// Encounter records are 48 bytes: a, b as u32 words 0-1, then t, miss, speed, Pc as f64 words 1-4
+const found = og._og_encounter_count(ctx);
+const ptr = og._og_encounters(ctx);
+const u32 = new Uint32Array(og.HEAPU8.buffer, ptr, found * 12);
+const f64 = new Float64Array(og.HEAPU8.buffer, ptr, found * 6);
+console.log(`${found} encounters within 5 km`);
+for (let e = 0; e < Math.min(found, 10); ++e) {
+    const a = og.UTF8ToString(og._og_object_name(ctx, u32[e * 12]));
+    const b = og.UTF8ToString(og._og_object_name(ctx, u32[e * 12 + 1]));
+    console.log(`  ${a} / ${b}: ${new Date(f64[e * 6 + 1]).toISOString()}, ` +
+                `${f64[e * 6 + 2].toFixed(0)} m at ${f64[e * 6 + 3].toFixed(0)} m/s, Pc ${f64[e * 6 + 4].toExponential(2)}`);
+}
+
+og._og_destroy(ctx);
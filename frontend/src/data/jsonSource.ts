@@ -1,4 +1,4 @@
-import type { CoordinatesJson, ConjunctionsJson } from "../types/tle";
+import type { CoordinatesJson, ConjunctionsJson, TrackBlob, TrackBlobObject } from "../types/tle";
 import { validateCoordinatesJson, validateConjunctionsJson } from "../types/tle";
 import { Track, StateECI, AnalysisResult, Encounter, TleEntry, BodyKind } from "../domain/types";
 
@@ -32,6 +32,13 @@ export class JsonDataAdapter {
     return data;
   }
 
+  // Load the binary full time series written next to coordinates.json
+  async loadTrackBlobFromUrl(url: string): Promise<TrackBlob> {
+    const res = await fetch(url, { cache: "no-store" });
+    if (!res.ok) throw new Error(`Failed to fetch ${url}: ${res.status}`);
+    return parseTrackBlob(await res.arrayBuffer());
+  }
+
   // Load both coordinates and conjunctions from public directory
   async loadAllData(): Promise<{ coordinates: CoordinatesJson; conjunctions: ConjunctionsJson }> {
     const [coordinates, conjunctions] = await Promise.all([
@@ -45,6 +52,24 @@ export class JsonDataAdapter {
   // Convert coordinates JSON to Track format for compatibility
   coordinatesToTracks(coordinates: CoordinatesJson): Track[] {
     return coordinates.satellites.map((sat, index) => {
+      const kind = (sat.kind ?? "satellite") as BodyKind;
+      const series = sat.positions_km;
+      const startMs = coordinates.start_ms;
+
+      // Full time series when the backend exported one (positions only)
+      if (series && series.length >= 3 && startMs !== undefined) {
+        const stepMs = (coordinates.step_seconds ?? 60) * 1000 * (sat.stride ?? 1);
+        const states: StateECI[] = [];
+        for (let s = 0; s + 2 < series.length; s += 3) {
+          states.push({
+            t: startMs + (s / 3) * stepMs,
+            r: [series[s], series[s + 1], series[s + 2]],
+            v: [0, 0, 0]
+          });
+        }
+        return { id: `satellite_${index}`, kind, states };
+      }
+
       const state: StateECI = {
         t: coordinates.timestamp_minutes * 60 * 1000, // convert to milliseconds
         r: sat.position_km,
@@ -53,12 +78,31 @@ export class JsonDataAdapter {
 
       return {
         id: `satellite_${index}`,
-        kind: "satellite" as BodyKind,
+        kind,
         states: [state] // Single state for now, can be extended
       };
     });
   }
 
+  // Convert a track blob to Track format (copies samples into StateECI objects)
+  trackBlobToTracks(blob: TrackBlob): Track[] {
+    const c = blob.components;
+    return blob.objects.map((obj, index) => {
+      const states: StateECI[] = [];
+      const stepMs = blob.stepMs * obj.stride;
+      for (let s = 0; s * c < obj.samples.length; s++) {
+        const f = obj.samples;
+        const o = s * c;
+        states.push({
+          t: blob.startMs + s * stepMs,
+          r: [f[o], f[o + 1], f[o + 2]],
+          v: c >= 6 ? [f[o + 3], f[o + 4], f[o + 5]] : [0, 0, 0]
+        });
+      }
+      return { id: `satellite_${index}`, kind: obj.kind as BodyKind, states };
+    });
+  }
+
   // Convert conjunctions JSON to AnalysisResult format
   conjunctionsToAnalysisResult(conjunctions: ConjunctionsJson): AnalysisResult {
     const encounters: Encounter[] = conjunctions.conjunction_pairs.map(pair => {
@@ -71,10 +115,12 @@ export class JsonDataAdapter {
       else if (missMeters < 5000) severity = "Medium";
       else severity = "Low";
 
-      // Calculate probability proxy
+      // Backend Pc when present, otherwise a distance-based proxy
       const k = 0.001;
       const d0 = 1000;
-      const pcProxy = 1 / (1 + Math.exp(k * (missMeters - d0)));
+      const pcProxy = typeof pair.collision_probability === 'number'
+        ? pair.collision_probability
+        : 1 / (1 + Math.exp(k * (missMeters - d0)));
 
       return {
         aId: pair.satellite_a,
@@ -128,4 +174,41 @@ export class JsonDataAdapter {
   }
 }
 
+// Parse coordinates.bin (layout documented in include/track_export.h)
+export function parseTrackBlob(buffer: ArrayBuffer): TrackBlob {
+  const view = new DataView(buffer);
+  const magic = new TextDecoder().decode(new Uint8Array(buffer, 0, 7));
+  if (buffer.byteLength < 64 || magic !== "OGTRACK") throw new Error("Not a track blob");
+  if (view.getUint32(8, true) !== 1) throw new Error("Unsupported track blob version");
+
+  const count = view.getUint32(12, true);
+  const components = view.getUint32(20, true);
+  const startMs = view.getFloat64(24, true);
+  const stepMs = view.getFloat64(32, true);
+  const objectsOffset = view.getUint32(40, true);
+  const namesOffset = view.getUint32(44, true);
+  const samplesOffset = view.getUint32(52, true);
+  const sampleFloats = view.getUint32(56, true);
+
+  const samples = new Float32Array(buffer, samplesOffset, sampleFloats);
+  const decoder = new TextDecoder();
+  const objects: TrackBlobObject[] = [];
+  for (let i = 0; i < count; i++) {
+    const o = objectsOffset + i * 24;
+    const stride = view.getUint32(o, true);
+    const n = view.getUint32(o + 4, true);
+    const first = view.getUint32(o + 8, true);
+    const nameOffset = view.getUint32(o + 12, true);
+    const nameBytes = view.getUint32(o + 16, true);
+    objects.push({
+      name: decoder.decode(new Uint8Array(buffer, namesOffset + nameOffset, nameBytes)),
+      kind: view.getUint32(o + 20, true) ? "debris" : "satellite",
+      stride,
+      samples: samples.subarray(first, first + n * components)
+    });
+  }
+
+  return { startMs, stepMs, components, objects };
+}
+
 export const jsonDataAdapter = new JsonDataAdapter();
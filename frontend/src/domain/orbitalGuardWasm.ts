@@ -0,0 +1,171 @@
+// Typed wrapper over the WASM build of the C ABI (include/og_capi.h).
+// Bulk results are returned as typed-array views of the module's linear
+// memory, not copies. Views are only valid until the next call on the
+// session: any call may grow memory and detach the old buffer.
+import { BodyKind } from './types';
+
+// Exports of orbitalguard.js (see OG_WASM_EXPORTS in CMakeLists.txt)
+export interface OrbitalGuardModule {
+  HEAPU8: Uint8Array;
+  HEAPU32: Uint32Array;
+  HEAPF64: Float64Array;
+  UTF8ToString(ptr: number): string;
+  _malloc(bytes: number): number;
+  _free(ptr: number): void;
+  _og_create(): number;
+  _og_destroy(ctx: number): void;
+  _og_clear(ctx: number): void;
+  _og_add_tle_text(ctx: number, text: number, length: number, isDebris: number): number;
+  _og_object_count(ctx: number): number;
+  _og_object_name(ctx: number, i: number): number;
+  _og_object_is_debris(ctx: number, i: number): number;
+  _og_propagate(ctx: number, startMs: number, stepSeconds: number, durationHours: number): number;
+  _og_store_steps(ctx: number): number;
+  _og_store_times(ctx: number): number;
+  _og_store_plane(ctx: number, plane: number): number;
+  _og_screen(ctx: number, thresholdM: number, flags: number): number;
+  _og_encounter_count(ctx: number): number;
+  _og_encounters(ctx: number): number;
+}
+
+export type OrbitalGuardFactory = () => Promise<OrbitalGuardModule>;
+
+// Default location of the module built by the orbitalguard _wasm target
+export const ORBITAL_GUARD_WASM_URL = '/wasm/orbitalguard.js';
+
+// og_screen flags
+export const OG_SCREEN_PREFILTER = 1;
+export const OG_SCREEN_REFINE = 2;
+export const OG_SCREEN_PC = 4;
+
+// Store planes, object i at step k is plane[k * objectCount + i]
+export enum StorePlane { X = 0, Y, Z, VX, VY, VZ }
+
+// og_encounter is 48 bytes: 12 u32 words or 6 f64 words per record
+const ENCOUNTER_WORDS_U32 = 12;
+const ENCOUNTER_WORDS_F64 = 6;
+
+export interface WasmEncounter {
+  a: number;
+  b: number;
+  t: number;        // Unix ms
+  missMeters: number;
+  relSpeedMps: number;
+  pc: number;       // NaN unless screened with OG_SCREEN_PC
+  severity: number; // 0 (no risk) .. 4 (collision imminent)
+}
+
+// Both word views over the same encounter records
+export interface EncounterViews {
+  count: number;
+  u32: Uint32Array;
+  f64: Float64Array;
+}
+
+export function encounterAt(views: EncounterViews, e: number): WasmEncounter {
+  const w = e * ENCOUNTER_WORDS_U32;
+  const d = e * ENCOUNTER_WORDS_F64;
+  return {
+    a: views.u32[w],
+    b: views.u32[w + 1],
+    t: views.f64[d + 1],
+    missMeters: views.f64[d + 2],
+    relSpeedMps: views.f64[d + 3],
+    pc: views.f64[d + 4],
+    severity: views.u32[w + 10] | 0
+  };
+}
+
+export class OrbitalGuardSession {
+  private ctx: number;
+
+  constructor(private readonly module: OrbitalGuardModule) {
+    this.ctx = module._og_create();
+    if (!this.ctx) throw new Error('og_create failed');
+  }
+
+  static async load(url: string = ORBITAL_GUARD_WASM_URL): Promise<OrbitalGuardSession> {
+    const imported = await import(/* @vite-ignore */ url);
+    const factory = imported.default as OrbitalGuardFactory;
+    return new OrbitalGuardSession(await factory());
+  }
+
+  dispose(): void {
+    if (this.ctx) this.module._og_destroy(this.ctx);
+    this.ctx = 0;
+  }
+
+  clear(): void {
+    this.module._og_clear(this.ctx);
+  }
+
+  // Appends the records of a TLE file's text; the text is copied into the heap once
+  addTleText(text: string, kind: BodyKind): void {
+    const bytes = new TextEncoder().encode(text);
+    const ptr = this.module._malloc(Math.max(bytes.length, 1));
+    try {
+      this.module.HEAPU8.set(bytes, ptr);
+      this.check(this.module._og_add_tle_text(this.ctx, ptr, bytes.length, kind === 'debris' ? 1 : 0),
+                 'og_add_tle_text');
+    } finally {
+      this.module._free(ptr);
+    }
+  }
+
+  get objectCount(): number {
+    return this.module._og_object_count(this.ctx) >>> 0;
+  }
+
+  objectName(i: number): string {
+    return this.module.UTF8ToString(this.module._og_object_name(this.ctx, i));
+  }
+
+  objectKind(i: number): BodyKind {
+    return this.module._og_object_is_debris(this.ctx, i) ? 'debris' : 'satellite';
+  }
+
+  propagate(startMs: number, stepSeconds: number, durationHours: number): void {
+    this.check(this.module._og_propagate(this.ctx, startMs, stepSeconds, durationHours), 'og_propagate');
+  }
+
+  get steps(): number {
+    return this.module._og_store_steps(this.ctx) >>> 0;
+  }
+
+  // Sample times (Unix ms), a view of linear memory
+  times(): Float64Array {
+    return this.f64View(this.module._og_store_times(this.ctx), this.steps);
+  }
+
+  // One component plane (km or km/s), a view of linear memory
+  plane(plane: StorePlane): Float64Array {
+    return this.f64View(this.module._og_store_plane(this.ctx, plane), this.steps * this.objectCount);
+  }
+
+  screen(thresholdM: number, flags: number = OG_SCREEN_PREFILTER | OG_SCREEN_REFINE): EncounterViews {
+    this.check(this.module._og_screen(this.ctx, thresholdM, flags), 'og_screen');
+    return this.encounters();
+  }
+
+  // Result of the last screen, as views of linear memory
+  encounters(): EncounterViews {
+    const count = this.module._og_encounter_count(this.ctx) >>> 0;
+    const ptr = this.module._og_encounters(this.ctx);
+    const buffer = this.module.HEAPU8.buffer;
+    return {
+      count,
+      u32: new Uint32Array(buffer, ptr, count * ENCOUNTER_WORDS_U32),
+      f64: new Float64Array(buffer, ptr, count * ENCOUNTER_WORDS_F64)
+    };
+  }
+
+  // Views are built on the current buffer, which moves when memory grows
+  private f64View(ptr: number, length: number): Float64Array {
+    if (!ptr) return new Float64Array(0);
+    return new Float64Array(this.module.HEAPU8.buffer, ptr, length);
+  }
+
+  private check(code: number, call: string): void {
+    if (code !== 0) throw new Error(`${call} failed with error ${code}`);
+  }
+}
@@ -1,21 +1,34 @@
 // WASM bridge for C++ orbital mechanics functions
-import { TleEntry, Track, AnalysisResult, BodyKind } from './types';
+import { TleEntry, Track, AnalysisResult, BodyKind, Encounter, Severity, StateECI } from './types';
+import { OrbitalGuardSession, StorePlane, encounterAt,
+         OG_SCREEN_PREFILTER, OG_SCREEN_REFINE, OG_SCREEN_PC } from './orbitalGuardWasm';
 
-// For now, we'll use a mock implementation until WASM is compiled
-// This maintains the exact API contract specified
+// Screening distance of runAnalysis
+const ANALYSIS_THRESHOLD_M = 25000;
+
+// Uses the WASM build of the C++ library when public/wasm/orbitalguard.js
+// is present; otherwise falls back to the JavaScript mock below with the
+// same API contract
 
 export class WasmBridge {
-  // private _module: any = null; // TODO: Will be used when WASM is loaded
+  private session: OrbitalGuardSession | null = null;
+  private simulatedIds: string[] = []; // track ids of the session's store, by object index
   private initialized = false;
 
   async init(): Promise<void> {
     if (this.initialized) return;
-    
-    // TODO: Load actual WASM module when compiled
-    // For now, use mock implementation
+    try {
+      this.session = await OrbitalGuardSession.load();
+    } catch {
+      this.session = null; // module not built: keep the mock
+    }
     this.initialized = true;
   }
 
+  get usingWasm(): boolean {
+    return this.session !== null;
+  }
+
   // Parse TLE text into JSON array of {name,line1,line2,kind}
   parseTle(text: string, kind: BodyKind): TleEntry[] {
     const lines = text.trim().split('\n').map(l => l.trim()).filter(l => l);
@@ -38,6 +51,8 @@ export class WasmBridge {
   // Propagate all bodies over window
   // Returns array of Track {id,kind,states:[{t,r[3],v[3]}]}
   computeSimulation(tleEntries: TleEntry[], startMs: number, stopMs: number, stepS: number): Track[] {
+    if (this.session) return this.computeSimulationWasm(this.session, tleEntries, startMs, stopMs, stepS);
+
     const tracks: Track[] = [];
     const duration = stopMs - startMs;
     const steps = Math.floor(duration / (stepS * 1000));
@@ -136,6 +151,8 @@ export class WasmBridge {
   // Screen conjunctions; severity buckets
   // Returns { encounters: [...] }
   runAnalysis(tracks: Track[], _syncTolS: number): AnalysisResult {
+    if (this.session && this.isSimulated(tracks)) return this.runAnalysisWasm(this.session, tracks);
+
     const encounters = [];
     
     // Mock conjunction analysis
@@ -196,6 +213,74 @@ export class WasmBridge {
     
     return { encounters };
   }
+
+  // Propagates in the module; tracks are filled from views of its store planes.
+  // The viewer's Track type holds one {t, r, v} object per sample, so this
+  // still copies every state into JS objects. Callers that can work on the
+  // planes (session.plane / session.times) should read them directly instead.
+  private computeSimulationWasm(session: OrbitalGuardSession, tleEntries: TleEntry[],
+                                startMs: number, stopMs: number, stepS: number): Track[] {
+    // One text per run of entries of the same kind keeps object indices in entry order
+    session.clear();
+    for (let begin = 0; begin < tleEntries.length;) {
+      let end = begin;
+      const lines: string[] = [];
+      while (end < tleEntries.length && tleEntries[end].kind === tleEntries[begin].kind) {
+        const tle = tleEntries[end++];
+        lines.push(tle.name, tle.line1, tle.line2);
+      }
+      session.addTleText(lines.join('\n'), tleEntries[begin].kind);
+      begin = end;
+    }
+    session.propagate(startMs, stepS, (stopMs - startMs) / 3600000);
+
+    const count = session.objectCount;
+    const steps = session.steps;
+    const times = session.times();
+    const planes = [StorePlane.X, StorePlane.Y, StorePlane.Z, StorePlane.VX, StorePlane.VY, StorePlane.VZ]
+      .map((plane) => session.plane(plane));
+    const tracks: Track[] = [];
+    for (let i = 0; i < count; ++i) {
+      const states: StateECI[] = new Array(steps);
+      for (let k = 0, at = i; k < steps; ++k, at += count) {
+        states[k] = {
+          t: times[k],
+          r: [planes[0][at], planes[1][at], planes[2][at]],
+          v: [planes[3][at], planes[4][at], planes[5][at]]
+        };
+      }
+      const kind = session.objectKind(i);
+      tracks.push({ id: `${kind}_${i}`, kind, states });
+    }
+    this.simulatedIds = tracks.map((track) => track.id);
+    return tracks;
+  }
+
+  // True if these are the tracks the session last propagated
+  private isSimulated(tracks: Track[]): boolean {
+    return tracks.length === this.simulatedIds.length &&
+      tracks.every((track, i) => track.id === this.simulatedIds[i]);
+  }
+
+  private runAnalysisWasm(session: OrbitalGuardSession, tracks: Track[]): AnalysisResult {
+    const views = session.screen(ANALYSIS_THRESHOLD_M,
+                                 OG_SCREEN_PREFILTER | OG_SCREEN_REFINE | OG_SCREEN_PC);
+    const encounters: Encounter[] = [];
+    for (let e = 0; e < views.count; ++e) {
+      const found = encounterAt(views, e);
+      const severity: Severity = found.severity >= 3 ? "High" : found.severity === 2 ? "Medium" : "Low";
+      encounters.push({
+        aId: tracks[found.a].id,
+        bId: tracks[found.b].id,
+        tcaUtc: found.t,
+        missMeters: found.missMeters,
+        relSpeedMps: found.relSpeedMps,
+        pcProxy: Number.isFinite(found.pc) ? found.pc : 0,
+        severity
+      });
+    }
+    return { encounters };
+  }
 }
 
 export const wasmBridge = new WasmBridge();
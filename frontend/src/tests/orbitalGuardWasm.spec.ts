@@ -0,0 +1,139 @@
+import { describe, it, expect, beforeEach } from 'vitest';
+import { OrbitalGuardModule, OrbitalGuardSession, StorePlane, encounterAt,
+         OG_SCREEN_REFINE } from '../domain/orbitalGuardWasm';
+
+type FakeModule = OrbitalGuardModule & { grow(): void; lastText: string; lastFlags: number };
+
+// Stand-in for the compiled module: a bump-allocated heap laid out the way
+// og_capi.cpp lays out its store and encounter records
+function fakeModule(): FakeModule {
+  let buffer = new ArrayBuffer(1 << 16);
+  let top = 64;
+  const count = 2;
+  const steps = 3;
+  let times = 0;
+  let planes = 0;
+  let encounters = 0;
+
+  const malloc = (bytes: number) => {
+    const ptr = top;
+    top += (bytes + 7) & ~7;
+    return ptr;
+  };
+
+  const module: FakeModule = {
+    HEAPU8: new Uint8Array(buffer),
+    HEAPU32: new Uint32Array(buffer),
+    HEAPF64: new Float64Array(buffer),
+    lastText: '',
+    lastFlags: -1,
+    grow() {
+      // Same as ALLOW_MEMORY_GROWTH: contents move to a new, larger buffer
+      const next = new ArrayBuffer(buffer.byteLength * 2);
+      new Uint8Array(next).set(new Uint8Array(buffer));
+      buffer = next;
+      module.HEAPU8 = new Uint8Array(buffer);
+      module.HEAPU32 = new Uint32Array(buffer);
+      module.HEAPF64 = new Float64Array(buffer);
+    },
+    UTF8ToString: (ptr: number) => (ptr === 8 ? 'SAT-A' : 'DEB-B'),
+    _malloc: malloc,
+    _free: () => {},
+    _og_create: () => 1,
+    _og_destroy: () => {},
+    _og_clear: () => {},
+    _og_add_tle_text: (_ctx: number, text: number, length: number) => {
+      module.lastText = new TextDecoder().decode(module.HEAPU8.subarray(text, text + length));
+      return 0;
+    },
+    _og_object_count: () => count,
+    _og_object_name: (_ctx: number, i: number) => (i === 0 ? 8 : 16),
+    _og_object_is_debris: (_ctx: number, i: number) => i,
+    _og_propagate: () => {
+      times = malloc(steps * 8);
+      planes = malloc(6 * steps * count * 8);
+      for (let k = 0; k < steps; ++k) module.HEAPF64[times / 8 + k] = 1000 * k;
+      for (let v = 0; v < 6 * steps * count; ++v) module.HEAPF64[planes / 8 + v] = v;
+      return 0;
+    },
+    _og_store_steps: () => (times ? steps : 0),
+    _og_store_times: () => times,
+    _og_store_plane: (_ctx: number, plane: number) => planes + plane * steps * count * 8,
+    _og_screen: (_ctx: number, _threshold: number, flags: number) => {
+      module.lastFlags = flags;
+      encounters = malloc(48);
+      const u32 = module.HEAPU32;
+      const f64 = module.HEAPF64;
+      u32[encounters / 4] = 0;
+      u32[encounters / 4 + 1] = 1;
+      f64[encounters / 8 + 1] = 1500;
+      f64[encounters / 8 + 2] = 420;
+      f64[encounters / 8 + 3] = 9800;
+      f64[encounters / 8 + 4] = NaN;
+      u32[encounters / 4 + 10] = 3;
+      return 0;
+    },
+    _og_encounter_count: () => (encounters ? 1 : 0),
+    _og_encounters: () => encounters
+  };
+  return module;
+}
+
+describe('OrbitalGuard WASM session', () => {
+  let module: FakeModule;
+  let session: OrbitalGuardSession;
+
+  beforeEach(() => {
+    module = fakeModule();
+    session = new OrbitalGuardSession(module);
+  });
+
+  it('passes TLE text through the heap', () => {
+    const text = 'SAT-A\n1 00001U 24001A   24001.00000000  .00000000  00000-0  00000-0 0  9990\n';
+    session.addTleText(text, 'satellite');
+    expect(module.lastText).toBe(text);
+  });
+
+  it('returns store planes as views of linear memory', () => {
+    session.propagate(0, 1, 0);
+    expect(session.steps).toBe(3);
+    expect(Array.from(session.times())).toEqual([0, 1000, 2000]);
+
+    const y = session.plane(StorePlane.Y);
+    expect(y.length).toBe(6);
+    expect(y[0]).toBe(6);
+    expect(y.buffer).toBe(module.HEAPU8.buffer);
+
+    // No copy: writes to the heap show through the view
+    module.HEAPF64[y.byteOffset / 8] = -1;
+    expect(y[0]).toBe(-1);
+  });
+
+  it('decodes encounter records in place', () => {
+    session.propagate(0, 1, 0);
+    const views = session.screen(5000, OG_SCREEN_REFINE);
+    expect(module.lastFlags).toBe(OG_SCREEN_REFINE);
+    expect(views.count).toBe(1);
+
+    const e = encounterAt(views, 0);
+    expect(e.a).toBe(0);
+    expect(e.b).toBe(1);
+    expect(e.t).toBe(1500);
+    expect(e.missMeters).toBe(420);
+    expect(e.relSpeedMps).toBe(9800);
+    expect(e.pc).toBeNaN();
+    expect(e.severity).toBe(3);
+    expect(session.objectName(e.b)).toBe('DEB-B');
+    expect(session.objectKind(e.b)).toBe('debris');
+  });
+
+  it('rebuilds views on the current buffer after memory grows', () => {
+    session.propagate(0, 1, 0);
+    const before = session.plane(StorePlane.X);
+    module.grow();
+    const after = session.plane(StorePlane.X);
+    expect(after.buffer).toBe(module.HEAPU8.buffer);
+    expect(after.buffer).not.toBe(before.buffer);
+    expect(Array.from(after)).toEqual([0, 1, 2, 3, 4, 5]);
+  });
+});
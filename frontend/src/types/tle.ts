@@ -16,13 +16,34 @@ export interface TLEDataset {
 // Coordinates JSON structure (from C++ backend)
 export interface CoordinatesJson {
   timestamp_minutes: number;
+  start_ms?: number;              // time of the first step (Unix ms)
+  step_seconds?: number;          // spacing of backend steps
   satellites: Array<{
     name: string;
-    position_km: [number, number, number];
+    kind?: "satellite" | "debris";
+    position_km: [number, number, number];  // final state
     velocity_km_s: [number, number, number];
+    stride?: number;              // backend steps between samples in positions_km
+    positions_km?: number[];      // flat [x, y, z, x, y, z, ...] time series
   }>;
 }
 
+// Binary track blob (coordinates.bin from C++ backend). Sample arrays are
+// views into the fetched buffer, not copies.
+export interface TrackBlobObject {
+  name: string;
+  kind: "satellite" | "debris";
+  stride: number;                 // backend steps between samples
+  samples: Float32Array;          // samples x components values
+}
+
+export interface TrackBlob {
+  startMs: number;
+  stepMs: number;
+  components: number;             // 3 (x, y, z km) or 6 (plus vx, vy, vz km/s)
+  objects: TrackBlobObject[];
+}
+
 // Conjunctions JSON structure (from C++ backend)
 export interface ConjunctionsJson {
   timestamp_minutes: number;
@@ -32,6 +53,8 @@ export interface ConjunctionsJson {
     time_minutes: number;
     distance_km: number;
     relative_velocity_km_s: number;
+    severity?: string;
+    collision_probability?: number | null; // Pc at closest approach, when computed
   }>;
 }
 
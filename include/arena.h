@@ -0,0 +1,22 @@
+#ifndef ARENA_H
+#define ARENA_H
+
+#include "project_includes.h"
+#include <memory_resource>
+
+// First block of a scratch arena; later blocks grow geometrically
+const size_t ARENA_INITIAL_BYTES = 1 << 20;
+
+// Run-scoped scratch memory. Allocations are carved from a few large blocks
+// and only given back when the arena is destroyed, so node-based containers
+// (hash sets of pair keys, hit lists) cost a handful of heap allocations per
+// run instead of one per element. Not thread-safe: one arena per worker.
+struct ScratchArena {
+    pmr::monotonic_buffer_resource resource;
+
+    explicit ScratchArena(size_t initialBytes = ARENA_INITIAL_BYTES) : resource(initialBytes) {}
+    ScratchArena(const ScratchArena&) = delete;
+    ScratchArena& operator=(const ScratchArena&) = delete;
+};
+
+#endif // ARENA_H
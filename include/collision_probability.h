@@ -0,0 +1,86 @@
+#ifndef COLLISION_PROBABILITY_H
+#define COLLISION_PROBABILITY_H
+
+#include "simplified_core.h"
+
+// Error codes for collision probability functions
+#define PC_SUCCESS 0
+#define PC_ERROR_INVALID_INPUT 1
+
+// How Pc is computed
+enum PcMethod {
+    PC_METHOD_ANALYTIC = 0, // 2D short-encounter integral (Foster/Alfano)
+    PC_METHOD_MONTE_CARLO   // sampled miss distances, adaptive sample count
+};
+
+// 1-sigma uncertainty of one object at TCA in its radial / in-track /
+// cross-track frame. TLEs carry no covariance, so these are assumed values.
+struct StateSigma {
+    double radial_m, intrack_m, crosstrack_m;
+    double radial_mps, intrack_mps, crosstrack_mps; // Monte Carlo only
+};
+
+// Probability stage settings
+struct PcOptions {
+    PcMethod method = PC_METHOD_ANALYTIC;
+
+    // Hard-body radius per object; the pair's combined radius is the sum
+    double satelliteRadius_m = 5.0;
+    double debrisRadius_m = 0.5;
+    vector<double> radii_m;             // optional, by store index (overrides the above)
+
+    // Position (and velocity) uncertainty per object, typical of TLE-derived states
+    StateSigma satelliteSigma = {200.0, 1000.0, 200.0, 0.0, 0.0, 0.0};
+    StateSigma debrisSigma = {500.0, 2500.0, 500.0, 0.0, 0.0, 0.0};
+    vector<StateSigma> sigmas;          // optional, by store index (overrides the above)
+
+    // Monte Carlo: sample until the standard error is below mcTolerance * Pc,
+    // Pc is shown to be below mcFloor, or mcMaxSamples is reached. Encounters
+    // whose analytic Pc is below mcSkipBelow keep the analytic value.
+    double mcTolerance = 0.05;
+    double mcFloor = 1e-6;
+    double mcSkipBelow = 1e-8;
+    uint64_t mcMaxSamples = 1ull << 24;
+    uint64_t seed = 0x9e3779b97f4a7c15ull;
+
+    unsigned threads = 0;               // worker threads (0 = one per hardware thread)
+};
+
+// Per-encounter detail, parallel to the scored encounters
+struct PcEstimate {
+    double pc;
+    double stdError;   // 0 for the analytic method
+    uint64_t samples;  // Monte Carlo samples drawn (0 if analytic)
+};
+
+/**
+ * Collision probability of each encounter, written to Encounter::pc.
+ *
+ * Meant for refined encounters: both states are interpolated to the
+ * encounter time, and the combined position uncertainty is projected onto
+ * the plane normal to the relative velocity. The analytic method integrates
+ * that 2D Gaussian over the combined hard-body disc. Monte Carlo draws
+ * position (and velocity) offsets, spreading sample batches across threads,
+ * and stops adaptively. Results do not depend on the thread count.
+ *
+ * @param store Store the encounter indices refer to
+ * @param encounters Encounters to score (pc is filled in)
+ * @param count Number of encounters
+ * @param details Optional output, one entry per encounter
+ * @return Error code (0 = success, non-zero = error)
+ */
+int score_encounters(const TrajectoryStore& store, Encounter* encounters, size_t count,
+                     const PcOptions& options, vector<PcEstimate>* details = nullptr);
+
+/**
+ * Analytic 2D Pc for a miss vector and covariance already in the encounter plane
+ *
+ * @param missX_m, missY_m Miss vector in the plane
+ * @param cxx, cxy, cyy Combined covariance in the plane (m^2)
+ * @param radius_m Combined hard-body radius
+ * @return Probability in [0, 1]
+ */
+double pc_analytic_2d(double missX_m, double missY_m, double cxx, double cxy, double cyy,
+                      double radius_m);
+
+#endif // COLLISION_PROBABILITY_H
@@ -0,0 +1,65 @@
+#ifndef COMPACT_STORE_H
+#define COMPACT_STORE_H
+
+#include "simplified_core.h"
+#include "propagation.h"
+
+// Error codes for compact store functions
+#define COMPACT_STORE_SUCCESS 0
+#define COMPACT_STORE_ERROR_INVALID_INPUT 1
+
+// Mixed-precision ephemeris: the TrajectoryStore layout with float planes,
+// half the memory and bandwidth of the double store. Rounding moves a
+// coordinate by at most half an ulp, about 0.25 m in LEO and 2 m at GEO.
+// The element sets are kept, so any sample can be recomputed exactly in
+// double where a result depends on it.
+struct CompactStore {
+    size_t count = 0;                  // number of objects
+    size_t steps = 0;                  // samples per object
+    vector<double> times;              // sample time (Unix ms) per step
+    vector<double> timesJd;            // same, as Julian dates
+    vector<string> ids;                // object id by index
+    vector<bool> isDebris;             // debris flag by index
+    vector<OrbitalElements> elements;  // by index, as propagated
+    vector<float> data;                // STORE_COMPONENTS planes of steps * count values
+    double error_m = 0.0;              // bound on |float distance - exact distance| of any pair
+
+    double time(size_t k) const { return times[k]; }
+    float* row(int c, size_t k) { return data.data() + (c * steps + k) * count; }
+    const float* row(int c, size_t k) const { return data.data() + (c * steps + k) * count; }
+};
+
+/**
+ * Propagate a catalog onto the grid propagate_catalog would use, straight
+ * into float planes (no double store is held)
+ *
+ * @param threads Worker threads (0 = one per hardware thread)
+ * @return Error code (0 = success, non-zero = error)
+ */
+int compact_store_propagate(const PipelineCatalog& catalog, double startEpochMs,
+                            double stepSeconds, double durationHours, CompactStore& out,
+                            unsigned threads = 0);
+
+/**
+ * Exact states of selected objects over steps [firstStep, endStep), as
+ * propagate_catalog stores them (store step 0 is firstStep)
+ *
+ * @param objects Object indices; store index o holds objects[o]
+ * @param m Number of objects
+ */
+void compact_fill_store(const CompactStore& compact, const uint32_t* objects, size_t m,
+                        TrajectoryStore& out, size_t firstStep = 0, size_t endStep = SIZE_MAX);
+
+/**
+ * Same encounters as screen_by_threshold over the double store. The grid
+ * broad phase runs on the float positions with the screening distance padded
+ * by error_m and a float distance kernel (twice the SIMD lanes); each pair
+ * sample it passes is recomputed in double before it counts, from one
+ * propagation per object named by the step's candidates. Flagged pairs
+ * are then built, refined and scored on exact two-object stores, as in
+ * screen_lazy.
+ */
+vector<Encounter> screen_compact(const CompactStore& compact, double threshold_m,
+                                 const ScreeningOptions& options = ScreeningOptions{});
+
+#endif // COMPACT_STORE_H
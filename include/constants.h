@@ -0,0 +1,21 @@
+#ifndef CONSTANTS_H
+#define CONSTANTS_H
+
+// Physical and math constants used by the propagator (WGS-84 / EGM-96 values)
+const double MU = 398600.4418;          // Earth gravitational parameter (km^3/s^2)
+const double EARTH_RADIUS = 6378.137;   // Equatorial radius (km)
+const double J2 = 1.08262668e-3;        // Second zonal harmonic
+
+const double PI = 3.14159265358979323846;
+const double TWO_PI = 2.0 * PI;
+const double DEG_TO_RAD = PI / 180.0;
+const double RAD_TO_DEG = 180.0 / PI;
+
+// Unix epoch (1970-01-01T00:00Z) as a Julian date
+const double UNIX_EPOCH_JD = 2440587.5;
+const double MS_PER_DAY = 86400000.0;
+
+// Upper bound on relative speed between two Earth orbiters (head-on LEO, km/s)
+const double MAX_RELATIVE_SPEED_KMS = 16.0;
+
+#endif // CONSTANTS_H
@@ -0,0 +1,57 @@
+#pragma once
+#include "project_includes.h"
+
+// Instruction sets the distance kernel can run on
+enum DistanceKernelIsa {
+    KERNEL_AUTO = 0, // best available on this CPU (default)
+    KERNEL_SCALAR,
+    KERNEL_AVX2,
+    KERNEL_AVX512,
+    KERNEL_NEON
+};
+
+/**
+ * Find every point within a radius of a probe point.
+ *
+ * Compares squared distance against radius2 (no sqrt) over contiguous x/y/z
+ * arrays, several points per instruction on SIMD builds.
+ *
+ * @param xs, ys, zs Point coordinates (same unit as the probe and radius)
+ * @param n Number of points
+ * @param px, py, pz Probe point
+ * @param radius2 Squared radius
+ * @param out Receives indices (0..n-1) of points within the radius, in order;
+ *            must have room for n entries
+ * @return Number of indices written
+ */
+size_t within_radius(const double* xs, const double* ys, const double* zs, size_t n,
+                     double px, double py, double pz, double radius2, uint32_t* out);
+
+/**
+ * Same test over float coordinates, twice as many points per instruction.
+ * Squared distances are rounded to float; callers needing a conservative
+ * test pad radius2 (the relative error is below 1e-6).
+ */
+size_t within_radius(const float* xs, const float* ys, const float* zs, size_t n,
+                     float px, float py, float pz, float radius2, uint32_t* out);
+
+// Distance in metres of a separation in km: the exact test every screening
+// narrow phase and TCA refinement share, so they agree on pairs right at a
+// threshold. Each axis is scaled to metres before squaring (scaling the
+// root instead rounds differently in the last bit).
+inline double separation_m(double dxKm, double dyKm, double dzKm) {
+    const double dx = dxKm * 1000.0;
+    const double dy = dyKm * 1000.0;
+    const double dz = dzKm * 1000.0;
+    return sqrt(dx * dx + dy * dy + dz * dz);
+}
+
+/**
+ * Force a specific kernel (mainly for benchmarks and cross-checks).
+ * @return false (and keep the current kernel) when the CPU/build lacks that ISA
+ */
+bool select_distance_kernel(DistanceKernelIsa isa);
+
+// Kernel currently used by within_radius
+DistanceKernelIsa active_distance_kernel();
+string distance_kernel_name(DistanceKernelIsa isa);
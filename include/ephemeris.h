@@ -0,0 +1,65 @@
+#ifndef EPHEMERIS_H
+#define EPHEMERIS_H
+
+#include "simplified_core.h"
+
+// Error codes for ephemeris cache functions
+#define EPHEMERIS_SUCCESS 0
+#define EPHEMERIS_ERROR_IO 1
+#define EPHEMERIS_ERROR_FORMAT 2
+#define EPHEMERIS_ERROR_KEY_MISMATCH 3
+
+// Current on-disk format revision (bump on any layout change)
+#define EPHEMERIS_FORMAT_VERSION 1
+
+// How position/velocity planes are encoded on disk
+enum EphemerisEncoding {
+    EPHEMERIS_FLOAT64 = 0,   // exact doubles, same layout as TrajectoryStore
+    EPHEMERIS_QUANTIZED = 1  // int32 metres and mm/s (half the size, ~0.5 m error)
+};
+
+/*
+ * File layout (little-endian, offsets in bytes):
+ *   header      EphemerisHeader
+ *   times       steps x float64 (Unix ms)
+ *   id table    per object: uint8 isDebris, uint32 length, length bytes
+ *   padding     to a 64-byte boundary
+ *   planes      x, y, z, vx, vy, vz; each steps x count, time-major
+ */
+struct EphemerisHeader {
+    char     magic[8];     // "OGEPHEM\0"
+    uint32_t version;      // EPHEMERIS_FORMAT_VERSION
+    uint32_t encoding;     // EphemerisEncoding
+    uint64_t key;          // hash of inputs that produced the data
+    uint64_t count;        // objects
+    uint64_t steps;        // samples per object
+    double   startMs;      // time of the first sample (Unix ms)
+    double   stepMs;       // nominal sample spacing (ms)
+    uint64_t idTableBytes;
+    uint64_t dataOffset;   // start of the planes
+};
+
+/**
+ * Hash of everything that determines propagated output: TLE file contents,
+ * time grid and propagator revision. Missing files hash as empty input.
+ */
+uint64_t ephemeris_key(const vector<string>& tlePaths, double startEpochMs,
+                       double stepSeconds, double durationHours);
+
+/**
+ * Write a store to an ephemeris file
+ *
+ * @return Error code (0 = success, non-zero = error)
+ */
+int write_ephemeris(const string& path, const TrajectoryStore& store, uint64_t key,
+                    EphemerisEncoding encoding = EPHEMERIS_FLOAT64);
+
+/**
+ * Map an ephemeris file and load it into a store
+ *
+ * @param expectedKey Required key (0 accepts any key)
+ * @return Error code (0 = success, non-zero = error); the store is untouched on error
+ */
+int read_ephemeris(const string& path, TrajectoryStore& store, uint64_t expectedKey);
+
+#endif // EPHEMERIS_H
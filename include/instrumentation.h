@@ -0,0 +1,111 @@
+#pragma once
+#include "project_includes.h"
+
+// Hot-path instrumentation: scoped stage timers and global counters.
+//
+// Compiled in only when NOVA_INSTRUMENTATION is defined (CMake option
+// NOVA_ENABLE_INSTRUMENTATION). Without it NOVA_SCOPE and NOVA_COUNT expand
+// to nothing and the report/export functions below produce empty results,
+// so callers never need their own #ifdefs.
+
+// Error codes for instrumentation export functions
+#define INSTRUMENT_SUCCESS 0
+#define INSTRUMENT_ERROR_FILE 1
+
+enum InstrumentCounter {
+    COUNTER_TLE_RECORDS = 0,     // records indexed from catalog files
+    COUNTER_STATES_PROPAGATED,   // object states written by the propagators
+    COUNTER_PAIRS_TESTED,        // pair samples given a distance test (grid neighbours)
+    COUNTER_PAIRS_IN_THRESHOLD,  // pair samples within the screening distance
+    COUNTER_BYTES_WRITTEN,       // bytes sent to output files
+    COUNTER_COUNT
+};
+
+// Machine-readable counter name ("pairs_tested", ...)
+const char* instrument_counter_name(InstrumentCounter counter);
+
+// Totals for one stage name over every thread
+struct InstrumentStage {
+    string name;
+    uint64_t calls;
+    double total_ms;
+    double max_ms;
+};
+
+struct InstrumentReport {
+    bool enabled;                       // false when built without NOVA_INSTRUMENTATION
+    double wall_ms;                     // since the last reset
+    vector<InstrumentStage> stages;     // by total time, longest first
+    uint64_t counters[COUNTER_COUNT];
+};
+
+// Whether this build records anything
+bool instrument_enabled();
+
+// Drop every recorded timing and zero the counters. Not to be called while
+// instrumented work is running on other threads.
+void instrument_reset();
+
+// Snapshot of the stage totals and counters
+void instrument_report(InstrumentReport& out);
+
+/**
+ * Per-stage summary as JSON: {"enabled", "wall_ms", "stages": [{"name",
+ * "calls", "total_ms", "mean_ms", "max_ms"}], "counters": {...}}.
+ *
+ * @param path Output file (truncated)
+ * @return Error code (0 = success, non-zero = error)
+ */
+int instrument_write_summary(const string& path);
+
+/**
+ * Every recorded scope as Chrome trace-event JSON (complete "X" events, one
+ * track per thread, counters as a final "C" event), for chrome://tracing or
+ * Perfetto. Each thread keeps at most INSTRUMENT_MAX_EVENTS events; stage
+ * totals keep counting past that.
+ *
+ * @param path Output file (truncated)
+ * @return Error code (0 = success, non-zero = error)
+ */
+int instrument_write_trace(const string& path);
+
+const size_t INSTRUMENT_MAX_EVENTS = 1 << 20;
+
+#ifdef NOVA_INSTRUMENTATION
+
+namespace instrument_detail {
+
+extern atomic<uint64_t> counters[COUNTER_COUNT];
+
+uint64_t now_ns();
+void record(const char* name, uint64_t begin_ns, uint64_t end_ns);
+
+// Times its own lifetime under a string-literal name
+struct ScopedTimer {
+    const char* name;
+    uint64_t begin;
+    explicit ScopedTimer(const char* n) : name(n), begin(now_ns()) {}
+    ~ScopedTimer() { record(name, begin, now_ns()); }
+    ScopedTimer(const ScopedTimer&) = delete;
+    ScopedTimer& operator=(const ScopedTimer&) = delete;
+};
+
+} // namespace instrument_detail
+
+#define NOVA_SCOPE_JOIN2(a, b) a##b
+#define NOVA_SCOPE_JOIN(a, b) NOVA_SCOPE_JOIN2(a, b)
+
+// Time the rest of the enclosing block as stage `name` (a string literal)
+#define NOVA_SCOPE(name) \
+    instrument_detail::ScopedTimer NOVA_SCOPE_JOIN(novaScope_, __LINE__)(name)
+
+// Add n to a counter (relaxed atomic; count locally in loops and add once)
+#define NOVA_COUNT(counter, n) \
+    instrument_detail::counters[counter].fetch_add(static_cast<uint64_t>(n), memory_order_relaxed)
+
+#else
+
+#define NOVA_SCOPE(name) ((void)0)
+#define NOVA_COUNT(counter, n) ((void)sizeof(n))
+
+#endif // NOVA_INSTRUMENTATION
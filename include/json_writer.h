@@ -0,0 +1,54 @@
+#pragma once
+#include "project_includes.h"
+#include <cstdio>
+
+// Longest text format_fixed can produce (sign, 20 integer digits, point,
+// up to 9 decimals, terminator) with room to spare
+const size_t FIXED_TEXT_MAX = 40;
+
+/**
+ * Format a double in fixed notation, like printf("%.*f") but without locale
+ * or stream state. Rounding is exact (half to even on true ties), so output
+ * matches iostream fixed/setprecision. Non-finite values are written as
+ * "null" so the result is always valid JSON.
+ *
+ * @param digits Decimal places, 0..9
+ * @param out Buffer of at least FIXED_TEXT_MAX chars (not NUL terminated)
+ * @return Number of chars written
+ */
+size_t format_fixed(double value, int digits, char* out);
+
+// Buffered text output to a file. Text is collected in a fixed-size buffer
+// and written out in large blocks, so memory use does not depend on how much
+// is written. Closed by json_close or the destructor.
+struct JsonWriter {
+    FILE* file = nullptr;
+    vector<char> buffer;
+    size_t used = 0;
+    bool failed = false; // any short write since opening
+
+    JsonWriter() = default;
+    JsonWriter(const JsonWriter&) = delete;
+    JsonWriter& operator=(const JsonWriter&) = delete;
+    ~JsonWriter();
+};
+
+// Open (truncate) a file for writing; returns false when it cannot be created
+bool json_open(JsonWriter& w, const string& path, size_t bufferBytes = 1 << 16);
+
+// Push buffered text to the file (and the OS) so readers see it
+void json_flush(JsonWriter& w);
+
+// Flush and close; returns false if anything failed to write
+bool json_close(JsonWriter& w);
+
+void json_write(JsonWriter& w, const char* text, size_t length);
+void json_write(JsonWriter& w, const char* text);
+void json_write_fixed(JsonWriter& w, double value, int digits);
+
+// Comma-separated run of fixed-format values, formatted straight into the
+// buffer (no per-value copy); the caller writes the surrounding brackets
+void json_write_fixed_list(JsonWriter& w, const double* values, size_t count, int digits);
+
+// Quoted JSON string with the required escapes
+void json_write_string(JsonWriter& w, const string& text);
@@ -0,0 +1,108 @@
+#ifndef LAZY_EPHEMERIS_H
+#define LAZY_EPHEMERIS_H
+
+#include "simplified_core.h"
+#include "propagation.h"
+#include <list>
+#include <memory>
+#include <mutex>
+
+// Error codes for lazy ephemeris functions
+#define LAZY_EPHEMERIS_SUCCESS 0
+#define LAZY_EPHEMERIS_ERROR_INVALID_INPUT 1
+
+// Default steps per chunk (64 one-minute samples: about an hour of one orbit)
+const size_t LAZY_CHUNK_STEPS = 64;
+
+// One object's states over one chunk of the time grid, exactly as
+// propagate_batch would store them (failed states are NaN)
+struct EphemerisChunk {
+    size_t firstStep;
+    size_t steps;
+    vector<double> states; // steps x STORE_COMPONENTS, state s at s * STORE_COMPONENTS
+};
+
+struct LazyEphemerisStats {
+    uint64_t hits = 0;        // chunk requests served from the cache
+    uint64_t misses = 0;      // chunks propagated
+    uint64_t evictions = 0;
+    size_t peakChunks = 0;    // most chunks cached at once
+};
+
+typedef list<pair<uint64_t, shared_ptr<const EphemerisChunk>>> EphemerisChunkList;
+
+// On-demand ephemeris of a catalog over a uniform time grid. Chunks of
+// chunkSteps samples are propagated per object the first time they are
+// asked for and kept in an LRU cache of at most maxChunks, so resident
+// memory follows the working set instead of catalog x horizon. Safe to
+// share between threads; a chunk handed out stays valid while it is held,
+// even once evicted.
+struct LazyEphemeris {
+    size_t count = 0;
+    size_t steps = 0;
+    size_t chunkSteps = LAZY_CHUNK_STEPS;
+    size_t maxChunks = 0;
+    vector<double> times;              // sample time (Unix ms) per step
+    vector<double> timesJd;            // same, as Julian dates
+    vector<string> ids;                // object id by index
+    vector<bool> isDebris;             // debris flag by index
+    vector<OrbitalElements> elements;  // by index
+    vector<double> stepBound_m;        // per object, propagation_step_bound_m (+inf if invalid)
+
+    mutex lock;                        // guards the cache below
+    EphemerisChunkList lru;            // most recently used first
+    unordered_map<uint64_t, EphemerisChunkList::iterator> cached; // (object, chunk) -> entry
+    LazyEphemerisStats stats;
+};
+
+/**
+ * Set up a lazy ephemeris over the grid propagate_catalog would use;
+ * nothing is propagated yet
+ *
+ * @param catalog Objects in store order
+ * @param cacheBytes Bound on cached state data (at least one chunk is kept)
+ * @param chunkSteps Samples per chunk
+ * @return Error code (0 = success, non-zero = error)
+ */
+int lazy_ephemeris_open(LazyEphemeris& eph, const PipelineCatalog& catalog,
+                        double startEpochMs, double stepSeconds, double durationHours,
+                        size_t cacheBytes, size_t chunkSteps = LAZY_CHUNK_STEPS);
+
+/**
+ * States of object i over chunk c (steps [c * chunkSteps, ...)),
+ * propagated on first use
+ *
+ * @return The chunk, or null if i or c is out of range
+ */
+shared_ptr<const EphemerisChunk> lazy_chunk(LazyEphemeris& eph, size_t i, size_t c);
+
+/**
+ * Materialize selected objects over steps [firstStep, endStep) into a
+ * store (ids, flags and times included; store step 0 is firstStep), e.g.
+ * for refinement or export of only those objects
+ *
+ * @param objects Object indices; store index o holds objects[o]
+ * @param m Number of objects
+ */
+void lazy_fill_store(LazyEphemeris& eph, const uint32_t* objects, size_t m, TrajectoryStore& out,
+                     size_t firstStep = 0, size_t endStep = SIZE_MAX);
+
+/**
+ * Same encounters, in the same order, as screen_by_threshold over the
+ * eagerly propagated catalog, screened one chunk of steps at a time from
+ * the lazy ephemeris. Each chunk's positions are gathered once per call.
+ * With options.prefilter (built for eph.count objects) its pairs are walked
+ * one by one, each jumping ahead by as many steps as it provably cannot
+ * close the gap to the screening distance in (from the propagator's step
+ * bounds), and only objects with a pair due in the chunk are gathered.
+ * Without one every object is gathered and each step is screened on the
+ * grid, as screen_by_threshold does. Each flagged pair is refined and
+ * scored on a two-object store of its own, from the step before its first
+ * close sample on (only that sample without refineTca), read back through
+ * the cache, so refined runs re-propagate when the cache holds less than
+ * one chunk per object.
+ */
+vector<Encounter> screen_lazy(LazyEphemeris& eph, double threshold_m,
+                              const ScreeningOptions& options = ScreeningOptions{});
+
+#endif // LAZY_EPHEMERIS_H
@@ -31,7 +31,10 @@ double fuel_consumption(double delta_v_km_s, double specific_impulse_s,
 double fuel_required_simple(double delta_v_mps, double specific_impulse_s, double initial_mass_kg);
 
 /**
- * Plan an avoidance maneuver between two objects
+ * Plan an avoidance maneuver between two objects: the cheapest burn of the
+ * default search_avoidance grid (maneuver_search.h) that opens the pair to
+ * the target distance. The grid's magnitudes within max_delta_v_mps are
+ * searched together with the same steps scaled up or down to the limit.
  * 
  * @param primary Primary object orbital elements
  * @param secondary Secondary object orbital elements  
@@ -39,7 +42,7 @@ double fuel_required_simple(double delta_v_mps, double specific_impulse_s, doubl
  * @param target_distance_km Desired separation distance in km
  * @param max_delta_v_mps Maximum allowable delta-v in m/s
  * @param out_maneuver Output maneuver structure
- * @return 0 on success, non-zero on failure
+ * @return 0 on success, non-zero on failure (including no burn reaching the target)
  */
 int plan_avoidance(const OrbitalElements* primary, const OrbitalElements* secondary,
                   double encounter_time, double target_distance_km, 
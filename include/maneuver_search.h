@@ -0,0 +1,100 @@
+#ifndef MANEUVER_SEARCH_H
+#define MANEUVER_SEARCH_H
+
+#include "types.h"
+#include "simplified_core.h"
+#include "maneuver.h"
+
+struct ScreeningIndex; // screening_index.h
+
+// Error codes for maneuver search functions
+#define MANEUVER_SEARCH_SUCCESS 0
+#define MANEUVER_SEARCH_ERROR_INVALID_INPUT 1
+
+// Burn directions in the primary's radial / in-track / cross-track frame at
+// the burn time (bit flags)
+enum BurnDirection {
+    BURN_RADIAL_PLUS = 1 << 0,
+    BURN_RADIAL_MINUS = 1 << 1,
+    BURN_INTRACK_PLUS = 1 << 2,
+    BURN_INTRACK_MINUS = 1 << 3,
+    BURN_CROSSTRACK_PLUS = 1 << 4,
+    BURN_CROSSTRACK_MINUS = 1 << 5,
+    BURN_ALL_DIRECTIONS = (1 << 6) - 1
+};
+
+// Candidate grid and propulsion model
+struct ManeuverSearchOptions {
+    // Burn times, as seconds before the encounter; burns before the start of
+    // the store's grid are not tried
+    vector<double> leadTimes_s = {1200.0, 2400.0, 3600.0, 5400.0, 7200.0, 10800.0};
+    unsigned directions = BURN_ALL_DIRECTIONS;
+    vector<double> magnitudes_mps = {0.01, 0.02, 0.05, 0.1, 0.2, 0.5, 1.0};
+
+    // Catalog approaches closer than this count as conflicts of a candidate
+    double catalogThreshold_m = 5000.0;
+
+    // Primary's propulsion, for fuel_consumption
+    double specificImpulse_s = 300.0;
+    double dryMass_kg = 500.0;
+    double propellantMass_kg = 50.0;
+    double efficiency = 1.0;
+
+    unsigned threads = 0;    // worker threads (0 = one per hardware thread)
+};
+
+// One evaluated burn. Misses only cover the store's grid after the burn.
+struct ManeuverCandidate {
+    double burnTime;          // Unix ms
+    double rtn_mps[3];        // burn in the radial / in-track / cross-track frame
+    double dv_eci_mps[3];     // same burn in ECI
+    double dv_mps;            // magnitude
+    double fuel_kg;
+    double secondaryMiss_m;   // closest approach to the secondary (sub-step)
+    double secondaryTca;      // its time (Unix ms)
+    double catalogMiss_m;     // closest approach to any other object sampled within the
+                              // index distance (infinity if none, or no index)
+    uint32_t catalogObject;   // store index of that object (UINT32_MAX if none)
+    uint32_t catalogConflicts; // other objects passing within catalogThreshold_m
+    double miss_m;            // min(secondaryMiss_m, catalogMiss_m), the miss traded against fuel
+};
+
+struct ManeuverSearchResult {
+    ManeuverCandidate baseline;          // no burn, measured over the same span as the earliest burn
+    vector<ManeuverCandidate> candidates; // every evaluated burn, lead time-major, then direction, then magnitude
+    vector<uint32_t> pareto;             // indices into candidates: no other candidate uses no more
+                                         // fuel for a larger miss; fuel ascending
+};
+
+/**
+ * Trade-space search for an avoidance burn of the primary ahead of an encounter.
+ *
+ * Every combination of lead time, direction and magnitude is applied as an
+ * impulse to the primary's propagated state; the post-burn state is turned
+ * back into elements and propagated over the rest of the store's grid with
+ * the batch propagator, and its offset from the coasting orbit is applied
+ * to the stored trajectory. Each trajectory is screened against the
+ * secondary's stored states and, through the index, against the rest of the
+ * catalog, with a straight-line sub-step minimum at every sample.
+ * Candidates are spread across threads; results do not depend on the
+ * thread count.
+ *
+ * @param store Screened window the encounter was found in
+ * @param elements Element sets by store index
+ * @param index Broad-phase index of the store, sized with screening_candidate_distance
+ *              so passes between samples are seen (nullptr skips the catalog check)
+ * @param primary Store index of the object that burns
+ * @param secondary Store index of the other object of the encounter
+ * @param tcaMs Encounter time (Unix ms), inside the store's grid
+ * @param out Evaluated candidates and their Pareto set
+ * @return Error code (0 = success, non-zero = error)
+ */
+int search_avoidance(const TrajectoryStore& store, const vector<OrbitalElements>& elements,
+                     const ScreeningIndex* index, uint32_t primary, uint32_t secondary,
+                     double tcaMs, const ManeuverSearchOptions& options,
+                     ManeuverSearchResult& out);
+
+// Maneuver record for a candidate (epoch as Julian date, ECI delta-v)
+void candidate_to_maneuver(const ManeuverCandidate& candidate, Maneuver* out_maneuver);
+
+#endif // MANEUVER_SEARCH_H
@@ -0,0 +1,34 @@
+#pragma once
+#include "project_includes.h"
+
+// Read-only memory mapping of a whole file (falls back to reading it into
+// memory when the file cannot be mapped). Released by unmap_file or the destructor.
+struct MappedFile {
+    const char* data = nullptr;
+    size_t size = 0;
+
+    // platform mapping state
+    void* mapping = nullptr;
+    void* fileHandle = nullptr;
+    vector<char> fallback;
+
+    MappedFile() = default;
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+    ~MappedFile();
+};
+
+// Map a file read-only; returns false when it cannot be opened
+bool map_file(const string& filename, MappedFile& out);
+void unmap_file(MappedFile& file);
+
+// The binary formats are stored in host byte order and only accepted on
+// little-endian hosts
+bool host_little_endian();
+
+// Name a file is written under before commit_file moves it into place
+string temp_file_path(const string& path);
+
+// Replace path with the fully written tmp, so readers see the old file or
+// the new one, never a partial write; tmp is removed if the move fails
+bool commit_file(const string& tmp, const string& path);
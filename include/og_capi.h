@@ -0,0 +1,111 @@
+#ifndef OG_CAPI_H
+#define OG_CAPI_H
+
+/*
+ * C ABI over propagation and screening, for the WASM build and other
+ * foreign callers. A context owns one catalog, its propagated store and the
+ * last screening result. Bulk results are not copied out: og_store_plane,
+ * og_store_times and og_encounters return pointers into the context, so a
+ * WASM caller wraps them as typed-array views of linear memory. Views stay
+ * valid until the next og_add_tle_text, og_clear, og_propagate, og_screen or
+ * og_destroy on the same context, and must be recreated after any call that
+ * may grow memory (with ALLOW_MEMORY_GROWTH the heap buffer itself moves).
+ * No exception leaves an entry point: running out of memory returns
+ * OG_ERROR_FAILED and leaves the context as it was before the call, or with
+ * its results dropped.
+ */
+
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Error codes
+#define OG_SUCCESS 0
+#define OG_ERROR_INVALID_INPUT 1
+#define OG_ERROR_NOT_PROPAGATED 2
+#define OG_ERROR_FAILED 3
+
+// og_screen flags
+#define OG_SCREEN_PREFILTER 1u  // drop pairs the orbit prefilter rules out first
+#define OG_SCREEN_REFINE 2u     // sub-step closest approach (as the pipeline's refine)
+#define OG_SCREEN_PC 4u         // collision probability per encounter (needs OG_SCREEN_REFINE)
+
+// Store planes, as in TrajectoryStore
+#define OG_PLANE_X 0
+#define OG_PLANE_Y 1
+#define OG_PLANE_Z 2
+#define OG_PLANE_VX 3
+#define OG_PLANE_VY 4
+#define OG_PLANE_VZ 5
+
+// One encounter, 48 bytes with doubles 8-byte aligned (a Float64Array over
+// the array sees t at index 6 * e + 1, miss at + 2, rel speed at + 3, Pc at + 4)
+typedef struct og_encounter {
+    uint32_t a, b;      // object indices, a < b
+    double t;           // closest sample or refined TCA (Unix ms)
+    double miss_m;
+    double rel_mps;
+    double pc;          // NaN unless scored with OG_SCREEN_PC
+    int32_t severity;   // 0 (no risk) .. 4 (collision imminent), relative to the threshold
+    uint32_t reserved;
+} og_encounter;
+
+typedef struct og_context og_context;
+
+og_context* og_create(void);
+void og_destroy(og_context* ctx);
+
+// Drop the catalog and everything computed from it
+void og_clear(og_context* ctx);
+
+/**
+ * Append the TLE records of a text buffer (3-line records, CRLF or LF) to
+ * the catalog; records whose elements do not parse are kept and propagate
+ * to NaN, as in the pipeline
+ *
+ * @param is_debris Non-zero if the records are debris
+ * @return Error code (0 = success, non-zero = error)
+ */
+int og_add_tle_text(og_context* ctx, const char* text, size_t length, int is_debris);
+
+uint32_t og_object_count(const og_context* ctx);
+const char* og_object_name(const og_context* ctx, uint32_t i); // NUL-terminated; "" if out of range
+int og_object_is_debris(const og_context* ctx, uint32_t i);
+
+/**
+ * Propagate the catalog over [start_ms, start_ms + duration_hours] at
+ * step_seconds on the calling thread
+ *
+ * @return Error code (0 = success; OG_ERROR_INVALID_INPUT for a non-finite
+ *         start, a non-positive step or a negative, non-finite or oversized
+ *         window; OG_ERROR_FAILED if the store does not fit in memory)
+ */
+int og_propagate(og_context* ctx, double start_ms, double step_seconds, double duration_hours);
+
+uint32_t og_store_steps(const og_context* ctx);
+const double* og_store_times(const og_context* ctx); // og_store_steps values (Unix ms)
+
+// One component plane, og_store_steps x og_object_count values: object i at
+// step k is at [k * count + i] (km, km/s; failed states are NaN)
+const double* og_store_plane(const og_context* ctx, int plane);
+
+/**
+ * Screen the propagated store, as screen_by_threshold does; the result
+ * replaces the previous one
+ *
+ * @param flags OG_SCREEN_* bits
+ * @return Error code (0 = success, non-zero = error)
+ */
+int og_screen(og_context* ctx, double threshold_m, uint32_t flags);
+
+uint32_t og_encounter_count(const og_context* ctx);
+const og_encounter* og_encounters(const og_context* ctx);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // OG_CAPI_H
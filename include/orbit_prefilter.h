@@ -0,0 +1,52 @@
+#ifndef ORBIT_PREFILTER_H
+#define ORBIT_PREFILTER_H
+
+#include "types.h"
+#include "simplified_core.h"
+
+// Error codes for prefilter functions
+#define PREFILTER_SUCCESS 0
+#define PREFILTER_ERROR_INVALID_INPUT 1
+
+// Extra distance added to the screening threshold by the geometric filters,
+// covering interpolation error in the time-stepped stage
+const double PREFILTER_PAD_M = 1000.0;
+
+// Pairs left after each stage
+struct PrefilterStats {
+    uint64_t pairs = 0;       // all unordered pairs in the catalog
+    uint64_t apsis = 0;       // after apogee/perigee gating
+    uint64_t orbitPath = 0;   // after the orbit-path filter
+};
+
+// Pairs that can come within the filter distance during the window, as a
+// compressed adjacency list: partners of object i (all > i, ascending) are
+// partners[offsets[i] .. offsets[i + 1])
+struct PairPrefilter {
+    size_t count = 0;
+    vector<uint64_t> offsets;
+    vector<uint32_t> partners;
+    PrefilterStats stats;
+};
+
+/**
+ * Run apogee/perigee gating, then the orbit-path filter, over every pair of
+ * a catalog. Both are conservative: a pair is only dropped when the
+ * propagator's secular model rules out an approach within distance_m at any
+ * time in the window. Objects whose elements do not parse keep all pairs.
+ *
+ * @param elements Element sets, indexed like the store being screened
+ * @param startMs Window start (Unix ms)
+ * @param durationHours Window length
+ * @param distance_m Screening threshold plus padding
+ * @param threads Worker threads (0 = one per hardware thread)
+ * @return Error code (0 = success, non-zero = error)
+ */
+int build_pair_prefilter(const vector<OrbitalElements>& elements, double startMs,
+                         double durationHours, double distance_m, PairPrefilter& out,
+                         unsigned threads = 0);
+
+// True if the pair (i < j) survived the prefilter
+bool prefilter_allows(const PairPrefilter& filter, uint32_t i, uint32_t j);
+
+#endif // ORBIT_PREFILTER_H
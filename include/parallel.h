@@ -0,0 +1,48 @@
+#pragma once
+#include "project_includes.h"
+
+// Resolve a requested worker count (0 = one per hardware thread, never below 1)
+inline unsigned resolve_thread_count(unsigned requested) {
+    if (requested == 0) {
+        requested = thread::hardware_concurrency();
+    }
+    return requested == 0 ? 1u : requested;
+}
+
+/**
+ * Run body(worker, begin, end) over [0, count) split into chunks of `grain`.
+ * Workers pull the next chunk from a shared counter, so faster workers take more
+ * of the range. `worker` is in [0, threads) and indexes per-thread scratch buffers.
+ * With one thread (or a single chunk) the body runs on the calling thread.
+ */
+template <typename Body>
+void parallel_for_chunks(size_t count, size_t grain, unsigned threads, Body&& body) {
+    if (count == 0) return;
+    if (grain == 0) grain = 1;
+    const size_t chunks = (count + grain - 1) / grain;
+    threads = resolve_thread_count(threads);
+    if (threads > chunks) threads = static_cast<unsigned>(chunks);
+
+    if (threads <= 1) {
+        body(0u, size_t(0), count);
+        return;
+    }
+
+    atomic<size_t> next{0};
+    auto worker = [&](unsigned w) {
+        for (;;) {
+            const size_t c = next.fetch_add(1, memory_order_relaxed);
+            if (c >= chunks) break;
+            const size_t begin = c * grain;
+            body(w, begin, min(begin + grain, count));
+        }
+    };
+
+    vector<thread> pool;
+    pool.reserve(threads - 1);
+    for (unsigned w = 1; w < threads; ++w) {
+        pool.emplace_back(worker, w);
+    }
+    worker(0u);
+    for (auto& t : pool) t.join();
+}
@@ -0,0 +1,142 @@
+#ifndef PIPELINE_H
+#define PIPELINE_H
+
+#include "types.h"
+#include "simplified_core.h"
+#include "propagation.h"
+
+// Error codes for pipeline functions
+#define PIPELINE_SUCCESS 0
+#define PIPELINE_ERROR_INVALID_INPUT 1
+#define PIPELINE_ERROR_IO 2
+#define PIPELINE_ERROR_NO_OBJECTS 3
+
+// One screening pass over the shared store and the file its conjunctions go to
+struct ScreeningJob {
+    double threshold_m;
+    string conjunctionsPath; // empty: <outputDir>/conjunctions.json, or
+                             // conjunctions_<threshold>m.json when there are several jobs
+};
+
+// Everything a run of the pipeline depends on. The defaults reproduce the
+// original fixed pipeline (built-in catalogs, 24 h at 60 s, 5 km, tests/).
+struct PipelineConfig {
+    vector<CatalogInput> catalogs = default_catalog_inputs();
+
+    double startEpochMs = 1734979200000.0; // 2024-12-23T18:40Z
+    double stepSeconds = 60.0;
+    double durationHours = 24.0;
+
+    vector<ScreeningJob> jobs = {{5000.0, ""}};
+
+    string outputDir = "tests";
+    bool useCache = true;
+    string cachePath;            // empty: <outputDir>/ephemeris_cache.bin
+    bool writeTracks = true;     // coordinates.json and coordinates.bin in outputDir
+    uint32_t trackJsonStride = 10;
+
+    bool prefilter = true;       // orbit-geometry pair prefilter
+    bool refineTca = true;
+    bool probability = true;     // analytic Pc of every refined conjunction
+    bool allPasses = false;      // every approach window per pair, not only the first
+    size_t lazyCacheMB = 0;      // > 0: propagate on demand through a chunk cache of this
+                                 // size instead of the whole store (see lazy_ephemeris.h)
+    bool compactStore = false;   // float32 store and screen_compact (see compact_store.h)
+    size_t topRisks = 0;         // > 0: write only this many highest-risk conjunctions, in risk order
+    double minProbability = 0.0; // > 0: drop conjunctions with a lower (or no) Pc
+    unsigned threads = 0;        // worker threads (0 = one per hardware thread)
+
+    bool daemon = false;         // rolling screening instead of the batch run
+    double horizonHours = 72.0;
+
+    string profilePrefix;        // instrumentation output, see instrumentation.h
+
+    // Sharded runs, see sharding.h
+    size_t shardBlocks = 0;      // > 1: catalog split into this many blocks, screened by workers
+    string shardDir;             // exchange directory; empty: <outputDir>/shards
+    string shardLauncher;        // command prefix each worker runs under, e.g. "srun -N1 -n1"
+    unsigned shardParallel = 0;  // workers in flight (0 = one per hardware thread)
+    string shardTask;            // worker mode: the single task to run
+};
+
+/**
+ * Apply command-line options on top of config. Options are applied in
+ * order; --config FILE applies the file's lines at that point, so later
+ * options override it. The first --satellites / --debris replaces the
+ * built-in catalogs and the first --threshold the default job; repeats add
+ * more. See pipeline_usage for the full list.
+ *
+ * @param argv Arguments after the program name
+ * @param error Reason when the options are rejected
+ * @return Error code (0 = success, non-zero = error)
+ */
+int parse_pipeline_args(int argc, const char* const* argv, PipelineConfig& config, string& error);
+
+/**
+ * Apply a config file: one "key = value" per line, keys as the long options
+ * without "--" (flags take no value or true/false), '#' starts a comment.
+ *
+ * @return Error code (0 = success, non-zero = error)
+ */
+int load_pipeline_config(const string& path, PipelineConfig& config, string& error);
+
+/**
+ * Write config as a file load_pipeline_config reads back to the same
+ * settings (the shard task is left out)
+ *
+ * @return Error code (0 = success, non-zero = error)
+ */
+int write_pipeline_config(const string& path, const PipelineConfig& config);
+
+// Option summary for --help
+string pipeline_usage(const char* program);
+
+// Output paths the batch run writes for a config
+string pipeline_conjunctions_path(const PipelineConfig& config, size_t job);
+string pipeline_cache_path(const PipelineConfig& config);
+string pipeline_shard_dir(const PipelineConfig& config);
+
+/**
+ * Screening options a config asks for. probability backs out.probability
+ * and must outlive it.
+ */
+void pipeline_screening_options(const PipelineConfig& config, PcOptions& probability,
+                                ScreeningOptions& out);
+
+/**
+ * Pair prefilter for the largest threshold of config over elements (store
+ * order), if config.prefilter is set
+ *
+ * @return true when out was built
+ */
+bool pipeline_prefilter(const PipelineConfig& config, const vector<OrbitalElements>& elements,
+                        PairPrefilter& out);
+
+/**
+ * Ranking stage of the batch outputs: drops encounters below
+ * config.minProbability and, with config.topRisks, keeps that many of the
+ * highest risks (top_encounters_by_risk), breaking risk ties by time
+ * order whatever order the encounters arrive in
+ *
+ * @return true if encounters are now in risk order, false if they keep
+ *         screening order (written in time order)
+ */
+bool pipeline_rank_encounters(const PipelineConfig& config, vector<Encounter>& encounters);
+
+/**
+ * Batch run: load every catalog, propagate once (through the ephemeris
+ * cache), write the track outputs, then screen the same store. A single
+ * job streams its conjunctions; several share one screen_by_thresholds
+ * pass and are written in the same time order; with allPasses each job runs screen_passes. The prefilter is built
+ * once, for the largest threshold. With lazyCacheMB every job runs
+ * screen_lazy instead, without the store or the ephemeris cache; with
+ * compactStore every output comes from a float32 store (screen_compact per
+ * job), also without the ephemeris cache. With topRisks or minProbability
+ * every job's encounters go through pipeline_rank_encounters before they
+ * are written, so a single job is collected instead of streamed.
+ *
+ * @return Error code (0 = success, non-zero = error)
+ */
+int run_pipeline(const PipelineConfig& config);
+
+#endif // PIPELINE_H
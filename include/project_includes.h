@@ -15,6 +15,11 @@ using namespace std;
 #include <cctype>
 #include <iomanip>
 #include <new>
+#include <unordered_map>
+#include <unordered_set>
+#include <atomic>
+#include <thread>
+#include <functional>
 
 // threshold distance in km for conjunction screening
 const double THRESHOLD_DISTANCE = 100.0;
@@ -2,6 +2,8 @@
 #define PROPAGATION_H
 
 #include "types.h"
+#include "simplified_core.h"
+#include "tle_catalog.h"
 
 // Error codes for propagation functions
 #define PROPAGATION_SUCCESS 0
@@ -19,6 +21,201 @@
  */
 int propagate(const OrbitalElements* elements, double minutes_since_epoch, StateVectorECI* out_state);
 
+/**
+ * Batch propagation of N element sets over M absolute times
+ *
+ * Per-object constants (semi-major axis, J2 rates, orientation) are computed
+ * once per element set, then reused for every time.
+ *
+ * @param elements Array of n orbital element sets
+ * @param n Number of element sets
+ * @param times_jd Array of m output times (Julian date)
+ * @param m Number of times
+ * @param out_states Output array of n * m states, object-major (out_states[i * m + j])
+ * @param velocities false: positions only (the same values), velocities left NaN
+ *                   and their arithmetic compiled out
+ * @return Error code of the first failing state (remaining states are still filled)
+ */
+int propagate_grid(const OrbitalElements* elements, size_t n,
+                   const double* times_jd, size_t m, StateVectorECI* out_states,
+                   bool velocities = true);
+
+/**
+ * Propagate a whole catalog onto a uniform time grid, straight into a store
+ *
+ * Objects are split across a thread pool; each state is written directly into
+ * the store planes (no per-state allocation). The store is resized when its
+ * dimensions differ from n x steps (ids are then left blank for the caller).
+ *
+ * @param elements Array of n orbital element sets
+ * @param n Number of objects
+ * @param t0 Time of the first sample (Unix ms)
+ * @param step Sample spacing in seconds
+ * @param steps Number of samples per object
+ * @param store Output store; times are filled in as well
+ * @param threads Worker threads (0 = one per hardware thread)
+ * @return Error code of the first failing object (failed states are NaN)
+ */
+int propagate_batch(const OrbitalElements* elements, size_t n, double t0, double step,
+                    size_t steps, TrajectoryStore& store, unsigned threads = 0);
+
+/**
+ * Re-propagate selected objects of an existing store onto its time grid
+ *
+ * Produces exactly the states propagate_batch would for the same elements;
+ * other objects are left untouched.
+ *
+ * @param elements Array of m orbital element sets
+ * @param indices Store index of each element set
+ * @param m Number of objects
+ * @param store Store whose times are already filled in
+ * @param threads Worker threads (0 = one per hardware thread)
+ * @return Error code of the first failing object (failed states are NaN)
+ */
+int propagate_objects(const OrbitalElements* elements, const uint32_t* indices, size_t m,
+                      TrajectoryStore& store, unsigned threads = 0);
+
+/**
+ * Propagate every object of a store over steps [firstStep, endStep) only,
+ * e.g. the tail a rolling window has just gained
+ *
+ * @param elements Array of store.count orbital element sets
+ * @param n Number of element sets (must equal store.count)
+ * @param store Store whose times for those steps are already filled in
+ * @param threads Worker threads (0 = one per hardware thread)
+ * @return Error code of the first failing object (failed states are NaN)
+ */
+int propagate_steps(const OrbitalElements* elements, size_t n, size_t firstStep, size_t endStep,
+                    TrajectoryStore& store, unsigned threads = 0);
+
+// NORAD catalog number from columns 3-7 of TLE line 1 (0 if not numeric)
+uint32_t tle_catalog_number(const char* line1, size_t len);
+
+/**
+ * Parse a TLE into orbital elements
+ *
+ * Line 1 is read field by field (epoch, ndot, nddot, bstar) so shortened epochs
+ * still parse; line 2 uses the standard fixed columns.
+ *
+ * @param tle TLE record
+ * @param out_elements Output orbital elements (angles in radians, epoch in Julian date)
+ * @return Error code (0 = success, non-zero = error)
+ */
+int tle_to_elements(const TLE* tle, OrbitalElements* out_elements);
+
+/**
+ * Element set whose propagation passes through a given state at that state's
+ * time (osculating Keplerian elements, e.g. just after an impulsive burn).
+ * Drag terms are zero; the caller may copy them from the pre-burn elements.
+ *
+ * @param state State in ECI coordinates (km, km/s, Julian date)
+ * @param out_elements Output orbital elements, epoch at state->t
+ * @return Error code (0 = success, non-zero = error; hyperbolic states are rejected)
+ */
+int state_to_elements(const StateVectorECI* state, OrbitalElements* out_elements);
+
+// Same as tle_to_elements, parsing in place over a mapped catalog record
+int tle_view_to_elements(const TLEView* view, OrbitalElements* out_elements);
+
+// Same as tle_to_elements over raw, not necessarily NUL-terminated, lines
+int tle_lines_to_elements(const char* line1, size_t len1,
+                          const char* line2, size_t len2, OrbitalElements* out_elements);
+
+// Orbit shape and orientation of one element set at a given time, under the
+// propagator's model (a and e are constant; node and perigee drift with J2)
+struct OrbitGeometry {
+    double a, e;              // km
+    double inclination;       // rad
+    double raan, argp;        // rad, at the requested time
+    double raanDot, argpDot;  // rad/min
+};
+
+/**
+ * Secular orbit geometry at a given time
+ *
+ * @param jd Time (Julian date)
+ * @return Error code (0 = success, non-zero = error)
+ */
+int orbit_geometry(const OrbitalElements* elements, double jd, OrbitGeometry* out);
+
+/**
+ * Upper bound on the distance an object moves between two samples
+ * stepSeconds apart anywhere in [firstJd, lastJd], under this propagator's
+ * model, so samples m steps apart are at most m times this far apart
+ *
+ * @return Distance in metres (+inf if the elements cannot be propagated)
+ */
+double propagation_step_bound_m(const OrbitalElements* elements, double firstJd, double lastJd,
+                                double stepSeconds);
+
+// Most samples window_steps accepts for one window
+const size_t MAX_WINDOW_STEPS = size_t(1) << 30;
+
+// Samples in a window of durationHours at stepSeconds, both ends included;
+// 0 if the step is not positive, the duration is negative or not finite, or
+// the grid would exceed MAX_WINDOW_STEPS
+size_t window_steps(double stepSeconds, double durationHours);
+
+// Element table of the built-in catalogs, in the same order (satellites,
+// then debris) as the store filled by propagate_coords_only
+void load_pipeline_elements(vector<OrbitalElements>& out);
+
+// Built-in catalogs with the per-object metadata a store needs, in store order
+struct PipelineCatalog {
+    vector<string> ids;
+    vector<bool> isDebris;
+    vector<uint32_t> catalogNumbers;
+    vector<OrbitalElements> elements;
+};
+
+void load_pipeline_catalog(PipelineCatalog& out);
+
+// One TLE input file and the kind of object it holds
+struct CatalogInput {
+    string path;
+    bool isDebris;
+};
+
+// The built-in inputs: data/satellites_1000.tle, then data/debris_3000.tle
+vector<CatalogInput> default_catalog_inputs();
+
+/**
+ * Load several TLE files into one catalog, objects in input order
+ *
+ * @param inputs Files to read, each with its object kind
+ * @param out Catalog (empty on error)
+ * @return Error code (0 = success, PROPAGATION_ERROR_INVALID_INPUT if a file cannot be opened)
+ */
+int load_catalog_inputs(const vector<CatalogInput>& inputs, PipelineCatalog& out);
+
+/**
+ * Propagate a loaded catalog over [startEpochMs, startEpochMs + durationHours]
+ * at stepSeconds, as propagate_coords_only does for the built-in catalogs
+ * (ids, flags and times included)
+ *
+ * @param threads Worker threads (0 = one per hardware thread)
+ * @return Error code (PROPAGATION_ERROR_INVALID_INPUT, with the store left
+ *         untouched, if window_steps rejects the grid). Objects whose elements
+ *         do not propagate are NaN in the store, as in the pipeline, and are
+ *         not an error.
+ */
+int propagate_catalog(const PipelineCatalog& catalog, double startEpochMs, double stepSeconds,
+                      double durationHours, TrajectoryStore& store, unsigned threads = 0);
+
+/**
+ * propagate_catalog through a binary ephemeris cache keyed on the inputs'
+ * contents and the time grid; an empty cachePath propagates without one
+ *
+ * @return true when the store was read from the cache
+ */
+bool propagate_catalog_cached(const vector<CatalogInput>& inputs, const PipelineCatalog& catalog,
+                              double startEpochMs, double stepSeconds, double durationHours,
+                              const string& cachePath, TrajectoryStore& store, unsigned threads = 0);
+
+// Time conversions between the pipeline timebase (Unix ms) and Julian date
+double unix_ms_to_jd(double unix_ms);
+double jd_to_unix_ms(double jd);
+
 // Internal helper functions are declared as static in the implementation file
 
 #endif // PROPAGATION_H
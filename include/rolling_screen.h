@@ -0,0 +1,60 @@
+#ifndef ROLLING_SCREEN_H
+#define ROLLING_SCREEN_H
+
+#include "simplified_core.h"
+#include "propagation.h"
+
+// Error codes for rolling screening functions
+#define ROLLING_SUCCESS 0
+#define ROLLING_ERROR_INVALID_INPUT 1
+
+// Continuous screening over a fixed-length horizon that follows wall time.
+// The store is a ring of time steps: advancing drops the expired steps,
+// propagates only the steps entering the horizon and screens only the passes
+// that start in the new slice, so an update costs in proportion to the advance.
+//
+// The last step of the horizon is held back until the next advance, so every
+// reported pass has at least one sample after its first hit to refine against.
+// With refineTca, a pass still in progress at the end of the horizon is held
+// back until it ends, and the steps from its start are screened again, for at
+// most ROLLING_MAX_HOLD_STEPS steps; after that it is reported as refined on
+// the stored steps (co-orbiting pairs may never leave the screening distance).
+const size_t ROLLING_MAX_HOLD_STEPS = 32;
+
+struct RollingScreen {
+    TrajectoryStore store;
+    vector<OrbitalElements> elements;   // by store index
+    double stepSeconds = 0.0;
+    double threshold_m = 0.0;
+    ScreeningOptions options;           // prefilter is not used
+    size_t screenedSteps = 0;           // passes starting before this step have been reported
+    unordered_map<uint64_t, double> lastReported; // pair -> time of its latest reported pass,
+                                                  // for passes screened again
+};
+
+/**
+ * Propagate the first horizon and screen it
+ *
+ * @param catalog Objects in store order
+ * @param startMs Horizon start (Unix ms)
+ * @param stepSeconds Sample spacing
+ * @param horizonHours Horizon length
+ * @param threshold_m Screening threshold
+ * @param options Screening options (prefilter is ignored)
+ * @param out Every pass found in the first horizon, by (aIndex, bIndex) then time
+ * @return Error code (0 = success, non-zero = error)
+ */
+int rolling_open(RollingScreen& window, const PipelineCatalog& catalog, double startMs,
+                 double stepSeconds, double horizonHours, double threshold_m,
+                 const ScreeningOptions& options, vector<Encounter>& out);
+
+/**
+ * Move the horizon start forward to the last step at or before nowMs
+ *
+ * @param nowMs Current time (Unix ms); earlier times are a no-op
+ * @param out Encounters for every pass that starts in the newly screened steps
+ * @return Error code (0 = success, non-zero = error)
+ */
+int rolling_advance(RollingScreen& window, double nowMs, vector<Encounter>& out);
+
+#endif // ROLLING_SCREEN_H
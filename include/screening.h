@@ -64,31 +64,9 @@ int screen_conjunctions(const StateVectorECI** trajectories, const char** ids,
                        size_t sat_count, double max_distance_km, 
                        Encounter* out_encounters, size_t* out_count, size_t max_out);
 
-/**
- * Sort encounters by collision risk (probability * severity factor)
- * 
- * @param encounters Array of encounters to sort
- * @param count Number of encounters
- */
-void sort_encounters_by_risk(Encounter* encounters, size_t count);
-
-/**
- * Sort encounters by time of closest approach
- * 
- * @param encounters Array of encounters to sort
- * @param count Number of encounters
- */
-void sort_encounters_by_time(Encounter* encounters, size_t count);
-
-/**
- * Filter encounters by minimum probability threshold
- * 
- * @param encounters Array of encounters (modified in-place)
- * @param count Number of encounters
- * @param min_probability Minimum probability threshold
- * @return Number of encounters remaining after filtering
- */
-size_t filter_by_probability(Encounter* encounters, size_t count, double min_probability);
+// Ranking, sorting and Pc filtering of screened encounters are declared
+// with the screening engine in simplified_core.h (sort_encounters_by_risk,
+// sort_encounters_by_time, filter_by_probability, top_encounters_by_risk)
 
 /**
  * Compute relative velocity magnitude between two state vectors
@@ -0,0 +1,49 @@
+#ifndef SCREENING_INDEX_H
+#define SCREENING_INDEX_H
+
+#include "simplified_core.h"
+
+// One object binned into the broad-phase grid at one time step
+struct ScreeningCell {
+    uint64_t key; // packed cell coordinates
+    uint32_t idx; // store index
+};
+
+// Broad-phase grid for every time step, kept between screening passes so
+// that a few changed objects can be re-screened without rebinning the rest
+struct ScreeningIndex {
+    double distance_m = 0.0;            // candidate distance the cells are sized for
+    double invCell = 0.0;               // 1 / cell edge (km)
+    vector<vector<ScreeningCell>> cells; // per step, sorted by (key, idx)
+};
+
+// Distance the broad and narrow phases use for a threshold under these
+// options (wider than the threshold when TCA refinement uses a margin)
+double screening_candidate_distance(double threshold_m, const ScreeningOptions& options);
+
+// Bin every object of every step
+void screening_index_build(ScreeningIndex& index, const TrajectoryStore& store,
+                           double distance_m, unsigned threads = 0);
+
+// Re-bin the given objects after their states changed in the store; objects
+// past the end of the previous store are added
+void screening_index_update(ScreeningIndex& index, const TrajectoryStore& store,
+                            const vector<uint32_t>& objects, unsigned threads = 0);
+
+// Append the store indices binned at step k in the 27 cells around a
+// position (km) that need not be in the index, e.g. a trial trajectory. Every
+// object within index.distance_m of the position is among them.
+void screening_index_neighbours(const ScreeningIndex& index, size_t k, const double r_km[3],
+                                vector<uint32_t>& out);
+
+/**
+ * Screen only the pairs that involve at least one of the given objects,
+ * using a prebuilt index. Same first-hit, refinement and severity rules as
+ * screen_by_threshold, which would report these pairs identically; results
+ * come back in (aIndex, bIndex) order. options.prefilter is not applied.
+ */
+vector<Encounter> screen_objects(const TrajectoryStore& store, const ScreeningIndex& index,
+                                 const vector<uint32_t>& objects, double threshold_m,
+                                 const ScreeningOptions& options);
+
+#endif // SCREENING_INDEX_H
@@ -0,0 +1,87 @@
+#ifndef SCREENING_SESSION_H
+#define SCREENING_SESSION_H
+
+#include "types.h"
+#include "simplified_core.h"
+#include "screening_index.h"
+#include "propagation.h"
+#include "maneuver.h"
+
+// Error codes for screening session functions
+#define SESSION_SUCCESS 0
+#define SESSION_ERROR_INVALID_INPUT 1
+
+// Encounter changes caused by one catalog update
+struct EncounterDiff {
+    vector<Encounter> added;    // pairs that now have an encounter
+    vector<Encounter> removed;  // pairs whose encounter went away (as previously reported)
+    vector<Encounter> changed;  // pairs whose time, distance, severity or Pc moved
+    vector<Encounter> previous; // previous value of each entry of changed
+};
+
+// Propagated catalog, broad-phase index and current encounter set, kept
+// between updates so only the objects whose TLEs change are reworked
+struct ScreeningSession {
+    TrajectoryStore store;
+    vector<OrbitalElements> elements;          // by store index
+    vector<uint32_t> catalogNumbers;           // by store index
+    unordered_map<uint32_t, uint32_t> byCatalogNumber;
+    ScreeningIndex index;
+    double threshold_m = 0.0;
+    ScreeningOptions options;                  // prefilter is not used
+    unordered_map<uint64_t, Encounter> encounters; // keyed by (aIndex << 32) | bIndex
+};
+
+/**
+ * Propagate a catalog over the window, build the index and screen it once
+ *
+ * @param catalog Objects in store order
+ * @param startMs Window start (Unix ms)
+ * @param stepSeconds Sample spacing
+ * @param durationHours Window length
+ * @param threshold_m Screening threshold
+ * @param options Screening options (prefilter is ignored)
+ * @return Error code (0 = success, non-zero = error)
+ */
+int session_open(ScreeningSession& session, const PipelineCatalog& catalog,
+                 double startMs, double stepSeconds, double durationHours,
+                 double threshold_m, const ScreeningOptions& options);
+
+/**
+ * Apply updated TLEs. Objects are matched by NORAD catalog number; unknown
+ * numbers are appended as new satellites. Only the updated objects are
+ * re-propagated and only pairs involving them are re-screened, after which
+ * the session holds the same encounters a full screen would report.
+ *
+ * @param updates Updated element sets (the last one wins for a repeated number)
+ * @param diff Output: changes to the encounter set
+ * @return Error code (0 = success, non-zero = error)
+ */
+int session_update(ScreeningSession& session, const vector<TLE>& updates, EncounterDiff& diff);
+
+// Outcome of one what-if maneuver
+struct ManeuverWhatIf {
+    vector<Encounter> encounters; // the object's encounters with the maneuver, in (aIndex, bIndex) order
+    EncounterDiff diff;           // against the session's current encounters of the object
+};
+
+/**
+ * Screen alternative maneuvers of one object against the cached catalog.
+ * For each maneuver the object's post-burn state (apply_maneuver) is
+ * propagated from the burn epoch on; earlier states are kept. Only that
+ * object is re-binned and screened, so each what-if costs O(N T) rather
+ * than a full re-screen. The session is restored before returning, and is
+ * not safe to share with other threads meanwhile.
+ *
+ * @param catalogNumber NORAD number of the maneuvering object
+ * @param maneuvers Alternatives, each applied on its own to the cached orbit
+ * @param out One result per maneuver
+ * @return Error code (0 = success, non-zero = error)
+ */
+int session_what_if(ScreeningSession& session, uint32_t catalogNumber,
+                    const vector<Maneuver>& maneuvers, vector<ManeuverWhatIf>& out);
+
+// Current encounters, in (aIndex, bIndex) order like screen_by_threshold
+vector<Encounter> session_encounters(const ScreeningSession& session);
+
+#endif // SCREENING_SESSION_H
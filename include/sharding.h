@@ -0,0 +1,108 @@
+#ifndef SHARDING_H
+#define SHARDING_H
+
+#include "pipeline.h"
+
+// Error codes for sharding functions
+#define SHARD_SUCCESS 0
+#define SHARD_ERROR_INVALID_INPUT 1
+#define SHARD_ERROR_IO 2
+#define SHARD_ERROR_FORMAT 3
+#define SHARD_ERROR_WORKER 4
+
+// Current encounter stream format revision (bump on any layout change)
+#define SHARD_STREAM_VERSION 1
+
+/*
+ * Sharded batch run. The catalog is split into blocks of consecutive
+ * objects and the pair space into tiles (a, b), a <= b: every pair with one
+ * object in block a and the other in block b. A coordinator runs two rounds
+ * of worker processes that share only a directory:
+ *
+ *   propagate:B    propagate block B into block_<B>.eph (ephemeris format)
+ *   screen:A:B     read blocks A and B, screen tile (A, B) and write its
+ *                  encounters to tile_<A>_<B>.enc (global object indices)
+ *
+ * then merges every tile's encounters into the usual conjunctions files.
+ * Each pair belongs to exactly one tile and its encounter depends only on
+ * the two objects. Merged tiers are written in time order, as an unsharded
+ * run writes (or streams) them, and ranked ones break risk ties by time, so
+ * the conjunctions files match an unsharded run byte for byte.
+ *
+ * Encounter stream layout (little-endian):
+ *   header      ShardStreamHeader
+ *   per tier    float64 threshold_m, uint64 count, count x ShardRecord
+ */
+struct ShardStreamHeader {
+    char     magic[8];  // "OGSHARD\0"
+    uint32_t version;   // SHARD_STREAM_VERSION
+    uint32_t tiers;     // one per screening job
+    uint64_t key;       // run key (catalog inputs, grid, block split)
+    double   startMs;   // grid start and end (Unix ms)
+    double   stopMs;
+};
+
+struct ShardRecord {
+    uint32_t aIndex, bIndex; // global store indices, aIndex < bIndex
+    double t;
+    double miss_m;
+    double rel_mps;
+    double pc;
+    int32_t severity;
+    uint32_t reserved;
+};
+
+// Object blocks and the tiles between them
+struct ShardPlan {
+    vector<size_t> blockBegin; // blocks + 1 offsets; block b is [blockBegin[b], blockBegin[b + 1])
+    vector<pair<uint32_t, uint32_t>> tiles; // (a, b), a <= b, in row order
+};
+
+// Split objects into `blocks` near-equal blocks (at least one object each)
+void plan_shards(size_t objects, size_t blocks, ShardPlan& out);
+
+// Exchange file of a block or tile inside the shard directory
+string shard_block_path(const string& dir, size_t block);
+string shard_tile_path(const string& dir, size_t a, size_t b);
+
+/**
+ * Write one tile's encounters, one list per screening job. The file is
+ * written under a temporary name and renamed, so it is either complete or
+ * absent.
+ *
+ * @return Error code (0 = success, non-zero = error)
+ */
+int write_shard_stream(const string& path, const ShardStreamHeader& header,
+                       const vector<EncounterTier>& tiers);
+
+/**
+ * Read a tile's encounters
+ *
+ * @param expectedKey Required run key
+ * @return Error code (0 = success, non-zero = error)
+ */
+int read_shard_stream(const string& path, uint64_t expectedKey, ShardStreamHeader& header,
+                      vector<EncounterTier>& tiers);
+
+/**
+ * Worker: run config.shardTask ("propagate:B" or "screen:A:B"). A block
+ * whose file already holds this run's key is not propagated again.
+ *
+ * @return Error code (0 = success, non-zero = error)
+ */
+int run_shard_task(const PipelineConfig& config);
+
+/**
+ * Coordinator: write the workers' config to the shard directory, run every
+ * propagate task, then every screen task, each as `program --config FILE
+ * --shard-task TASK` under config.shardLauncher (up to shardParallel at a
+ * time, output in <task>.log), then merge the tiles into each job's
+ * conjunctions file. Track outputs, when enabled, are assembled from the
+ * blocks.
+ *
+ * @param program Executable the workers run
+ * @return Error code (0 = success, non-zero = error)
+ */
+int run_sharded(const PipelineConfig& config, const string& program);
+
+#endif // SHARDING_H
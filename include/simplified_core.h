@@ -15,14 +15,66 @@ struct Trajectory {
     vector<State> states;
 };
 
+// Components held by TrajectoryStore, one plane each
+enum StoreComponent {
+    STORE_X = 0, STORE_Y, STORE_Z,
+    STORE_VX, STORE_VY, STORE_VZ,
+    STORE_COMPONENTS
+};
+
+// Contiguous trajectory storage: a single block of time-major planes.
+// Component c of object i at step k is row(c, k)[i], so one time step of x, y
+// or z is a contiguous run across the whole catalog. Rows and times form a
+// ring: step k lives in slot (head + k) % steps, so a rolling window drops its
+// oldest steps without moving the others.
+struct TrajectoryStore {
+    size_t count = 0;                    // number of objects
+    size_t steps = 0;                    // samples per object
+    size_t head = 0;                     // slot holding step 0
+    vector<double> times;                // sample time (Unix ms) by slot; use time(k)
+    vector<string> ids;                  // object id by index
+    vector<bool> isDebris;               // debris flag by index
+    unordered_map<string, size_t> index; // id -> index (first object with that id)
+    vector<double> data;                 // STORE_COMPONENTS planes of steps * count values
+
+    size_t slot(size_t k) const { return head + k < steps ? head + k : head + k - steps; }
+    double time(size_t k) const { return times[slot(k)]; }
+    double* row(int c, size_t k) { return data.data() + (c * steps + slot(k)) * count; }
+    const double* row(int c, size_t k) const { return data.data() + (c * steps + slot(k)) * count; }
+};
+
+// Objects are referenced by store index (ids[aIndex], ids[bIndex]) rather
+// than by copies of their ids, so encounters are plain values
 struct Encounter {
-    string aId;
-    string bId;
+    uint32_t aIndex = 0, bIndex = 0; // store indices, aIndex < bIndex
     double t;
     double miss_m;
     double rel_mps;
+    int severity; // Severity band relative to the screening threshold
+    double pc = numeric_limits<double>::quiet_NaN(); // collision probability (NaN until scored)
 };
 
+// Key of the pair (i, j) among n objects, as the screens use for per-pair
+// sets and maps
+uint64_t pair_key(uint32_t i, uint32_t j, size_t n);
+
+// Severity band (types.h Severity) of a miss distance relative to the
+// screening threshold, as every screen assigns it
+int severity_level(double distance_m, double threshold_m);
+
+// TrajectoryStore helpers
+void store_resize(TrajectoryStore& store, size_t objects, size_t steps);
+void store_grow(TrajectoryStore& store, size_t objects); // keeps existing objects; new ones are NaN with blank ids
+void store_add_id(TrajectoryStore& store, size_t i, const string& id, bool isDebris);
+void store_advance(TrajectoryStore& store, size_t steps); // drops the oldest steps; the new tail is stale until refilled
+int store_find(const TrajectoryStore& store, const string& id); // -1 if unknown
+size_t store_step_lower_bound(const TrajectoryStore& store, double t); // first step at or after t (steps if none)
+size_t store_step_upper_bound(const TrajectoryStore& store, double t); // first step after t (steps if none)
+State store_state(const TrajectoryStore& store, size_t i, size_t k);
+void store_set_state(TrajectoryStore& store, size_t i, size_t k, const State& s);
+TrajectoryStore store_from_trajectories(const vector<Trajectory>& tracks);
+vector<Trajectory> store_to_trajectories(const TrajectoryStore& store);
+
 // Function declarations
 vector<Trajectory> propagate_coords_only(
     vector<string>& ids,
@@ -31,10 +83,205 @@ vector<Trajectory> propagate_coords_only(
     double stepSeconds,
     double durationHours);
 
+struct PairPrefilter; // orbit_prefilter.h
+struct PcOptions;     // collision_probability.h
+
+// Screening engine options
+struct ScreeningOptions {
+    unsigned threads = 1;        // worker threads (0 = one per hardware thread)
+    bool refineTca = false;      // sub-step closest approach from stored velocities (fills t, miss_m, rel_mps)
+    double refineMargin_m = 0.0; // refineTca only: extra sample distance so passes that dip under
+                                 // threshold between samples are still examined
+    const PairPrefilter* prefilter = nullptr; // if set, only pairs it allows reach the narrow phase
+    const PcOptions* probability = nullptr;   // refineTca only: score each refined encounter's Pc
+    uint32_t splitIndex = 0;     // if non-zero, only pairs with i < splitIndex <= j (one block of
+                                 // objects against another); not used by screen_objects
+};
+
+// Propagates straight into a TrajectoryStore (ids, flags and times included);
+// false, with the store untouched, if window_steps rejects the time grid
+bool propagate_coords_only(
+    TrajectoryStore& store,
+    double startEpochMs,
+    double stepSeconds,
+    double durationHours);
+
+// Same as above, reusing a binary ephemeris cache when it matches the TLE
+// inputs and time grid (re-propagates and rewrites it otherwise)
+bool propagate_coords_cached(
+    TrajectoryStore& store,
+    double startEpochMs,
+    double stepSeconds,
+    double durationHours,
+    const string& cachePath);
+
 vector<Encounter> screen_by_threshold(
     const vector<Trajectory>& tracks, 
     double threshold_m);
 
+// Same result as above, bit for bit, for any thread count
+vector<Encounter> screen_by_threshold(
+    const vector<Trajectory>& tracks,
+    double threshold_m,
+    const ScreeningOptions& options);
+
+vector<Encounter> screen_by_threshold(
+    const TrajectoryStore& store,
+    double threshold_m,
+    const ScreeningOptions& options = ScreeningOptions{});
+
+// Encounters for every pass that starts within steps [firstStep, endStep):
+// samples within the screening distance there but not at the step before.
+// Each pass is refined within its own run of such samples, later steps
+// included. Unlike screen_by_threshold, a pair with several passes in the
+// range is reported once per pass. Sorted by pair, then time.
+//
+// With refineTca and resumeStep given, passes starting at or after holdFrom
+// that are still within the screening distance at the last stored step are
+// left out, since their refinement would stop at the edge of the grid;
+// *resumeStep is set to the first step such a pass starts at (endStep if
+// none), to screen again from once more steps are stored. Passes starting
+// before holdFrom are refined on the steps already stored.
+vector<Encounter> screen_step_range(
+    const TrajectoryStore& store,
+    size_t firstStep,
+    size_t endStep,
+    double threshold_m,
+    const ScreeningOptions& options = ScreeningOptions{},
+    size_t* resumeStep = nullptr,
+    size_t holdFrom = 0);
+
+// Same encounters as screen_by_threshold, found pair by pair instead of with
+// the per-step grid. Each pair jumps ahead by as many steps as it provably
+// cannot close the gap to the screening distance in: no object moves farther
+// between two samples than its largest sampled step, so a pair d metres
+// apart needs at least (d - distance) / (reach_i + reach_j) steps to get
+// there. Pairs come from options.prefilter when given, otherwise every pair
+// is walked, so this pays off for pair lists much smaller than the catalog
+// squared (or sparse, distant catalogs). Walks read a float copy of the
+// positions (a quarter of the store's size), falling back to the exact
+// doubles near the screening distance.
+vector<Encounter> screen_by_threshold_adaptive(
+    const TrajectoryStore& store,
+    double threshold_m,
+    const ScreeningOptions& options = ScreeningOptions{});
+
+// Encounters of one tier of a multi-threshold screen
+struct EncounterTier {
+    double threshold_m;
+    vector<Encounter> encounters; // severity banded relative to this tier's threshold
+};
+
+// Several thresholds for the cost of one pass: the broad phase runs once at
+// the largest threshold and each pair sample is classified into every tier
+// within reach. Tier t holds exactly what screen_by_threshold(store,
+// threshold t, options) returns. Tiers come back in ascending threshold
+// order; non-positive and repeated thresholds are dropped. A prefilter in
+// options must have been built for the largest threshold.
+vector<EncounterTier> screen_by_thresholds(
+    const TrajectoryStore& store,
+    const vector<double>& thresholds_m,
+    const ScreeningOptions& options = ScreeningOptions{});
+
+// One approach window of a pair: the span it stays within the threshold and
+// its closest approach
+struct EncounterPass {
+    Encounter tca; // closest approach, as a screen_by_threshold encounter
+    double entry;  // first time within threshold (Unix ms)
+    double exit;   // last time within threshold (Unix ms)
+};
+
+// Every approach of every pair, not only the first. Consecutive samples
+// within the screening distance are merged into one window as the pass runs,
+// so memory grows with the number of windows, not samples. Without
+// refineTca, entry and exit are the window's first and last sample and tca
+// its closest sample. With refineTca each pass inside a window whose refined
+// miss is within threshold_m is reported, with entry and exit at the
+// threshold crossings (passes that never leave the threshold in between are
+// one window). Sorted by pair, then time.
+vector<EncounterPass> screen_passes(
+    const TrajectoryStore& store,
+    double threshold_m,
+    const ScreeningOptions& options = ScreeningOptions{});
+
+// Receives encounters in batches as the screening pass moves forward in time
+typedef function<void(const Encounter* encounters, size_t count)> EncounterBatchFn;
+
+// Same encounters as screen_by_threshold, delivered during the pass in the
+// order sort_encounters_by_time gives them. A block's encounters are passed on
+// once no later block can report an earlier one; refined TCAs past the block
+// are held until the pass reaches them. Besides those, only the current
+// block's hits and one key per reported pair are kept.
+size_t screen_by_threshold_streaming(
+    const TrajectoryStore& store,
+    double threshold_m,
+    const ScreeningOptions& options,
+    const EncounterBatchFn& onBatch);
+
+// Encounter ranking. Risk order puts the highest collision probability first
+// (encounters without a Pc after every scored one), then the higher severity,
+// then the smaller miss distance; remaining ties keep their input order, so
+// the result does not depend on the thread count. Sorts run over compact key
+// arrays and move each encounter once.
+
+// Full risk order; threads sort runs of the input in parallel and merge them
+void sort_encounters_by_risk(Encounter* encounters, size_t count, unsigned threads = 1);
+
+// Time order, then by object index (the order the conjunction writers use)
+void sort_encounters_by_time(Encounter* encounters, size_t count, unsigned threads = 1);
+
+/**
+ * Keep the encounters whose Pc is at least min_probability, in order.
+ * Encounters without a Pc are kept only when min_probability <= 0.
+ *
+ * @return Number of encounters remaining (moved to the front)
+ */
+size_t filter_by_probability(Encounter* encounters, size_t count, double min_probability);
+
+/**
+ * The k highest risks among the encounters filter_by_probability would keep,
+ * in risk order: the first k of filtering and sorting by risk, without
+ * sorting (or copying) the rest. Each worker keeps at most 2k keys of its
+ * share, so memory follows k, not count.
+ */
+vector<Encounter> top_encounters_by_risk(const Encounter* encounters, size_t count, size_t k,
+                                         double min_probability = 0.0, unsigned threads = 1);
+
 // JSON serialization helpers
 void writeTracksJSON(const vector<Trajectory>& tracks, double startMs, double stopMs, double stepSeconds);
-void writeEncountersJSON(const vector<Encounter>& encounters);
+
+// Encounter times are written as minutes after startMs; ids are the store ids
+// the encounter indices refer to
+void writeEncountersJSON(const vector<Encounter>& encounters, const vector<string>& ids,
+                         double startMs = 0.0);
+
+// Screen and write tests/conjunctions.json incrementally, flushing after every
+// batch; returns the number of encounters written
+size_t streamConjunctionsJSON(const TrajectoryStore& store, double threshold_m,
+                              const ScreeningOptions& options = ScreeningOptions{});
+
+// Same as above, written to path (same format); false if the file cannot be
+// written. count, if given, receives the number of encounters screened.
+bool streamConjunctionsJSON(const string& path, const TrajectoryStore& store, double threshold_m,
+                            const ScreeningOptions& options = ScreeningOptions{},
+                            size_t* count = nullptr);
+
+// Same as the first overload, for tracks (copied into a store first) with
+// default options
+size_t streamConjunctionsJSON(const vector<Trajectory>& tracks, double threshold_m);
+
+// Already screened encounters of a store, written to path in the same format
+// and time order (then by object index); false if the file cannot be written
+bool writeEncountersJSON(const string& path, const vector<Encounter>& encounters,
+                         const TrajectoryStore& store);
+
+// Same, for encounters whose indices refer to ids, over a grid [startMs, stopMs];
+// without timeOrder they are written in the order given (e.g. ranked by risk)
+bool writeEncountersJSON(const string& path, const vector<Encounter>& encounters,
+                         const vector<string>& ids, double startMs, double stopMs,
+                         bool timeOrder = true);
+
+// Every approach window, in the same format and order plus "entry_minutes"
+// and "exit_minutes" per entry; false if the file cannot be written
+bool writePassesJSON(const string& path, const vector<EncounterPass>& passes,
+                     const TrajectoryStore& store);
@@ -0,0 +1,78 @@
+#ifndef TCA_REFINE_H
+#define TCA_REFINE_H
+
+#include "simplified_core.h"
+
+// Closest approach of one pass between two stored objects
+struct TcaEstimate {
+    double t;        // time of closest approach (Unix ms)
+    double miss_m;   // distance at t
+    double rel_mps;  // relative speed at t
+    size_t passEnd;  // first step after this pass's minimum
+};
+
+/**
+ * Refine the pass that sample k belongs to. The relative motion between the
+ * two samples bracketing the minimum is modelled as a cubic Hermite curve
+ * built from the stored positions and velocities, and the range rate
+ * r . dr/dt is driven to zero on it. Falls back to the closest sample when
+ * the minimum is at the edge of the time grid or a state is not finite.
+ *
+ * @return false if the states at sample k are not finite
+ */
+bool refine_pass_tca(const TrajectoryStore& store, size_t i, size_t j, size_t k,
+                     TcaEstimate& out);
+
+/**
+ * First pass at or after sample k whose refined miss distance is within
+ * threshold_m. Passes are only examined where a sample is within
+ * threshold_m + margin_m, so the margin should cover how much closer two
+ * objects can get between samples.
+ *
+ * @param endStep Only passes reaching the margin before this step are examined
+ * @return true if such a pass was found (written to out)
+ */
+bool find_first_tca(const TrajectoryStore& store, size_t i, size_t j, size_t k,
+                    double threshold_m, double margin_m, TcaEstimate& out,
+                    size_t endStep = SIZE_MAX);
+
+/**
+ * Every pass from sample k on whose refined miss distance is within
+ * threshold_m, in time order; the same pass test as find_first_tca without
+ * stopping at the first.
+ *
+ * @param endStep Only passes reaching the margin before this step are examined
+ * @return Number of passes appended to out
+ */
+size_t find_pass_tcas(const TrajectoryStore& store, size_t i, size_t j, size_t k,
+                      double threshold_m, double margin_m, vector<TcaEstimate>& out,
+                      size_t endStep = SIZE_MAX);
+
+/**
+ * Span of a refined pass within threshold_m: the threshold crossings either
+ * side of tca.t on the same Hermite model, bisected to a millisecond. A side
+ * still within threshold at the edge of the grid (or next to a non-finite
+ * state) ends at that sample.
+ *
+ * @param entry Output first time within threshold_m (Unix ms)
+ * @param exit Output last time within threshold_m (Unix ms)
+ */
+void pass_window(const TrajectoryStore& store, size_t i, size_t j, const TcaEstimate& tca,
+                 double threshold_m, double& entry, double& exit);
+
+/**
+ * State of one object at an arbitrary time inside the store's grid, from the
+ * same cubic Hermite model refinement uses (positions and their derivative)
+ *
+ * @param t Time (Unix ms)
+ * @param r Output position (km)
+ * @param v Output velocity (km/s)
+ * @return false if t is outside the grid or a bracketing state is not finite
+ */
+bool interpolate_state(const TrajectoryStore& store, size_t i, double t, double r[3], double v[3]);
+
+// ScreeningOptions::refineMargin_m that cannot miss a pass at the given sample
+// spacing: half a step at the largest possible relative speed
+double refine_margin_for_step(double stepSeconds);
+
+#endif // TCA_REFINE_H
@@ -0,0 +1,44 @@
+#pragma once
+#include "types.h"
+#include "mapped_file.h"
+
+// Zero-copy view of one TLE record inside a loaded catalog buffer.
+// Fields point into the catalog's mapped file and are not NUL-terminated.
+struct TLEView {
+    const char* name;
+    const char* line1;
+    const char* line2;
+    uint32_t nameLen;
+    uint32_t line1Len;
+    uint32_t line2Len;
+};
+
+// Memory-mapped TLE catalog. Records stay valid while the catalog is open;
+// the mapping is released by close_tle_catalog or when the catalog is destroyed.
+struct TLECatalog {
+    MappedFile file;
+    vector<TLEView> records;
+};
+
+/**
+ * Map a TLE file and index its records in place
+ *
+ * Accepts the same input as parseTLEfile (3-line records, CRLF or LF, blank
+ * lines ignored) and yields the same records in the same order.
+ *
+ * @param filename TLE file path
+ * @param out Catalog to fill (closed first if already open)
+ * @param threads Parser threads; the buffer is split on record boundaries
+ *                (0 = one per hardware thread)
+ * @return true on success, false when the file cannot be opened
+ */
+bool open_tle_catalog(const string& filename, TLECatalog& out, unsigned threads = 1);
+void close_tle_catalog(TLECatalog& catalog);
+
+// Index the records of a TLE text already in memory (same rules as
+// open_tle_catalog); views point into data, appended to out
+void index_tle_buffer(const char* data, size_t size, vector<TLEView>& out);
+
+// Owned copy of a record (same truncation rules as parseTLEfile)
+TLE tle_from_view(const TLEView& view);
+string tle_view_name(const TLEView& view);
@@ -0,0 +1,88 @@
+#ifndef TRACK_EXPORT_H
+#define TRACK_EXPORT_H
+
+#include "simplified_core.h"
+
+// Error codes for track export functions
+#define TRACK_EXPORT_SUCCESS 0
+#define TRACK_EXPORT_ERROR_IO 1
+#define TRACK_EXPORT_ERROR_FORMAT 2
+
+// Current blob format revision (bump on any layout change)
+#define TRACK_BLOB_VERSION 1
+
+// Which samples of each object get exported
+struct TrackExportOptions {
+    uint32_t stride = 1;            // keep every stride-th step (1 = all)
+    uint32_t debrisStride = 0;      // stride for debris objects (0 = same as stride)
+    vector<uint32_t> objectStride;  // per-object override by store index (0 = default)
+    bool velocities = true;         // blob: store vx, vy, vz next to x, y, z
+    bool series = true;             // JSON: write the sampled positions, not just the final state
+    int decimals = 3;               // JSON: decimal places for sampled positions
+};
+
+/*
+ * Blob layout (little-endian, offsets in bytes, all offsets 4-byte aligned so
+ * the viewer can wrap each section in a typed array without copying):
+ *   header      TrackBlobHeader (64 bytes)
+ *   objects     count x TrackBlobObject
+ *   names       UTF-8 bytes, referenced by the object table
+ *   padding     to a 16-byte boundary
+ *   samples     float32; per object, samples x components values, sample
+ *               s of object i taken at startMs + s * stride * stepMs
+ */
+struct TrackBlobHeader {
+    char     magic[8];     // "OGTRACK\0"
+    uint32_t version;      // TRACK_BLOB_VERSION
+    uint32_t count;        // objects
+    uint32_t steps;        // steps in the source store
+    uint32_t components;   // 3 (x, y, z km) or 6 (plus vx, vy, vz km/s)
+    double   startMs;      // time of the first step (Unix ms)
+    double   stepMs;       // step spacing (ms)
+    uint32_t objectsOffset;
+    uint32_t namesOffset;
+    uint32_t namesBytes;
+    uint32_t samplesOffset;
+    uint32_t sampleFloats; // total float32 values in the samples section
+    uint32_t reserved;
+};
+
+struct TrackBlobObject {
+    uint32_t stride;       // steps between samples
+    uint32_t samples;      // samples stored for this object
+    uint32_t firstFloat;   // index of its first value in the samples section
+    uint32_t nameOffset;   // into the names section
+    uint32_t nameBytes;
+    uint32_t isDebris;     // 0 or 1
+};
+
+// Stride used for object i under the given options (always >= 1)
+uint32_t export_stride(const TrajectoryStore& store, const TrackExportOptions& options, size_t i);
+
+/**
+ * Write the sampled time series of every object as a float32 blob
+ *
+ * @return Error code (0 = success, non-zero = error)
+ */
+int write_tracks_blob(const string& path, const TrajectoryStore& store,
+                      const TrackExportOptions& options = TrackExportOptions{});
+
+/**
+ * Write coordinates.json: final state per object (same fields as writeTracksJSON)
+ * and, when options.series is set, its sampled positions as a flat
+ * [x, y, z, x, y, z, ...] array
+ *
+ * @return Error code (0 = success, non-zero = error)
+ */
+int write_tracks_json(const string& path, const TrajectoryStore& store,
+                      const TrackExportOptions& options = TrackExportOptions{});
+
+// Same outputs from a mixed-precision store. The blob holds the same float
+// values as from the double store; JSON values carry float precision.
+struct CompactStore; // compact_store.h
+int write_tracks_blob(const string& path, const CompactStore& store,
+                      const TrackExportOptions& options = TrackExportOptions{});
+int write_tracks_json(const string& path, const CompactStore& store,
+                      const TrackExportOptions& options = TrackExportOptions{});
+
+#endif // TRACK_EXPORT_H
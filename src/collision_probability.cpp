@@ -0,0 +1,464 @@
+#include "collision_probability.h"
+#include "tca_refine.h"
+#include "constants.h"
+#include "parallel.h"
+#include "instrumentation.h"
+#include <cstring>
+
+#if (defined(__GNUC__) || defined(__clang__)) && (defined(__x86_64__) || defined(__i386__))
+#define PC_HAVE_X86 1
+#include <immintrin.h>
+#endif
+
+namespace {
+
+// Monte Carlo samples per batch, and batches per encounter between
+// convergence checks (fixed, so results do not depend on the thread count)
+const size_t MC_BATCH = 4096;
+const size_t MC_ROUND_BATCHES = 16;
+
+// Simpson intervals for the analytic integral (raised for narrow covariances)
+const int PC_MIN_INTERVALS = 128;
+const int PC_MAX_INTERVALS = 8192;
+
+double dot3(const double* a, const double* b) {
+    return a[0] * b[0] + a[1] * b[1] + a[2] * b[2];
+}
+
+void cross3(const double* a, const double* b, double* out) {
+    out[0] = a[1] * b[2] - a[2] * b[1];
+    out[1] = a[2] * b[0] - a[0] * b[2];
+    out[2] = a[0] * b[1] - a[1] * b[0];
+}
+
+bool normalize3(double* a) {
+    const double n = sqrt(dot3(a, a));
+    if (!(n > 0.0)) return false;
+    for (int c = 0; c < 3; ++c) a[c] /= n;
+    return true;
+}
+
+// Any unit vector perpendicular to u
+void perpendicular(const double* u, double* out) {
+    const double axis[3] = {fabs(u[0]) < 0.9 ? 1.0 : 0.0, fabs(u[0]) < 0.9 ? 0.0 : 1.0, 0.0};
+    cross3(u, axis, out);
+    normalize3(out);
+}
+
+// Add sigma^2 e e^T for the radial / in-track / cross-track axes of (r, v)
+void add_rtn_covariance(const double* r, const double* v, double sr, double st, double sn,
+                        double* cov) {
+    double R[3] = {r[0], r[1], r[2]}, N[3], T[3];
+    cross3(r, v, N);
+    if (!normalize3(R) || !normalize3(N)) {
+        // No usable frame: spread the largest sigma over every axis
+        const double s = max(sr, max(st, sn));
+        for (int a = 0; a < 3; ++a) cov[a * 3 + a] += s * s;
+        return;
+    }
+    cross3(N, R, T);
+    const double* axes[3] = {R, T, N};
+    const double sig[3] = {sr, st, sn};
+    for (int k = 0; k < 3; ++k) {
+        for (int a = 0; a < 3; ++a) {
+            for (int b = 0; b < 3; ++b) cov[a * 3 + b] += sig[k] * sig[k] * axes[k][a] * axes[k][b];
+        }
+    }
+}
+
+// Lower-triangular L with L L^T = cov (tiny floor on the pivots)
+void cholesky3(const double* cov, double* L) {
+    memset(L, 0, 9 * sizeof(double));
+    for (int i = 0; i < 3; ++i) {
+        for (int j = 0; j <= i; ++j) {
+            double s = cov[i * 3 + j];
+            for (int k = 0; k < j; ++k) s -= L[i * 3 + k] * L[j * 3 + k];
+            if (i == j) {
+                L[i * 3 + i] = sqrt(max(s, 1e-18));
+            } else {
+                L[i * 3 + j] = s / L[j * 3 + j];
+            }
+        }
+    }
+}
+
+double quad_form(const double* cov, const double* a, const double* b) {
+    double s = 0.0;
+    for (int i = 0; i < 3; ++i) {
+        for (int j = 0; j < 3; ++j) s += a[i] * cov[i * 3 + j] * b[j];
+    }
+    return s;
+}
+
+// Everything the estimators need about one encounter, in metres and m/s
+struct EncounterGeometry {
+    bool valid;
+    double r[3], v[3];     // state of b relative to a
+    double L[9], Lv[9];    // Cholesky factors of the combined covariances
+    bool velocityNoise;
+    double radius;
+    double missX, missY, cxx, cxy, cyy; // encounter-plane projection
+    double l00, l10, l11;                // Cholesky factor of the plane covariance
+};
+
+double hard_body_radius(const TrajectoryStore& store, const PcOptions& options, uint32_t i) {
+    if (i < options.radii_m.size()) return options.radii_m[i];
+    return store.isDebris[i] ? options.debrisRadius_m : options.satelliteRadius_m;
+}
+
+const StateSigma& state_sigma(const TrajectoryStore& store, const PcOptions& options, uint32_t i) {
+    if (i < options.sigmas.size()) return options.sigmas[i];
+    return store.isDebris[i] ? options.debrisSigma : options.satelliteSigma;
+}
+
+EncounterGeometry encounter_geometry(const TrajectoryStore& store, const Encounter& e,
+                                     const PcOptions& options) {
+    EncounterGeometry g;
+    memset(&g, 0, sizeof(g));
+    double ra[3], va[3], rb[3], vb[3];
+    if (e.aIndex >= store.count || e.bIndex >= store.count ||
+        !interpolate_state(store, e.aIndex, e.t, ra, va) ||
+        !interpolate_state(store, e.bIndex, e.t, rb, vb)) {
+        return g;
+    }
+    for (int c = 0; c < 3; ++c) {
+        ra[c] *= 1000.0; va[c] *= 1000.0;
+        rb[c] *= 1000.0; vb[c] *= 1000.0;
+        g.r[c] = rb[c] - ra[c];
+        g.v[c] = vb[c] - va[c];
+    }
+    g.radius = hard_body_radius(store, options, e.aIndex) + hard_body_radius(store, options, e.bIndex);
+
+    // Independent objects: covariances add
+    double cov[9] = {0}, covV[9] = {0};
+    const StateSigma& sa = state_sigma(store, options, e.aIndex);
+    const StateSigma& sb = state_sigma(store, options, e.bIndex);
+    add_rtn_covariance(ra, va, sa.radial_m, sa.intrack_m, sa.crosstrack_m, cov);
+    add_rtn_covariance(rb, vb, sb.radial_m, sb.intrack_m, sb.crosstrack_m, cov);
+    add_rtn_covariance(ra, va, sa.radial_mps, sa.intrack_mps, sa.crosstrack_mps, covV);
+    add_rtn_covariance(rb, vb, sb.radial_mps, sb.intrack_mps, sb.crosstrack_mps, covV);
+    cholesky3(cov, g.L);
+    cholesky3(covV, g.Lv);
+    g.velocityNoise = sa.radial_mps > 0.0 || sa.intrack_mps > 0.0 || sa.crosstrack_mps > 0.0 ||
+                      sb.radial_mps > 0.0 || sb.intrack_mps > 0.0 || sb.crosstrack_mps > 0.0;
+
+    // Encounter plane: normal to the relative velocity, x along the miss vector
+    double u[3] = {g.v[0], g.v[1], g.v[2]}, e1[3], e2[3];
+    if (!normalize3(u)) {
+        // No relative motion: any plane through the miss vector will do
+        double m[3] = {g.r[0], g.r[1], g.r[2]};
+        if (!normalize3(m)) m[0] = 1.0;
+        perpendicular(m, u);
+    }
+    const double along = dot3(g.r, u);
+    for (int c = 0; c < 3; ++c) e1[c] = g.r[c] - along * u[c];
+    if (!normalize3(e1)) perpendicular(u, e1);
+    cross3(u, e1, e2);
+    g.missX = dot3(g.r, e1);
+    g.missY = dot3(g.r, e2);
+    g.cxx = quad_form(cov, e1, e1);
+    g.cxy = quad_form(cov, e1, e2);
+    g.cyy = quad_form(cov, e2, e2);
+    g.l00 = sqrt(max(g.cxx, 1e-18));
+    g.l10 = g.cxy / g.l00;
+    g.l11 = sqrt(max(g.cyy - g.l10 * g.l10, 1e-18));
+    g.valid = true;
+    return g;
+}
+
+// P(a < N(0, 1) * sqrt(2) < b) * 2, i.e. erf(b) - erf(a), without cancellation in the tails
+double erf_difference(double a, double b) {
+    if (a >= 0.0) return erfc(a) - erfc(b);
+    if (b <= 0.0) return erfc(-b) - erfc(-a);
+    return erf(b) - erf(a);
+}
+
+// ---- Monte Carlo ----
+
+// Four interleaved xorshift128+ generators; lane l yields every fourth value
+struct Xorshift4 {
+    uint64_t s0[4], s1[4];
+};
+
+uint64_t splitmix64(uint64_t& x) {
+    uint64_t z = (x += 0x9e3779b97f4a7c15ull);
+    z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ull;
+    z = (z ^ (z >> 27)) * 0x94d049bb133111ebull;
+    return z ^ (z >> 31);
+}
+
+void seed_generator(Xorshift4& g, uint64_t key) {
+    for (int l = 0; l < 4; ++l) {
+        g.s0[l] = splitmix64(key);
+        g.s1[l] = splitmix64(key) | 1;
+    }
+}
+
+// Top 52 bits as a double in [0, 1)
+double unit_from_bits(uint64_t x) {
+    const uint64_t bits = (x >> 12) | 0x3FF0000000000000ull;
+    double d;
+    memcpy(&d, &bits, sizeof(d));
+    return d - 1.0;
+}
+
+typedef void (*UniformFn)(Xorshift4&, double*, size_t);
+
+// n must be a multiple of 4
+void uniforms_scalar(Xorshift4& g, double* out, size_t n) {
+    for (size_t j = 0; j < n; j += 4) {
+        for (int l = 0; l < 4; ++l) {
+            uint64_t x = g.s0[l];
+            const uint64_t y = g.s1[l];
+            g.s0[l] = y;
+            x ^= x << 23;
+            g.s1[l] = x ^ y ^ (x >> 17) ^ (y >> 26);
+            out[j + l] = unit_from_bits(g.s1[l] + y);
+        }
+    }
+}
+
+#ifdef PC_HAVE_X86
+// Same stream as uniforms_scalar, four lanes per instruction
+__attribute__((target("avx2")))
+void uniforms_avx2(Xorshift4& g, double* out, size_t n) {
+    __m256i s0 = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(g.s0));
+    __m256i s1 = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(g.s1));
+    const __m256i exponent = _mm256_set1_epi64x(0x3FF0000000000000ll);
+    const __m256d one = _mm256_set1_pd(1.0);
+    for (size_t j = 0; j < n; j += 4) {
+        __m256i x = s0;
+        const __m256i y = s1;
+        s0 = y;
+        x = _mm256_xor_si256(x, _mm256_slli_epi64(x, 23));
+        s1 = _mm256_xor_si256(_mm256_xor_si256(x, y),
+                              _mm256_xor_si256(_mm256_srli_epi64(x, 17), _mm256_srli_epi64(y, 26)));
+        const __m256i bits = _mm256_or_si256(_mm256_srli_epi64(_mm256_add_epi64(s1, y), 12), exponent);
+        _mm256_storeu_pd(out + j, _mm256_sub_pd(_mm256_castsi256_pd(bits), one));
+    }
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(g.s0), s0);
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(g.s1), s1);
+}
+#endif
+
+UniformFn uniform_fn() {
+#ifdef PC_HAVE_X86
+    static const UniformFn fn = __builtin_cpu_supports("avx2") ? uniforms_avx2 : uniforms_scalar;
+#else
+    static const UniformFn fn = uniforms_scalar;
+#endif
+    return fn;
+}
+
+// Per-worker sample buffers: uniforms, then standard normals by plane
+struct McWorker {
+    vector<double> uniforms;
+    vector<double> normals; // 6 planes of MC_BATCH
+    McWorker() : uniforms(6 * MC_BATCH), normals(6 * MC_BATCH) {}
+};
+
+uint64_t stream_key(uint64_t seed, const Encounter& e, uint64_t batch) {
+    uint64_t t;
+    memcpy(&t, &e.t, sizeof(t));
+    uint64_t x = seed ^ (static_cast<uint64_t>(e.aIndex) << 32 | e.bIndex);
+    x = splitmix64(x) ^ t;
+    x = splitmix64(x) ^ batch;
+    return splitmix64(x);
+}
+
+// Hits (sampled miss distance inside the hard-body radius) in one batch
+uint64_t batch_hits(const EncounterGeometry& g, uint64_t key, McWorker& w) {
+    // Without velocity noise the miss vector is the plane projection of the
+    // position offset, so two normals per sample suffice
+    const size_t planes = g.velocityNoise ? 6 : 2;
+    Xorshift4 gen;
+    seed_generator(gen, key);
+    uniform_fn()(gen, w.uniforms.data(), planes * MC_BATCH);
+
+    // Box-Muller: planes (2p, 2p + 1) come from uniform planes (2p, 2p + 1)
+    for (size_t p = 0; p < planes; p += 2) {
+        const double* u1 = w.uniforms.data() + p * MC_BATCH;
+        const double* u2 = u1 + MC_BATCH;
+        double* z1 = w.normals.data() + p * MC_BATCH;
+        double* z2 = z1 + MC_BATCH;
+        for (size_t s = 0; s < MC_BATCH; ++s) {
+            const double rho = sqrt(-2.0 * log(1.0 - u1[s]));
+            const double theta = TWO_PI * u2[s];
+            z1[s] = rho * cos(theta);
+            z2[s] = rho * sin(theta);
+        }
+    }
+
+    const double* z0 = w.normals.data();
+    const double* z1 = z0 + MC_BATCH;
+    const double R2 = g.radius * g.radius;
+    uint64_t hits = 0;
+    if (!g.velocityNoise) {
+        for (size_t s = 0; s < MC_BATCH; ++s) {
+            const double x = g.missX + g.l00 * z0[s];
+            const double y = g.missY + g.l10 * z0[s] + g.l11 * z1[s];
+            hits += (x * x + y * y < R2) ? 1 : 0;
+        }
+        return hits;
+    }
+
+    const double* z2 = z1 + MC_BATCH;
+    const double* L = g.L;
+    const double* z3 = z2 + MC_BATCH;
+    const double* z4 = z3 + MC_BATCH;
+    const double* z5 = z4 + MC_BATCH;
+    const double* Lv = g.Lv;
+    for (size_t s = 0; s < MC_BATCH; ++s) {
+        const double px = g.r[0] + L[0] * z0[s];
+        const double py = g.r[1] + L[3] * z0[s] + L[4] * z1[s];
+        const double pz = g.r[2] + L[6] * z0[s] + L[7] * z1[s] + L[8] * z2[s];
+        const double wx = g.v[0] + Lv[0] * z3[s];
+        const double wy = g.v[1] + Lv[3] * z3[s] + Lv[4] * z4[s];
+        const double wz = g.v[2] + Lv[6] * z3[s] + Lv[7] * z4[s] + Lv[8] * z5[s];
+        const double w2 = wx * wx + wy * wy + wz * wz;
+        const double pw = px * wx + py * wy + pz * wz;
+        const double miss2 = px * px + py * py + pz * pz - (w2 > 0.0 ? pw * pw / w2 : 0.0);
+        hits += miss2 < R2 ? 1 : 0;
+    }
+    return hits;
+}
+
+// Monte Carlo progress of one encounter
+struct McRun {
+    size_t encounter;
+    uint64_t hits = 0;
+    uint64_t samples = 0;
+};
+
+bool mc_converged(const McRun& run, const PcOptions& options) {
+    const double n = static_cast<double>(run.samples);
+    if (run.samples >= options.mcMaxSamples) return true;
+    // Pc confidently below the floor: a ~3 sigma Poisson upper bound on the hit count
+    const double hits = static_cast<double>(run.hits);
+    if ((hits + 3.0 + 3.0 * sqrt(hits)) / n < options.mcFloor) return true;
+    if (run.hits == 0) return false;
+    const double p = run.hits / n;
+    return sqrt(p * (1.0 - p) / n) <= options.mcTolerance * p;
+}
+
+void run_monte_carlo(const vector<EncounterGeometry>& geometry, const Encounter* encounters,
+                     vector<McRun>& runs, const PcOptions& options, unsigned threads) {
+    vector<McWorker> workers(threads);
+    vector<size_t> active(runs.size());
+    for (size_t a = 0; a < runs.size(); ++a) active[a] = a;
+    vector<uint64_t> itemHits;
+
+    // Each round gives every unconverged encounter MC_ROUND_BATCHES batches;
+    // the batches of all of them are spread across the workers together
+    while (!active.empty()) {
+        itemHits.assign(active.size() * MC_ROUND_BATCHES, 0);
+        parallel_for_chunks(itemHits.size(), 1, threads, [&](unsigned wi, size_t begin, size_t end) {
+            for (size_t item = begin; item < end; ++item) {
+                McRun& run = runs[active[item / MC_ROUND_BATCHES]];
+                const uint64_t batch = run.samples / MC_BATCH + item % MC_ROUND_BATCHES;
+                itemHits[item] = batch_hits(geometry[run.encounter],
+                                            stream_key(options.seed, encounters[run.encounter], batch),
+                                            workers[wi]);
+            }
+        });
+
+        size_t still = 0;
+        for (size_t a = 0; a < active.size(); ++a) {
+            McRun& run = runs[active[a]];
+            for (size_t b = 0; b < MC_ROUND_BATCHES; ++b) run.hits += itemHits[a * MC_ROUND_BATCHES + b];
+            run.samples += MC_ROUND_BATCHES * MC_BATCH;
+            if (!mc_converged(run, options)) active[still++] = active[a];
+        }
+        active.resize(still);
+    }
+}
+
+} // namespace
+
+double pc_analytic_2d(double missX_m, double missY_m, double cxx, double cxy, double cyy,
+                      double radius_m) {
+    if (!(radius_m > 0.0)) return 0.0;
+
+    // Principal axes of the covariance, x along the larger spread
+    const double phi = 0.5 * atan2(2.0 * cxy, cxx - cyy);
+    const double c = cos(phi), s = sin(phi);
+    double sx2 = cxx * c * c + 2.0 * cxy * s * c + cyy * s * s;
+    double sy2 = cxx * s * s - 2.0 * cxy * s * c + cyy * c * c;
+    double xm = missX_m * c + missY_m * s;
+    double ym = -missX_m * s + missY_m * c;
+    if (sy2 > sx2) {
+        swap(sx2, sy2);
+        swap(xm, ym);
+    }
+    const double sx = sqrt(max(sx2, 0.0));
+    const double sy = max(sqrt(max(sy2, 0.0)), 1e-12 * radius_m);
+    if (!(sx > 1e-9 * radius_m)) {
+        return xm * xm + ym * ym < radius_m * radius_m ? 1.0 : 0.0;
+    }
+
+    // Alfano's form: Gaussian along x times the erf-integrated chord along y,
+    // with x = R sin(theta) so the chord endpoints are smooth
+    int intervals = PC_MIN_INTERVALS;
+    const double needed = 16.0 * radius_m / sx;
+    if (needed > intervals) intervals = needed < PC_MAX_INTERVALS ? static_cast<int>(needed) : PC_MAX_INTERVALS;
+    intervals += intervals & 1;
+
+    const double h = PI / intervals;
+    const double norm = 1.0 / (sqrt(TWO_PI) * sx);
+    const double ry = 1.0 / (sqrt(2.0) * sy);
+    double sum = 0.0;
+    for (int n = 0; n <= intervals; ++n) {
+        const double theta = -0.5 * PI + n * h;
+        const double chord = radius_m * cos(theta);
+        const double x = radius_m * sin(theta);
+        const double dx = (x - xm) / sx;
+        const double f = chord * norm * exp(-0.5 * dx * dx) *
+                         0.5 * erf_difference((ym - chord) * ry, (ym + chord) * ry);
+        sum += f * (n == 0 || n == intervals ? 1.0 : (n & 1 ? 4.0 : 2.0));
+    }
+    const double pc = sum * h / 3.0;
+    return pc < 0.0 ? 0.0 : (pc > 1.0 ? 1.0 : pc);
+}
+
+int score_encounters(const TrajectoryStore& store, Encounter* encounters, size_t count,
+                     const PcOptions& options, vector<PcEstimate>* details) {
+    if (count && !encounters) return PC_ERROR_INVALID_INPUT;
+    NOVA_SCOPE("score_encounters");
+    const unsigned threads = resolve_thread_count(options.threads);
+    const double nan = numeric_limits<double>::quiet_NaN();
+
+    vector<EncounterGeometry> geometry(count);
+    vector<PcEstimate> estimates(count);
+    parallel_for_chunks(count, 64, threads, [&](unsigned, size_t begin, size_t end) {
+        for (size_t e = begin; e < end; ++e) {
+            geometry[e] = encounter_geometry(store, encounters[e], options);
+            const EncounterGeometry& g = geometry[e];
+            estimates[e].pc = g.valid ? pc_analytic_2d(g.missX, g.missY, g.cxx, g.cxy, g.cyy, g.radius) : nan;
+            estimates[e].stdError = g.valid ? 0.0 : nan;
+            estimates[e].samples = 0;
+        }
+    });
+
+    if (options.method == PC_METHOD_MONTE_CARLO) {
+        vector<McRun> runs;
+        for (size_t e = 0; e < count; ++e) {
+            if (geometry[e].valid && estimates[e].pc >= options.mcSkipBelow) {
+                McRun run;
+                run.encounter = e;
+                runs.push_back(run);
+            }
+        }
+        run_monte_carlo(geometry, encounters, runs, options, threads);
+        for (const McRun& run : runs) {
+            const double n = static_cast<double>(run.samples);
+            const double p = run.hits / n;
+            estimates[run.encounter].pc = p;
+            estimates[run.encounter].stdError = sqrt(p * (1.0 - p) / n);
+            estimates[run.encounter].samples = run.samples;
+        }
+    }
+
+    for (size_t e = 0; e < count; ++e) encounters[e].pc = estimates[e].pc;
+    if (details) details->swap(estimates);
+    return PC_SUCCESS;
+}
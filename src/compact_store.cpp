@@ -0,0 +1,90 @@
+#include "compact_store.h"
+#include "parallel.h"
+#include "instrumentation.h"
+
+namespace {
+
+// Objects propagated per pass of a worker, through one buffer of double states
+const size_t OBJECT_BLOCK = 16;
+
+} // namespace
+
+int compact_store_propagate(const PipelineCatalog& catalog, double startEpochMs,
+                            double stepSeconds, double durationHours, CompactStore& out,
+                            unsigned threads) {
+    const size_t n = catalog.elements.size();
+    if (!(stepSeconds > 0.0) || !(durationHours >= 0.0) || catalog.ids.size() != n ||
+        catalog.isDebris.size() != n || n > UINT32_MAX) {
+        return COMPACT_STORE_ERROR_INVALID_INPUT;
+    }
+    NOVA_SCOPE("compact_store_propagate");
+
+    // Same grid and per-object arithmetic as propagate_catalog
+    const size_t steps = window_steps(stepSeconds, durationHours);
+    if (!steps) return COMPACT_STORE_ERROR_INVALID_INPUT;
+    out.count = n;
+    out.steps = steps;
+    out.times.resize(steps);
+    out.timesJd.resize(steps);
+    for (size_t k = 0; k < steps; ++k) {
+        out.times[k] = startEpochMs + k * stepSeconds * 1000.0;
+        out.timesJd[k] = unix_ms_to_jd(out.times[k]);
+    }
+    out.ids = catalog.ids;
+    out.isDebris = catalog.isDebris;
+    out.elements = catalog.elements;
+    out.data.assign(static_cast<size_t>(STORE_COMPONENTS) * n * steps, 0.0f);
+
+    vector<double> extent(n, 0.0); // largest |coordinate| (km)
+    parallel_for_chunks(n, OBJECT_BLOCK, threads, [&](unsigned, size_t begin, size_t end) {
+        vector<StateVectorECI> states;
+        for (size_t b = begin; b < end; b += OBJECT_BLOCK) {
+            const size_t m = min(end, b + OBJECT_BLOCK) - b;
+            states.resize(m * steps);
+            propagate_grid(out.elements.data() + b, m, out.timesJd.data(), steps, states.data());
+            for (size_t k = 0; k < steps; ++k) {
+                for (int d = 0; d < 3; ++d) {
+                    float* r = out.row(STORE_X + d, k) + b;
+                    float* v = out.row(STORE_VX + d, k) + b;
+                    for (size_t o = 0; o < m; ++o) {
+                        const StateVectorECI& s = states[o * steps + k];
+                        r[o] = static_cast<float>(s.r[d]);
+                        v[o] = static_cast<float>(s.v[d]);
+                        if (std::isfinite(s.r[d])) extent[b + o] = max(extent[b + o], fabs(s.r[d]));
+                    }
+                }
+            }
+        }
+    });
+
+    // Rounding to float moves each coordinate by at most half an ulp
+    // (|x| * 2^-24); the distance moves by at most the length of the sum of
+    // both objects' error vectors. Padded for the double arithmetic.
+    double maxExtent = 0.0;
+    for (double e : extent) maxExtent = max(maxExtent, e);
+    out.error_m = 2.0 * sqrt(3.0) * maxExtent * ldexp(1.0, -24) * 1000.0 * 1.01 + 1e-6;
+    return COMPACT_STORE_SUCCESS;
+}
+
+void compact_fill_store(const CompactStore& compact, const uint32_t* objects, size_t m,
+                        TrajectoryStore& out, size_t firstStep, size_t endStep) {
+    endStep = min(endStep, compact.steps);
+    firstStep = min(firstStep, endStep);
+    const size_t steps = endStep - firstStep;
+    store_resize(out, m, steps);
+    copy(compact.times.begin() + firstStep, compact.times.begin() + endStep, out.times.begin());
+
+    vector<StateVectorECI> states(steps);
+    for (size_t o = 0; o < m; ++o) {
+        const size_t i = objects[o];
+        store_add_id(out, o, compact.ids[i], compact.isDebris[i]);
+        propagate_grid(&compact.elements[i], 1, compact.timesJd.data() + firstStep, steps,
+                       states.data());
+        for (size_t k = 0; k < steps; ++k) {
+            for (int d = 0; d < 3; ++d) {
+                out.row(STORE_X + d, k)[o] = states[k].r[d];
+                out.row(STORE_VX + d, k)[o] = states[k].v[d];
+            }
+        }
+    }
+}
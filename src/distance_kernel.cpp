@@ -0,0 +1,308 @@
+#include "distance_kernel.h"
+
+#if (defined(__GNUC__) || defined(__clang__)) && (defined(__x86_64__) || defined(__i386__))
+#define KERNEL_HAVE_X86 1
+#include <immintrin.h>
+#endif
+
+#if defined(__aarch64__) && defined(__ARM_NEON)
+#define KERNEL_HAVE_NEON 1
+#include <arm_neon.h>
+#endif
+
+namespace {
+
+typedef size_t (*KernelFn)(const double*, const double*, const double*, size_t,
+                           double, double, double, double, uint32_t*);
+typedef size_t (*KernelFloatFn)(const float*, const float*, const float*, size_t,
+                                float, float, float, float, uint32_t*);
+
+// Branch-free compaction; also handles the tail of the SIMD kernels
+size_t kernel_scalar_from(const double* xs, const double* ys, const double* zs,
+                          size_t begin, size_t n, double px, double py, double pz,
+                          double radius2, uint32_t* out) {
+    size_t found = 0;
+    for (size_t j = begin; j < n; ++j) {
+        const double dx = xs[j] - px;
+        const double dy = ys[j] - py;
+        const double dz = zs[j] - pz;
+        out[found] = static_cast<uint32_t>(j);
+        found += (dx*dx + dy*dy + dz*dz <= radius2) ? 1 : 0;
+    }
+    return found;
+}
+
+size_t kernel_scalar(const double* xs, const double* ys, const double* zs, size_t n,
+                     double px, double py, double pz, double radius2, uint32_t* out) {
+    return kernel_scalar_from(xs, ys, zs, 0, n, px, py, pz, radius2, out);
+}
+
+// Float versions: same compaction, twice the lanes per vector
+size_t kernel_scalar_float_from(const float* xs, const float* ys, const float* zs,
+                                size_t begin, size_t n, float px, float py, float pz,
+                                float radius2, uint32_t* out) {
+    size_t found = 0;
+    for (size_t j = begin; j < n; ++j) {
+        const float dx = xs[j] - px;
+        const float dy = ys[j] - py;
+        const float dz = zs[j] - pz;
+        out[found] = static_cast<uint32_t>(j);
+        found += (dx*dx + dy*dy + dz*dz <= radius2) ? 1 : 0;
+    }
+    return found;
+}
+
+size_t kernel_scalar_float(const float* xs, const float* ys, const float* zs, size_t n,
+                           float px, float py, float pz, float radius2, uint32_t* out) {
+    return kernel_scalar_float_from(xs, ys, zs, 0, n, px, py, pz, radius2, out);
+}
+
+#ifdef KERNEL_HAVE_X86
+__attribute__((target("avx2")))
+size_t kernel_avx2(const double* xs, const double* ys, const double* zs, size_t n,
+                   double px, double py, double pz, double radius2, uint32_t* out) {
+    const __m256d vx = _mm256_set1_pd(px);
+    const __m256d vy = _mm256_set1_pd(py);
+    const __m256d vz = _mm256_set1_pd(pz);
+    const __m256d vr = _mm256_set1_pd(radius2);
+    size_t found = 0;
+    size_t j = 0;
+    for (; j + 4 <= n; j += 4) {
+        const __m256d dx = _mm256_sub_pd(_mm256_loadu_pd(xs + j), vx);
+        const __m256d dy = _mm256_sub_pd(_mm256_loadu_pd(ys + j), vy);
+        const __m256d dz = _mm256_sub_pd(_mm256_loadu_pd(zs + j), vz);
+        const __m256d d2 = _mm256_add_pd(_mm256_add_pd(_mm256_mul_pd(dx, dx), _mm256_mul_pd(dy, dy)),
+                                         _mm256_mul_pd(dz, dz));
+        int mask = _mm256_movemask_pd(_mm256_cmp_pd(d2, vr, _CMP_LE_OQ));
+        while (mask) {
+            const int lane = __builtin_ctz(static_cast<unsigned>(mask));
+            out[found++] = static_cast<uint32_t>(j + lane);
+            mask &= mask - 1;
+        }
+    }
+    return found + kernel_scalar_from(xs, ys, zs, j, n, px, py, pz, radius2, out + found);
+}
+
+__attribute__((target("avx512f")))
+size_t kernel_avx512(const double* xs, const double* ys, const double* zs, size_t n,
+                     double px, double py, double pz, double radius2, uint32_t* out) {
+    const __m512d vx = _mm512_set1_pd(px);
+    const __m512d vy = _mm512_set1_pd(py);
+    const __m512d vz = _mm512_set1_pd(pz);
+    const __m512d vr = _mm512_set1_pd(radius2);
+    size_t found = 0;
+    size_t j = 0;
+    for (; j + 8 <= n; j += 8) {
+        const __m512d dx = _mm512_sub_pd(_mm512_loadu_pd(xs + j), vx);
+        const __m512d dy = _mm512_sub_pd(_mm512_loadu_pd(ys + j), vy);
+        const __m512d dz = _mm512_sub_pd(_mm512_loadu_pd(zs + j), vz);
+        const __m512d d2 = _mm512_add_pd(_mm512_add_pd(_mm512_mul_pd(dx, dx), _mm512_mul_pd(dy, dy)),
+                                         _mm512_mul_pd(dz, dz));
+        unsigned mask = _mm512_cmp_pd_mask(d2, vr, _CMP_LE_OQ);
+        while (mask) {
+            const int lane = __builtin_ctz(mask);
+            out[found++] = static_cast<uint32_t>(j + lane);
+            mask &= mask - 1;
+        }
+    }
+    return found + kernel_scalar_from(xs, ys, zs, j, n, px, py, pz, radius2, out + found);
+}
+
+__attribute__((target("avx2")))
+size_t kernel_avx2_float(const float* xs, const float* ys, const float* zs, size_t n,
+                         float px, float py, float pz, float radius2, uint32_t* out) {
+    const __m256 vx = _mm256_set1_ps(px);
+    const __m256 vy = _mm256_set1_ps(py);
+    const __m256 vz = _mm256_set1_ps(pz);
+    const __m256 vr = _mm256_set1_ps(radius2);
+    size_t found = 0;
+    size_t j = 0;
+    for (; j + 8 <= n; j += 8) {
+        const __m256 dx = _mm256_sub_ps(_mm256_loadu_ps(xs + j), vx);
+        const __m256 dy = _mm256_sub_ps(_mm256_loadu_ps(ys + j), vy);
+        const __m256 dz = _mm256_sub_ps(_mm256_loadu_ps(zs + j), vz);
+        const __m256 d2 = _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(dx, dx), _mm256_mul_ps(dy, dy)),
+                                        _mm256_mul_ps(dz, dz));
+        int mask = _mm256_movemask_ps(_mm256_cmp_ps(d2, vr, _CMP_LE_OQ));
+        while (mask) {
+            const int lane = __builtin_ctz(static_cast<unsigned>(mask));
+            out[found++] = static_cast<uint32_t>(j + lane);
+            mask &= mask - 1;
+        }
+    }
+    return found + kernel_scalar_float_from(xs, ys, zs, j, n, px, py, pz, radius2, out + found);
+}
+
+__attribute__((target("avx512f")))
+size_t kernel_avx512_float(const float* xs, const float* ys, const float* zs, size_t n,
+                           float px, float py, float pz, float radius2, uint32_t* out) {
+    const __m512 vx = _mm512_set1_ps(px);
+    const __m512 vy = _mm512_set1_ps(py);
+    const __m512 vz = _mm512_set1_ps(pz);
+    const __m512 vr = _mm512_set1_ps(radius2);
+    size_t found = 0;
+    size_t j = 0;
+    for (; j + 16 <= n; j += 16) {
+        const __m512 dx = _mm512_sub_ps(_mm512_loadu_ps(xs + j), vx);
+        const __m512 dy = _mm512_sub_ps(_mm512_loadu_ps(ys + j), vy);
+        const __m512 dz = _mm512_sub_ps(_mm512_loadu_ps(zs + j), vz);
+        const __m512 d2 = _mm512_add_ps(_mm512_add_ps(_mm512_mul_ps(dx, dx), _mm512_mul_ps(dy, dy)),
+                                        _mm512_mul_ps(dz, dz));
+        unsigned mask = _mm512_cmp_ps_mask(d2, vr, _CMP_LE_OQ);
+        while (mask) {
+            const int lane = __builtin_ctz(mask);
+            out[found++] = static_cast<uint32_t>(j + lane);
+            mask &= mask - 1;
+        }
+    }
+    return found + kernel_scalar_float_from(xs, ys, zs, j, n, px, py, pz, radius2, out + found);
+}
+#endif
+
+#ifdef KERNEL_HAVE_NEON
+size_t kernel_neon(const double* xs, const double* ys, const double* zs, size_t n,
+                   double px, double py, double pz, double radius2, uint32_t* out) {
+    const float64x2_t vx = vdupq_n_f64(px);
+    const float64x2_t vy = vdupq_n_f64(py);
+    const float64x2_t vz = vdupq_n_f64(pz);
+    const float64x2_t vr = vdupq_n_f64(radius2);
+    size_t found = 0;
+    size_t j = 0;
+    for (; j + 2 <= n; j += 2) {
+        const float64x2_t dx = vsubq_f64(vld1q_f64(xs + j), vx);
+        const float64x2_t dy = vsubq_f64(vld1q_f64(ys + j), vy);
+        const float64x2_t dz = vsubq_f64(vld1q_f64(zs + j), vz);
+        const float64x2_t d2 = vaddq_f64(vaddq_f64(vmulq_f64(dx, dx), vmulq_f64(dy, dy)),
+                                         vmulq_f64(dz, dz));
+        const uint64x2_t le = vcleq_f64(d2, vr);
+        if (vgetq_lane_u64(le, 0)) out[found++] = static_cast<uint32_t>(j);
+        if (vgetq_lane_u64(le, 1)) out[found++] = static_cast<uint32_t>(j + 1);
+    }
+    return found + kernel_scalar_from(xs, ys, zs, j, n, px, py, pz, radius2, out + found);
+}
+
+size_t kernel_neon_float(const float* xs, const float* ys, const float* zs, size_t n,
+                         float px, float py, float pz, float radius2, uint32_t* out) {
+    const float32x4_t vx = vdupq_n_f32(px);
+    const float32x4_t vy = vdupq_n_f32(py);
+    const float32x4_t vz = vdupq_n_f32(pz);
+    const float32x4_t vr = vdupq_n_f32(radius2);
+    size_t found = 0;
+    size_t j = 0;
+    for (; j + 4 <= n; j += 4) {
+        const float32x4_t dx = vsubq_f32(vld1q_f32(xs + j), vx);
+        const float32x4_t dy = vsubq_f32(vld1q_f32(ys + j), vy);
+        const float32x4_t dz = vsubq_f32(vld1q_f32(zs + j), vz);
+        const float32x4_t d2 = vaddq_f32(vaddq_f32(vmulq_f32(dx, dx), vmulq_f32(dy, dy)),
+                                         vmulq_f32(dz, dz));
+        const uint32x4_t le = vcleq_f32(d2, vr);
+        if (vgetq_lane_u32(le, 0)) out[found++] = static_cast<uint32_t>(j);
+        if (vgetq_lane_u32(le, 1)) out[found++] = static_cast<uint32_t>(j + 1);
+        if (vgetq_lane_u32(le, 2)) out[found++] = static_cast<uint32_t>(j + 2);
+        if (vgetq_lane_u32(le, 3)) out[found++] = static_cast<uint32_t>(j + 3);
+    }
+    return found + kernel_scalar_float_from(xs, ys, zs, j, n, px, py, pz, radius2, out + found);
+}
+#endif
+
+bool isa_supported(DistanceKernelIsa isa) {
+    switch (isa) {
+        case KERNEL_SCALAR:
+            return true;
+#ifdef KERNEL_HAVE_X86
+        case KERNEL_AVX2:
+            return __builtin_cpu_supports("avx2");
+        case KERNEL_AVX512:
+            return __builtin_cpu_supports("avx512f");
+#endif
+#ifdef KERNEL_HAVE_NEON
+        case KERNEL_NEON:
+            return true;
+#endif
+        default:
+            return false;
+    }
+}
+
+KernelFn kernel_for(DistanceKernelIsa isa) {
+    switch (isa) {
+#ifdef KERNEL_HAVE_X86
+        case KERNEL_AVX2: return kernel_avx2;
+        case KERNEL_AVX512: return kernel_avx512;
+#endif
+#ifdef KERNEL_HAVE_NEON
+        case KERNEL_NEON: return kernel_neon;
+#endif
+        default: return kernel_scalar;
+    }
+}
+
+KernelFloatFn float_kernel_for(DistanceKernelIsa isa) {
+    switch (isa) {
+#ifdef KERNEL_HAVE_X86
+        case KERNEL_AVX2: return kernel_avx2_float;
+        case KERNEL_AVX512: return kernel_avx512_float;
+#endif
+#ifdef KERNEL_HAVE_NEON
+        case KERNEL_NEON: return kernel_neon_float;
+#endif
+        default: return kernel_scalar_float;
+    }
+}
+
+DistanceKernelIsa best_isa() {
+    const DistanceKernelIsa order[] = {KERNEL_AVX512, KERNEL_AVX2, KERNEL_NEON};
+    for (DistanceKernelIsa isa : order) {
+        if (isa_supported(isa)) return isa;
+    }
+    return KERNEL_SCALAR;
+}
+
+// Chosen once; select_distance_kernel may override it before screening starts
+struct KernelChoice {
+    DistanceKernelIsa isa;
+    KernelFn fn;
+    KernelFloatFn floatFn;
+    KernelChoice() : isa(best_isa()), fn(kernel_for(isa)), floatFn(float_kernel_for(isa)) {}
+};
+
+KernelChoice& choice() {
+    static KernelChoice c;
+    return c;
+}
+
+} // namespace
+
+size_t within_radius(const double* xs, const double* ys, const double* zs, size_t n,
+                     double px, double py, double pz, double radius2, uint32_t* out) {
+    return choice().fn(xs, ys, zs, n, px, py, pz, radius2, out);
+}
+
+size_t within_radius(const float* xs, const float* ys, const float* zs, size_t n,
+                     float px, float py, float pz, float radius2, uint32_t* out) {
+    return choice().floatFn(xs, ys, zs, n, px, py, pz, radius2, out);
+}
+
+bool select_distance_kernel(DistanceKernelIsa isa) {
+    if (isa == KERNEL_AUTO) isa = best_isa();
+    if (!isa_supported(isa)) return false;
+    choice().isa = isa;
+    choice().fn = kernel_for(isa);
+    choice().floatFn = float_kernel_for(isa);
+    return true;
+}
+
+DistanceKernelIsa active_distance_kernel() {
+    return choice().isa;
+}
+
+string distance_kernel_name(DistanceKernelIsa isa) {
+    switch (isa) {
+        case KERNEL_AUTO: return "auto";
+        case KERNEL_SCALAR: return "scalar";
+        case KERNEL_AVX2: return "avx2";
+        case KERNEL_AVX512: return "avx512";
+        case KERNEL_NEON: return "neon";
+        default: return "unknown";
+    }
+}
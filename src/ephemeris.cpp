@@ -0,0 +1,210 @@
+#include "ephemeris.h"
+#include "mapped_file.h"
+#include "instrumentation.h"
+#include <cstring>
+
+namespace {
+
+const char EPHEMERIS_MAGIC[8] = {'O', 'G', 'E', 'P', 'H', 'E', 'M', '\0'};
+
+// Bumped whenever propagation output changes for the same inputs
+const uint64_t PROPAGATOR_REVISION = 1;
+
+// Quantization units and the NaN sentinel
+const double QUANT_POS_PER_KM = 1000.0;   // metres
+const double QUANT_VEL_PER_KMS = 1000000.0; // mm/s
+const int32_t QUANT_NAN = numeric_limits<int32_t>::min();
+
+struct Fnv1a {
+    uint64_t h = 1469598103934665603ull;
+    void add(const void* p, size_t n) {
+        const unsigned char* b = static_cast<const unsigned char*>(p);
+        for (size_t i = 0; i < n; ++i) {
+            h ^= b[i];
+            h *= 1099511628211ull;
+        }
+    }
+    template <typename T> void add_value(const T& v) { add(&v, sizeof(v)); }
+};
+
+size_t align64(size_t n) {
+    return (n + 63) & ~static_cast<size_t>(63);
+}
+
+int32_t quantize(double v, double scale) {
+    if (!std::isfinite(v)) return QUANT_NAN;
+    const double q = v * scale;
+    if (q >= 2147483647.0 || q <= -2147483647.0) return QUANT_NAN;
+    return static_cast<int32_t>(llround(q));
+}
+
+double dequantize(int32_t q, double scale) {
+    return q == QUANT_NAN ? numeric_limits<double>::quiet_NaN() : q / scale;
+}
+
+} // namespace
+
+uint64_t ephemeris_key(const vector<string>& tlePaths, double startEpochMs,
+                       double stepSeconds, double durationHours) {
+    Fnv1a hash;
+    hash.add_value(PROPAGATOR_REVISION);
+    for (const auto& path : tlePaths) {
+        MappedFile file;
+        hash.add(path.data(), path.size());
+        if (map_file(path, file) && file.size) {
+            hash.add(file.data, file.size);
+        }
+        hash.add_value(static_cast<uint64_t>(file.size));
+    }
+    hash.add_value(startEpochMs);
+    hash.add_value(stepSeconds);
+    hash.add_value(durationHours);
+    return hash.h == 0 ? 1 : hash.h; // 0 means "any key" to read_ephemeris
+}
+
+int write_ephemeris(const string& path, const TrajectoryStore& store, uint64_t key,
+                    EphemerisEncoding encoding) {
+    NOVA_SCOPE("write_ephemeris");
+    if (!host_little_endian()) return EPHEMERIS_ERROR_FORMAT;
+
+    EphemerisHeader header;
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, EPHEMERIS_MAGIC, sizeof(header.magic));
+    header.version = EPHEMERIS_FORMAT_VERSION;
+    header.encoding = encoding;
+    header.key = key;
+    header.count = store.count;
+    header.steps = store.steps;
+    header.startMs = store.steps ? store.time(0) : 0.0;
+    header.stepMs = store.steps > 1 ? store.time(1) - store.time(0) : 0.0;
+
+    string ids;
+    for (size_t i = 0; i < store.count; ++i) {
+        const uint8_t debris = store.isDebris[i] ? 1 : 0;
+        const uint32_t len = static_cast<uint32_t>(store.ids[i].size());
+        ids.append(reinterpret_cast<const char*>(&debris), sizeof(debris));
+        ids.append(reinterpret_cast<const char*>(&len), sizeof(len));
+        ids.append(store.ids[i]);
+    }
+    header.idTableBytes = ids.size();
+    const size_t timesBytes = store.steps * sizeof(double);
+    header.dataOffset = align64(sizeof(header) + timesBytes + ids.size());
+
+    // Write to a temporary name and move it into place, so readers never see a partial file
+    const string tmp = temp_file_path(path);
+    {
+        ofstream out(tmp, ios::binary | ios::trunc);
+        if (!out.is_open()) return EPHEMERIS_ERROR_IO;
+        out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+        // Times (like the rows below) go out in step order, whatever the ring's head
+        out.write(reinterpret_cast<const char*>(store.times.data() + store.head),
+                  (store.steps - store.head) * sizeof(double));
+        out.write(reinterpret_cast<const char*>(store.times.data()), store.head * sizeof(double));
+        out.write(ids.data(), ids.size());
+        const size_t pad = header.dataOffset - (sizeof(header) + timesBytes + ids.size());
+        const char zeros[64] = {0};
+        out.write(zeros, pad);
+
+        if (encoding == EPHEMERIS_FLOAT64 && store.head == 0) {
+            out.write(reinterpret_cast<const char*>(store.data.data()),
+                      store.data.size() * sizeof(double));
+        } else if (encoding == EPHEMERIS_FLOAT64) {
+            // Rolling store: write the rows back in step order
+            for (int c = 0; c < STORE_COMPONENTS; ++c) {
+                for (size_t k = 0; k < store.steps; ++k) {
+                    out.write(reinterpret_cast<const char*>(store.row(c, k)), store.count * sizeof(double));
+                }
+            }
+        } else {
+            vector<int32_t> row(store.count);
+            for (int c = 0; c < STORE_COMPONENTS; ++c) {
+                const double scale = c < STORE_VX ? QUANT_POS_PER_KM : QUANT_VEL_PER_KMS;
+                for (size_t k = 0; k < store.steps; ++k) {
+                    const double* src = store.row(c, k);
+                    for (size_t i = 0; i < store.count; ++i) row[i] = quantize(src[i], scale);
+                    out.write(reinterpret_cast<const char*>(row.data()), row.size() * sizeof(int32_t));
+                }
+            }
+        }
+        if (!out.good()) return EPHEMERIS_ERROR_IO;
+        NOVA_COUNT(COUNTER_BYTES_WRITTEN, out.tellp());
+    }
+    if (!commit_file(tmp, path)) return EPHEMERIS_ERROR_IO;
+    return EPHEMERIS_SUCCESS;
+}
+
+int read_ephemeris(const string& path, TrajectoryStore& store, uint64_t expectedKey) {
+    NOVA_SCOPE("read_ephemeris");
+    MappedFile file;
+    if (!map_file(path, file)) return EPHEMERIS_ERROR_IO;
+    if (!host_little_endian() || file.size < sizeof(EphemerisHeader)) return EPHEMERIS_ERROR_FORMAT;
+
+    EphemerisHeader header;
+    memcpy(&header, file.data, sizeof(header));
+    if (memcmp(header.magic, EPHEMERIS_MAGIC, sizeof(header.magic)) != 0 ||
+        header.version != EPHEMERIS_FORMAT_VERSION ||
+        (header.encoding != EPHEMERIS_FLOAT64 && header.encoding != EPHEMERIS_QUANTIZED)) {
+        return EPHEMERIS_ERROR_FORMAT;
+    }
+    if (expectedKey != 0 && header.key != expectedKey) return EPHEMERIS_ERROR_KEY_MISMATCH;
+
+    // Every size is bounded by the file before it is multiplied, so a corrupt
+    // header cannot wrap a product past the checks below
+    const uint64_t fileBytes = file.size;
+    const uint64_t valueBytes = header.encoding == EPHEMERIS_FLOAT64 ? sizeof(double) : sizeof(int32_t);
+    if (header.dataOffset > fileBytes || header.idTableBytes > fileBytes ||
+        header.steps > (fileBytes - sizeof(header)) / sizeof(double) ||
+        header.count > header.idTableBytes / (sizeof(uint8_t) + sizeof(uint32_t))) {
+        return EPHEMERIS_ERROR_FORMAT;
+    }
+    const uint64_t timesBytes = header.steps * sizeof(double);
+    if (header.dataOffset < sizeof(header) + timesBytes + header.idTableBytes) return EPHEMERIS_ERROR_FORMAT;
+    const uint64_t dataBytes = fileBytes - header.dataOffset;
+    const uint64_t objectBytes = header.steps * STORE_COMPONENTS * valueBytes;
+    if (objectBytes ? header.count > dataBytes / objectBytes || header.count * objectBytes != dataBytes
+                    : dataBytes != 0) {
+        return EPHEMERIS_ERROR_FORMAT;
+    }
+    const size_t count = static_cast<size_t>(header.count);
+    const size_t steps = static_cast<size_t>(header.steps);
+    const size_t planeBytes = static_cast<size_t>(dataBytes);
+
+    // Parse the id table before touching the caller's store
+    const char* p = file.data + sizeof(header) + timesBytes;
+    const char* idEnd = p + header.idTableBytes;
+    vector<string> ids(count);
+    vector<bool> debris(count);
+    for (size_t i = 0; i < count; ++i) {
+        uint8_t flag;
+        uint32_t len;
+        if (idEnd - p < static_cast<ptrdiff_t>(sizeof(flag) + sizeof(len))) return EPHEMERIS_ERROR_FORMAT;
+        memcpy(&flag, p, sizeof(flag));
+        memcpy(&len, p + sizeof(flag), sizeof(len));
+        p += sizeof(flag) + sizeof(len);
+        if (idEnd - p < static_cast<ptrdiff_t>(len)) return EPHEMERIS_ERROR_FORMAT;
+        ids[i].assign(p, len);
+        debris[i] = flag != 0;
+        p += len;
+    }
+
+    store_resize(store, count, steps);
+    memcpy(store.times.data(), file.data + sizeof(header), timesBytes);
+    for (size_t i = 0; i < count; ++i) {
+        store_add_id(store, i, ids[i], debris[i]);
+    }
+
+    const char* planes = file.data + header.dataOffset;
+    if (header.encoding == EPHEMERIS_FLOAT64) {
+        memcpy(store.data.data(), planes, planeBytes);
+    } else {
+        const int32_t* q = reinterpret_cast<const int32_t*>(planes);
+        for (int c = 0; c < STORE_COMPONENTS; ++c) {
+            const double scale = c < STORE_VX ? QUANT_POS_PER_KM : QUANT_VEL_PER_KMS;
+            for (size_t k = 0; k < steps; ++k) {
+                double* dst = store.row(c, k);
+                for (size_t i = 0; i < count; ++i) dst[i] = dequantize(*q++, scale);
+            }
+        }
+    }
+    return EPHEMERIS_SUCCESS;
+}
@@ -0,0 +1,276 @@
+#include "instrumentation.h"
+#include "json_writer.h"
+#include <chrono>
+#include <mutex>
+#include <cstring>
+
+namespace {
+
+const char* const COUNTER_NAMES[COUNTER_COUNT] = {
+    "tle_records",
+    "states_propagated",
+    "pairs_tested",
+    "pairs_in_threshold",
+    "bytes_written",
+};
+
+#ifdef NOVA_INSTRUMENTATION
+
+struct TraceEvent {
+    const char* name;
+    uint64_t begin_ns;
+    uint64_t dur_ns;
+};
+
+struct StageTotal {
+    const char* name;
+    uint64_t calls;
+    uint64_t total_ns;
+    uint64_t max_ns;
+};
+
+// One thread's events. Logs are never freed; a thread that exits hands its
+// log to the next new thread, so short-lived workers do not grow the registry.
+struct ThreadLog {
+    mutex lock; // uncontended except while a report is taken
+    uint32_t tid = 0;
+    bool inUse = false;
+    vector<TraceEvent> events;
+    vector<StageTotal> totals; // few distinct stages: linear search
+};
+
+uint64_t steady_ns() {
+    return static_cast<uint64_t>(chrono::duration_cast<chrono::nanoseconds>(
+        chrono::steady_clock::now().time_since_epoch()).count());
+}
+
+struct Registry {
+    mutex lock;
+    vector<unique_ptr<ThreadLog>> logs;
+    uint64_t origin_ns = steady_ns(); // trace time zero: first use, then each reset
+};
+
+Registry& registry() {
+    static Registry r;
+    return r;
+}
+
+ThreadLog* acquire_log() {
+    Registry& r = registry();
+    lock_guard<mutex> guard(r.lock);
+    for (auto& log : r.logs) {
+        if (!log->inUse) {
+            log->inUse = true;
+            return log.get();
+        }
+    }
+    r.logs.push_back(unique_ptr<ThreadLog>(new ThreadLog()));
+    ThreadLog* log = r.logs.back().get();
+    log->tid = static_cast<uint32_t>(r.logs.size());
+    log->inUse = true;
+    return log;
+}
+
+struct ThreadLogHandle {
+    ThreadLog* log = acquire_log();
+    ~ThreadLogHandle() {
+        lock_guard<mutex> guard(registry().lock);
+        log->inUse = false;
+    }
+};
+
+ThreadLog& thread_log() {
+    thread_local ThreadLogHandle handle;
+    return *handle.log;
+}
+
+// Nanoseconds as fractional milliseconds / microseconds
+double to_ms(uint64_t ns) { return static_cast<double>(ns) / 1.0e6; }
+double to_us(uint64_t ns) { return static_cast<double>(ns) / 1.0e3; }
+
+#endif // NOVA_INSTRUMENTATION
+
+} // namespace
+
+#ifdef NOVA_INSTRUMENTATION
+
+namespace instrument_detail {
+
+atomic<uint64_t> counters[COUNTER_COUNT];
+
+uint64_t now_ns() {
+    registry(); // fixes the trace origin before the first timestamp
+    return steady_ns();
+}
+
+void record(const char* name, uint64_t begin_ns, uint64_t end_ns) {
+    ThreadLog& log = thread_log();
+    const uint64_t dur = end_ns > begin_ns ? end_ns - begin_ns : 0;
+    lock_guard<mutex> guard(log.lock);
+    if (log.events.size() < INSTRUMENT_MAX_EVENTS) log.events.push_back({name, begin_ns, dur});
+    for (StageTotal& t : log.totals) {
+        if (t.name == name) {
+            ++t.calls;
+            t.total_ns += dur;
+            if (dur > t.max_ns) t.max_ns = dur;
+            return;
+        }
+    }
+    log.totals.push_back({name, 1, dur, dur});
+}
+
+} // namespace instrument_detail
+
+#endif // NOVA_INSTRUMENTATION
+
+const char* instrument_counter_name(InstrumentCounter counter) {
+    const int c = static_cast<int>(counter);
+    return c >= 0 && c < COUNTER_COUNT ? COUNTER_NAMES[c] : "unknown";
+}
+
+bool instrument_enabled() {
+#ifdef NOVA_INSTRUMENTATION
+    return true;
+#else
+    return false;
+#endif
+}
+
+void instrument_reset() {
+#ifdef NOVA_INSTRUMENTATION
+    Registry& r = registry();
+    lock_guard<mutex> guard(r.lock);
+    for (auto& log : r.logs) {
+        lock_guard<mutex> logGuard(log->lock);
+        log->events.clear();
+        log->totals.clear();
+    }
+    for (auto& c : instrument_detail::counters) c.store(0, memory_order_relaxed);
+    r.origin_ns = steady_ns();
+#endif
+}
+
+void instrument_report(InstrumentReport& out) {
+    out.enabled = instrument_enabled();
+    out.wall_ms = 0.0;
+    out.stages.clear();
+    for (int c = 0; c < COUNTER_COUNT; ++c) out.counters[c] = 0;
+#ifdef NOVA_INSTRUMENTATION
+    Registry& r = registry();
+    lock_guard<mutex> guard(r.lock);
+    out.wall_ms = to_ms(steady_ns() - r.origin_ns);
+
+    // Same stage from several threads (or several literals with equal text) merges by name
+    vector<StageTotal> merged;
+    for (auto& log : r.logs) {
+        lock_guard<mutex> logGuard(log->lock);
+        for (const StageTotal& t : log->totals) {
+            auto it = find_if(merged.begin(), merged.end(), [&](const StageTotal& m) {
+                return m.name == t.name || strcmp(m.name, t.name) == 0;
+            });
+            if (it == merged.end()) {
+                merged.push_back(t);
+                continue;
+            }
+            it->calls += t.calls;
+            it->total_ns += t.total_ns;
+            it->max_ns = max(it->max_ns, t.max_ns);
+        }
+    }
+    sort(merged.begin(), merged.end(), [](const StageTotal& a, const StageTotal& b) {
+        return a.total_ns > b.total_ns || (a.total_ns == b.total_ns && strcmp(a.name, b.name) < 0);
+    });
+    out.stages.reserve(merged.size());
+    for (const StageTotal& t : merged) {
+        out.stages.push_back({t.name, t.calls, to_ms(t.total_ns), to_ms(t.max_ns)});
+    }
+    for (int c = 0; c < COUNTER_COUNT; ++c) {
+        out.counters[c] = instrument_detail::counters[c].load(memory_order_relaxed);
+    }
+#endif
+}
+
+int instrument_write_summary(const string& path) {
+    InstrumentReport report;
+    instrument_report(report);
+
+    JsonWriter jw;
+    if (!json_open(jw, path)) return INSTRUMENT_ERROR_FILE;
+    json_write(jw, "{\n  \"enabled\": ");
+    json_write(jw, report.enabled ? "true" : "false");
+    json_write(jw, ",\n  \"wall_ms\": ");
+    json_write_fixed(jw, report.wall_ms, 3);
+    json_write(jw, ",\n  \"stages\": [");
+    for (size_t s = 0; s < report.stages.size(); ++s) {
+        const InstrumentStage& stage = report.stages[s];
+        json_write(jw, s ? ",\n    {\"name\": " : "\n    {\"name\": ");
+        json_write_string(jw, stage.name);
+        json_write(jw, ", \"calls\": ");
+        json_write(jw, to_string(stage.calls).c_str());
+        json_write(jw, ", \"total_ms\": ");
+        json_write_fixed(jw, stage.total_ms, 3);
+        json_write(jw, ", \"mean_ms\": ");
+        json_write_fixed(jw, stage.calls ? stage.total_ms / stage.calls : 0.0, 3);
+        json_write(jw, ", \"max_ms\": ");
+        json_write_fixed(jw, stage.max_ms, 3);
+        json_write(jw, "}");
+    }
+    json_write(jw, report.stages.empty() ? "],\n  \"counters\": {" : "\n  ],\n  \"counters\": {");
+    for (int c = 0; c < COUNTER_COUNT; ++c) {
+        json_write(jw, c ? ",\n    \"" : "\n    \"");
+        json_write(jw, COUNTER_NAMES[c]);
+        json_write(jw, "\": ");
+        json_write(jw, to_string(report.counters[c]).c_str());
+    }
+    json_write(jw, "\n  }\n}\n");
+    return json_close(jw) ? INSTRUMENT_SUCCESS : INSTRUMENT_ERROR_FILE;
+}
+
+int instrument_write_trace(const string& path) {
+    JsonWriter jw;
+    if (!json_open(jw, path)) return INSTRUMENT_ERROR_FILE;
+    json_write(jw, "{\"displayTimeUnit\": \"ms\", \"traceEvents\": [");
+    bool first = true;
+#ifdef NOVA_INSTRUMENTATION
+    Registry& r = registry();
+    {
+        lock_guard<mutex> guard(r.lock);
+        uint64_t last_ns = r.origin_ns;
+        for (auto& log : r.logs) {
+            lock_guard<mutex> logGuard(log->lock);
+            const string tid = to_string(log->tid);
+            for (const TraceEvent& e : log->events) {
+                // Events from before the last reset's origin are clamped to it
+                const uint64_t ts = e.begin_ns > r.origin_ns ? e.begin_ns - r.origin_ns : 0;
+                json_write(jw, first ? "\n{\"name\": " : ",\n{\"name\": ");
+                first = false;
+                json_write_string(jw, e.name);
+                json_write(jw, ", \"cat\": \"nova\", \"ph\": \"X\", \"ts\": ");
+                json_write_fixed(jw, to_us(ts), 3);
+                json_write(jw, ", \"dur\": ");
+                json_write_fixed(jw, to_us(e.dur_ns), 3);
+                json_write(jw, ", \"pid\": 1, \"tid\": ");
+                json_write(jw, tid.c_str());
+                json_write(jw, "}");
+                last_ns = max(last_ns, e.begin_ns + e.dur_ns);
+            }
+        }
+
+        // Counter totals at the end of the trace
+        json_write(jw, first ? "\n{\"name\": \"counters\", \"ph\": \"C\", \"ts\": "
+                             : ",\n{\"name\": \"counters\", \"ph\": \"C\", \"ts\": ");
+        first = false;
+        json_write_fixed(jw, to_us(last_ns - r.origin_ns), 3);
+        json_write(jw, ", \"pid\": 1, \"tid\": 1, \"args\": {");
+        for (int c = 0; c < COUNTER_COUNT; ++c) {
+            json_write(jw, c ? ", \"" : "\"");
+            json_write(jw, COUNTER_NAMES[c]);
+            json_write(jw, "\": ");
+            json_write(jw, to_string(instrument_detail::counters[c].load(memory_order_relaxed)).c_str());
+        }
+        json_write(jw, "}}");
+    }
+#endif
+    json_write(jw, first ? "]}\n" : "\n]}\n");
+    return json_close(jw) ? INSTRUMENT_SUCCESS : INSTRUMENT_ERROR_FILE;
+}
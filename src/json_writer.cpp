@@ -0,0 +1,208 @@
+#include "json_writer.h"
+#include "instrumentation.h"
+#include <cstring>
+
+namespace {
+
+const uint32_t POW10[10] = {
+    1u, 10u, 100u, 1000u, 10000u, 100000u, 1000000u, 10000000u, 100000000u, 1000000000u
+};
+
+// 128-bit product of a 64-bit and a 32-bit value
+struct Wide {
+    uint64_t hi, lo;
+};
+
+Wide multiply(uint64_t a, uint32_t b) {
+    const uint64_t lo = (a & 0xffffffffull) * b;
+    const uint64_t hi = (a >> 32) * b + (lo >> 32);
+    return {hi >> 32, (hi << 32) | (lo & 0xffffffffull)};
+}
+
+bool bit_set(const Wide& v, int b) {
+    return b >= 64 ? ((v.hi >> (b - 64)) & 1) != 0 : ((v.lo >> b) & 1) != 0;
+}
+
+// Any of bits [0, b) set
+bool low_bits_set(const Wide& v, int b) {
+    if (b >= 64) {
+        const uint64_t mask = b == 64 ? 0 : (1ull << (b - 64)) - 1;
+        return v.lo != 0 || (v.hi & mask) != 0;
+    }
+    return (v.lo & ((1ull << b) - 1)) != 0;
+}
+
+uint64_t shift_right(const Wide& v, int s) {
+    if (s >= 64) return v.hi >> (s - 64);
+    return (v.lo >> s) | (v.hi << (64 - s));
+}
+
+// Round frac * 10^digits to an integer, half to even, for 0 <= frac < 1.
+// wholeOdd is the parity of the integer part, which breaks ties when digits is 0.
+uint64_t round_fraction(double frac, int digits, bool wholeOdd) {
+    if (frac == 0.0) return 0;
+    int exponent;
+    const double mantissa = frexp(frac, &exponent); // frac = mantissa * 2^exponent
+    const uint64_t m = static_cast<uint64_t>(ldexp(mantissa, 53));
+    const int s = 53 - exponent;                    // frac = m / 2^s, s >= 53
+
+    // m * 10^digits < 2^83, so for s > 83 the value is below one half
+    if (s > 83) return 0;
+
+    const Wide product = multiply(m, POW10[digits]);
+    uint64_t q = shift_right(product, s);
+    const bool odd = digits == 0 ? wholeOdd : (q & 1) != 0;
+    if (bit_set(product, s - 1) && (low_bits_set(product, s - 1) || odd)) {
+        ++q;
+    }
+    return q;
+}
+
+// Unsigned integer as decimal text; returns chars written
+size_t write_uint(uint64_t v, char* out) {
+    char digits[20];
+    size_t n = 0;
+    do {
+        digits[n++] = static_cast<char>('0' + v % 10);
+        v /= 10;
+    } while (v);
+    for (size_t i = 0; i < n; ++i) out[i] = digits[n - 1 - i];
+    return n;
+}
+
+} // namespace
+
+size_t format_fixed(double value, int digits, char* out) {
+    if (!std::isfinite(value)) {
+        memcpy(out, "null", 4);
+        return 4;
+    }
+    if (digits < 0) digits = 0;
+    if (digits > 9) digits = 9;
+
+    const double a = fabs(value);
+    if (a >= 9007199254740992.0) { // 2^53: no fraction left, rarely worth a fast path
+        const int n = snprintf(out, FIXED_TEXT_MAX, a < 1e20 ? "%.*f" : "%.*e", digits, value);
+        return n > 0 ? static_cast<size_t>(n) : 0;
+    }
+
+    // Both parts are exact: a < 2^53, so floor and the subtraction do not round
+    uint64_t whole = static_cast<uint64_t>(floor(a));
+    uint64_t fraction = round_fraction(a - floor(a), digits, (whole & 1) != 0);
+    if (fraction >= POW10[digits]) {
+        fraction -= POW10[digits];
+        ++whole;
+    }
+
+    size_t n = 0;
+    if (std::signbit(value)) out[n++] = '-';
+    n += write_uint(whole, out + n);
+    if (digits > 0) {
+        out[n++] = '.';
+        for (int d = digits - 1; d >= 0; --d) {
+            out[n + d] = static_cast<char>('0' + fraction % 10);
+            fraction /= 10;
+        }
+        n += digits;
+    }
+    return n;
+}
+
+JsonWriter::~JsonWriter() {
+    json_close(*this);
+}
+
+bool json_open(JsonWriter& w, const string& path, size_t bufferBytes) {
+    json_close(w);
+    w.file = fopen(path.c_str(), "wb");
+    if (!w.file) return false;
+    w.buffer.resize(bufferBytes < 256 ? 256 : bufferBytes);
+    w.used = 0;
+    w.failed = false;
+    return true;
+}
+
+void json_flush(JsonWriter& w) {
+    if (!w.file) return;
+    if (w.used && fwrite(w.buffer.data(), 1, w.used, w.file) != w.used) {
+        w.failed = true;
+    }
+    NOVA_COUNT(COUNTER_BYTES_WRITTEN, w.used);
+    w.used = 0;
+    if (fflush(w.file) != 0) w.failed = true;
+}
+
+bool json_close(JsonWriter& w) {
+    if (!w.file) return !w.failed;
+    json_flush(w);
+    if (fclose(w.file) != 0) w.failed = true;
+    w.file = nullptr;
+    return !w.failed;
+}
+
+void json_write(JsonWriter& w, const char* text, size_t length) {
+    if (!w.file) return;
+    while (length) {
+        if (w.used == w.buffer.size()) {
+            if (fwrite(w.buffer.data(), 1, w.used, w.file) != w.used) w.failed = true;
+            NOVA_COUNT(COUNTER_BYTES_WRITTEN, w.used);
+            w.used = 0;
+        }
+        const size_t room = w.buffer.size() - w.used;
+        const size_t n = length < room ? length : room;
+        memcpy(w.buffer.data() + w.used, text, n);
+        w.used += n;
+        text += n;
+        length -= n;
+    }
+}
+
+void json_write(JsonWriter& w, const char* text) {
+    json_write(w, text, strlen(text));
+}
+
+void json_write_fixed(JsonWriter& w, double value, int digits) {
+    char text[FIXED_TEXT_MAX];
+    json_write(w, text, format_fixed(value, digits, text));
+}
+
+void json_write_fixed_list(JsonWriter& w, const double* values, size_t count, int digits) {
+    if (!w.file) return;
+    const size_t worst = FIXED_TEXT_MAX + 2; // value plus ", "
+    for (size_t v = 0; v < count; ++v) {
+        if (w.buffer.size() - w.used < worst) {
+            if (fwrite(w.buffer.data(), 1, w.used, w.file) != w.used) w.failed = true;
+            NOVA_COUNT(COUNTER_BYTES_WRITTEN, w.used);
+            w.used = 0;
+        }
+        char* out = w.buffer.data() + w.used;
+        size_t n = 0;
+        if (v) {
+            out[n++] = ',';
+            out[n++] = ' ';
+        }
+        n += format_fixed(values[v], digits, out + n);
+        w.used += n;
+    }
+}
+
+void json_write_string(JsonWriter& w, const string& text) {
+    static const char HEX[] = "0123456789abcdef";
+    json_write(w, "\"", 1);
+    size_t run = 0; // start of the pending span that needs no escaping
+    for (size_t i = 0; i < text.size(); ++i) {
+        const unsigned char c = static_cast<unsigned char>(text[i]);
+        if (c >= 0x20 && c != '"' && c != '\\') continue;
+        json_write(w, text.data() + run, i - run);
+        char escape[6] = {'\\', 'u', '0', '0', HEX[c >> 4], HEX[c & 15]};
+        if (c == '"' || c == '\\') {
+            escape[1] = static_cast<char>(c);
+            json_write(w, escape, 2);
+        } else {
+            json_write(w, escape, 6);
+        }
+        run = i + 1;
+    }
+    json_write(w, text.data() + run, text.size() - run);
+    json_write(w, "\"", 1);
+}
@@ -0,0 +1,113 @@
+#include "lazy_ephemeris.h"
+#include "types.h"
+
+namespace {
+
+uint64_t chunk_key(size_t i, size_t c) {
+    return (static_cast<uint64_t>(i) << 32) | static_cast<uint64_t>(c);
+}
+
+// Propagate object i over one chunk; same arithmetic as propagate_batch
+shared_ptr<const EphemerisChunk> propagate_chunk(const LazyEphemeris& eph, size_t i, size_t c) {
+    auto chunk = make_shared<EphemerisChunk>();
+    chunk->firstStep = c * eph.chunkSteps;
+    chunk->steps = min(eph.chunkSteps, eph.steps - chunk->firstStep);
+    vector<StateVectorECI> states(chunk->steps);
+    propagate_grid(&eph.elements[i], 1, eph.timesJd.data() + chunk->firstStep, chunk->steps,
+                   states.data());
+    chunk->states.resize(chunk->steps * STORE_COMPONENTS);
+    for (size_t s = 0; s < chunk->steps; ++s) {
+        double* out = chunk->states.data() + s * STORE_COMPONENTS;
+        for (int d = 0; d < 3; ++d) {
+            out[STORE_X + d] = states[s].r[d];
+            out[STORE_VX + d] = states[s].v[d];
+        }
+    }
+    return chunk;
+}
+
+} // namespace
+
+int lazy_ephemeris_open(LazyEphemeris& eph, const PipelineCatalog& catalog,
+                        double startEpochMs, double stepSeconds, double durationHours,
+                        size_t cacheBytes, size_t chunkSteps) {
+    const size_t n = catalog.elements.size();
+    if (chunkSteps == 0 || !(durationHours > 0.0) || !window_steps(stepSeconds, durationHours) ||
+        catalog.ids.size() != n || catalog.isDebris.size() != n || n > UINT32_MAX) {
+        return LAZY_EPHEMERIS_ERROR_INVALID_INPUT;
+    }
+
+    lock_guard<mutex> guard(eph.lock);
+    eph.count = n;
+    eph.steps = window_steps(stepSeconds, durationHours);
+    eph.chunkSteps = chunkSteps;
+    eph.maxChunks = max<size_t>(1, cacheBytes / (chunkSteps * STORE_COMPONENTS * sizeof(double)));
+    eph.times.resize(eph.steps);
+    eph.timesJd.resize(eph.steps);
+    for (size_t k = 0; k < eph.steps; ++k) {
+        eph.times[k] = startEpochMs + k * stepSeconds * 1000.0;
+        eph.timesJd[k] = unix_ms_to_jd(eph.times[k]);
+    }
+    eph.ids = catalog.ids;
+    eph.isDebris = catalog.isDebris;
+    eph.elements = catalog.elements;
+    eph.stepBound_m.resize(n);
+    for (size_t i = 0; i < n; ++i) {
+        eph.stepBound_m[i] = propagation_step_bound_m(&eph.elements[i], eph.timesJd.front(),
+                                                      eph.timesJd.back(), stepSeconds);
+    }
+    eph.lru.clear();
+    eph.cached.clear();
+    eph.stats = LazyEphemerisStats();
+    return LAZY_EPHEMERIS_SUCCESS;
+}
+
+shared_ptr<const EphemerisChunk> lazy_chunk(LazyEphemeris& eph, size_t i, size_t c) {
+    if (i >= eph.count || c * eph.chunkSteps >= eph.steps) return nullptr;
+    const uint64_t key = chunk_key(i, c);
+    {
+        lock_guard<mutex> guard(eph.lock);
+        auto it = eph.cached.find(key);
+        if (it != eph.cached.end()) {
+            eph.lru.splice(eph.lru.begin(), eph.lru, it->second);
+            ++eph.stats.hits;
+            return it->second->second;
+        }
+    }
+
+    // Propagated outside the lock; if another thread got there first its copy is kept
+    shared_ptr<const EphemerisChunk> chunk = propagate_chunk(eph, i, c);
+    lock_guard<mutex> guard(eph.lock);
+    ++eph.stats.misses;
+    auto it = eph.cached.find(key);
+    if (it != eph.cached.end()) return it->second->second;
+    eph.lru.emplace_front(key, chunk);
+    eph.cached.emplace(key, eph.lru.begin());
+    while (eph.lru.size() > eph.maxChunks) {
+        eph.cached.erase(eph.lru.back().first);
+        eph.lru.pop_back();
+        ++eph.stats.evictions;
+    }
+    eph.stats.peakChunks = max(eph.stats.peakChunks, eph.lru.size());
+    return chunk;
+}
+
+void lazy_fill_store(LazyEphemeris& eph, const uint32_t* objects, size_t m, TrajectoryStore& out,
+                     size_t firstStep, size_t endStep) {
+    endStep = min(endStep, eph.steps);
+    firstStep = min(firstStep, endStep);
+    store_resize(out, m, endStep - firstStep);
+    copy(eph.times.begin() + firstStep, eph.times.begin() + endStep, out.times.begin());
+    for (size_t o = 0; o < m; ++o) {
+        const size_t i = objects[o];
+        store_add_id(out, o, eph.ids[i], eph.isDebris[i]);
+        for (size_t k = firstStep; k < endStep;) {
+            const shared_ptr<const EphemerisChunk> chunk = lazy_chunk(eph, i, k / eph.chunkSteps);
+            const size_t last = min(endStep, chunk->firstStep + chunk->steps);
+            for (; k < last; ++k) {
+                const double* state = chunk->states.data() + (k - chunk->firstStep) * STORE_COMPONENTS;
+                for (int c = 0; c < STORE_COMPONENTS; ++c) out.row(c, k - firstStep)[o] = state[c];
+            }
+        }
+    }
+}
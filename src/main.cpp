@@ -1,31 +1,141 @@
 #include "simplified_core.h"
 #include "types.h"
+#include "tca_refine.h"
+#include "propagation.h"
+#include "rolling_screen.h"
+#include "collision_probability.h"
+#include "instrumentation.h"
+#include "pipeline.h"
+#include "sharding.h"
+#include <chrono>
+#include <cstring>
+#include <filesystem>
 
-int main(int argc, char* argv[]) {
-    // Default parameters
-    double threshold_meters = 5000.0;
-    double step_seconds = 60.0;
-    double duration_hours = 24.0;
-    
-    // Use deterministic epoch time
-    double startEpochMs = 1734979200000.0; // Fixed epoch for deterministic results
-    
-    // Generate coordinates using simplified propagation
-    vector<string> ids; // Will be populated by propagate_coords_only
-    vector<bool> isDebrisFlags; // Will be populated by propagate_coords_only
-    
-    auto tracks = propagate_coords_only(ids, isDebrisFlags, startEpochMs, step_seconds, duration_hours);
-    
-    if (tracks.empty()) {
+namespace {
+
+double wall_clock_ms() {
+    return static_cast<double>(chrono::duration_cast<chrono::milliseconds>(
+        chrono::system_clock::now().time_since_epoch()).count());
+}
+
+void print_encounters(const TrajectoryStore& store, const vector<Encounter>& encounters) {
+    for (const Encounter& e : encounters) {
+        cout << fixed << setprecision(3)
+             << "Conjunction " << store.ids[e.aIndex] << " / " << store.ids[e.bIndex]
+             << " at " << static_cast<long long>(e.t) << " ms: "
+             << e.miss_m / 1000.0 << " km, " << e.rel_mps / 1000.0 << " km/s, "
+             << severity_to_string(e.severity)
+             << scientific << setprecision(3) << ", Pc " << e.pc << defaultfloat << endl;
+    }
+}
+
+// Service mode: keep screening a horizon that starts at the current step,
+// advancing it as wall time moves on
+int run_daemon(const PipelineConfig& config) {
+    PipelineCatalog catalog;
+    load_catalog_inputs(config.catalogs, catalog);
+    if (catalog.elements.empty()) {
         cout << "No satellite tracks generated." << endl;
         return 1;
     }
-    
-    
-    // Stream conjunctions JSON per timestep (no duplicate screening pass)
-    writeTracksJSON(tracks, startEpochMs, startEpochMs + duration_hours * 3600000.0, step_seconds);
-    streamConjunctionsJSON(tracks, threshold_meters);
-    
-    
+
+    const double threshold_m = config.jobs[0].threshold_m;
+    const double stepSeconds = config.stepSeconds;
+    const double horizonHours = config.horizonHours;
+    ScreeningOptions screening;
+    screening.threads = config.threads;
+    screening.refineTca = config.refineTca;
+    screening.refineMargin_m = config.refineTca ? refine_margin_for_step(stepSeconds) : 0.0;
+    PcOptions probability;
+    if (config.probability && config.refineTca) screening.probability = &probability;
+
+    const double stepMs = stepSeconds * 1000.0;
+    const double startMs = floor(wall_clock_ms() / stepMs) * stepMs;
+    RollingScreen window;
+    vector<Encounter> found;
+    try {
+        if (rolling_open(window, catalog, startMs, stepSeconds, horizonHours,
+                         threshold_m, screening, found) != ROLLING_SUCCESS) {
+            cout << "Invalid rolling window parameters." << endl;
+            return 1;
+        }
+    } catch (const bad_alloc&) {
+        cout << "Rolling window does not fit in memory." << endl;
+        return 1;
+    }
+    cout << "Screening " << window.store.count << " objects over a rolling "
+         << horizonHours << " h horizon" << endl;
+    print_encounters(window.store, found);
+
+    for (;;) {
+        const double nextMs = window.store.time(0) + stepMs;
+        const double waitMs = nextMs - wall_clock_ms();
+        if (waitMs > 0.0) this_thread::sleep_for(chrono::milliseconds(static_cast<long long>(ceil(waitMs))));
+        rolling_advance(window, wall_clock_ms(), found);
+        print_encounters(window.store, found);
+    }
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    for (int a = 1; a < argc; ++a) {
+        if (strcmp(argv[a], "--help") == 0 || strcmp(argv[a], "-h") == 0) {
+            cout << pipeline_usage(argv[0]);
+            return 0;
+        }
+    }
+
+    // Defaults reproduce the fixed pipeline: built-in catalogs, 24 h at 60 s, 5 km, tests/
+    PipelineConfig config;
+    string error;
+    if (parse_pipeline_args(argc - 1, argv + 1, config, error) != PIPELINE_SUCCESS) {
+        cout << error << "\n\n" << pipeline_usage(argv[0]);
+        return 1;
+    }
+
+    // --daemon [horizon hours]: continuous screening instead of the one-shot batch
+    if (config.daemon) {
+        return run_daemon(config);
+    }
+
+    // --shards N: this process coordinates; workers run one --shard-task each
+    if (!config.shardTask.empty()) {
+        return run_shard_task(config) == SHARD_SUCCESS ? 0 : 1;
+    }
+
+    // --profile <prefix>: per-stage summary and Chrome trace of the batch run
+    // in <prefix>_summary.json and <prefix>_trace.json
+    const string& profilePrefix = config.profilePrefix;
+    if (!profilePrefix.empty() && !instrument_enabled()) {
+        cout << "Built without instrumentation (NOVA_ENABLE_INSTRUMENTATION); profile will be empty" << endl;
+    }
+    instrument_reset();
+
+    // Propagate once (or reload the cached ephemeris), then write the tracks
+    // and stream every threshold's conjunctions from the same store. Sharded
+    // workers re-run this executable, by absolute path so launchers find it.
+    if (config.shardBlocks > 1) {
+        error_code ec;
+        filesystem::path program = filesystem::read_symlink("/proc/self/exe", ec);
+        if (ec) program = filesystem::absolute(argv[0], ec);
+        if (run_sharded(config, program.string()) != SHARD_SUCCESS) {
+            return 1;
+        }
+    } else if (run_pipeline(config) != PIPELINE_SUCCESS) {
+        return 1;
+    }
+
+    if (!profilePrefix.empty()) {
+        const string summary = profilePrefix + "_summary.json";
+        const string trace = profilePrefix + "_trace.json";
+        if (instrument_write_summary(summary) != INSTRUMENT_SUCCESS ||
+            instrument_write_trace(trace) != INSTRUMENT_SUCCESS) {
+            cout << "Could not write profile " << summary << " / " << trace << endl;
+            return 1;
+        }
+        cout << "Profile written to " << summary << " and " << trace << endl;
+    }
+
     return 0;
 }
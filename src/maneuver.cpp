@@ -1,5 +1,6 @@
 #include "maneuver.h"
 #include "propagation.h"
+#include "maneuver_search.h"
 #include <cstring>
 #include <cstdio>
 #include <cmath>
@@ -34,22 +35,50 @@ double fuel_required_simple(double delta_v_mps, double specific_impulse_s, doubl
 int plan_avoidance(const OrbitalElements* primary, const OrbitalElements* secondary,
                   double encounter_time, double target_distance_km, 
                   double max_delta_v_mps, Maneuver* out_maneuver) {
-    if (!primary || !out_maneuver) return -1;
-    (void)secondary; // unused
+    if (!primary || !secondary || !out_maneuver) return -1;
     memset(out_maneuver, 0, sizeof(Maneuver));
-    double dt_sec = (encounter_time - primary->epoch) * SECONDS_PER_DAY;
-    if (dt_sec <= 0.0) return -1;
-    double dv_ms = (target_distance_km * 1000.0) / dt_sec;
-    if (dv_ms < 0.0) dv_ms = 0.0;
-    if (dv_ms > max_delta_v_mps) return -1;
-    out_maneuver->delta_v[0] = dv_ms; // fixed +X direction
-    out_maneuver->delta_v[1] = 0.0;
-    out_maneuver->delta_v[2] = 0.0;
-    out_maneuver->epoch = encounter_time;
-    long long epoch_int = (long long)(encounter_time * 1000000);
-    snprintf(out_maneuver->id, sizeof(out_maneuver->id), "AVOID_%lld", epoch_int);
-    out_maneuver->fuel_cost = -1.0; // unknown; keep basic
-    return 0;
+
+    // Search the default grid over a two-object window ending shortly after
+    // the encounter: its magnitudes within the delta-v limit, plus the same
+    // steps scaled so the largest burn is the limit
+    if (!(max_delta_v_mps > 0.0) || !std::isfinite(max_delta_v_mps)) return -1;
+    ManeuverSearchOptions options;
+    const vector<double> grid = options.magnitudes_mps;
+    const double largest = *max_element(grid.begin(), grid.end());
+    options.magnitudes_mps.erase(remove_if(options.magnitudes_mps.begin(), options.magnitudes_mps.end(),
+        [&](double mag) { return !(mag <= max_delta_v_mps); }), options.magnitudes_mps.end());
+    for (double mag : grid) options.magnitudes_mps.push_back(mag * max_delta_v_mps / largest);
+    sort(options.magnitudes_mps.begin(), options.magnitudes_mps.end());
+    options.magnitudes_mps.erase(unique(options.magnitudes_mps.begin(), options.magnitudes_mps.end()),
+                                 options.magnitudes_mps.end());
+
+    const double stepSeconds = 10.0;
+    double maxLead = 0.0;
+    for (double lead : options.leadTimes_s) maxLead = max(maxLead, lead);
+    const double tcaMs = jd_to_unix_ms(encounter_time);
+    const double startMs = tcaMs - maxLead * 1000.0;
+    const size_t steps = static_cast<size_t>((maxLead + 600.0) / stepSeconds) + 1;
+
+    const vector<OrbitalElements> elements = {*primary, *secondary};
+    TrajectoryStore store;
+    if (propagate_batch(elements.data(), elements.size(), startMs, stepSeconds, steps, store, 1) !=
+        PROPAGATION_SUCCESS) {
+        return -1;
+    }
+
+    ManeuverSearchResult result;
+    if (search_avoidance(store, elements, nullptr, 0, 1, tcaMs, options, result) != MANEUVER_SEARCH_SUCCESS) {
+        return -1;
+    }
+
+    // Cheapest burn on the Pareto set that reaches the target separation
+    for (uint32_t c : result.pareto) {
+        if (result.candidates[c].secondaryMiss_m >= target_distance_km * 1000.0) {
+            candidate_to_maneuver(result.candidates[c], out_maneuver);
+            return 0;
+        }
+    }
+    return -1;
 }
 
 void apply_maneuver(const OrbitalElements* elements, const Maneuver* m,
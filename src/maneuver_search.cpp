@@ -0,0 +1,318 @@
+#include "maneuver_search.h"
+#include "propagation.h"
+#include "screening_index.h"
+#include "constants.h"
+#include "parallel.h"
+#include "instrumentation.h"
+#include <cstdio>
+#include <cstring>
+
+namespace {
+
+// Primary's state just before a burn, shared by every burn at that time
+struct BurnSite {
+    double burnMs;
+    size_t firstStep;      // first grid step at or after the burn
+    StateVectorECI pre;
+    double basis[3][3];    // radial, in-track, cross-track unit vectors (ECI)
+    vector<StateVectorECI> coast; // pre-burn state re-propagated the same way as a burn, from firstStep
+};
+
+struct SearchContext {
+    const TrajectoryStore* store;
+    const OrbitalElements* primaryElements;
+    const ScreeningIndex* index;
+    uint32_t primary, secondary;
+    vector<double> timesJd;  // Julian date of every grid step
+    double halfStep_s;       // sub-step refinement stays within half a step of a sample
+};
+
+// Per-worker scratch, reused across candidates
+struct SearchWorker {
+    vector<StateVectorECI> states;
+    vector<uint32_t> neighbours;
+    vector<uint32_t> stamp;  // candidate number that last counted each object
+    uint32_t current = 0;
+};
+
+bool make_site(const SearchContext& ctx, double burnMs, BurnSite& site) {
+    const double jd = unix_ms_to_jd(burnMs);
+    const double minutes = (jd - ctx.primaryElements->epoch) * MINUTES_PER_DAY;
+    if (propagate(ctx.primaryElements, minutes, &site.pre) != PROPAGATION_SUCCESS) return false;
+
+    const double* r = site.pre.r;
+    const double* v = site.pre.v;
+    double h[3] = {r[1] * v[2] - r[2] * v[1], r[2] * v[0] - r[0] * v[2], r[0] * v[1] - r[1] * v[0]};
+    const double rMag = sqrt(r[0] * r[0] + r[1] * r[1] + r[2] * r[2]);
+    const double hMag = sqrt(h[0] * h[0] + h[1] * h[1] + h[2] * h[2]);
+    if (!(rMag > 0.0) || !(hMag > 0.0)) return false;
+    for (int d = 0; d < 3; ++d) {
+        site.basis[0][d] = r[d] / rMag;
+        site.basis[2][d] = h[d] / hMag;
+    }
+    const double* R = site.basis[0];
+    const double* N = site.basis[2];
+    site.basis[1][0] = N[1] * R[2] - N[2] * R[1];
+    site.basis[1][1] = N[2] * R[0] - N[0] * R[2];
+    site.basis[1][2] = N[0] * R[1] - N[1] * R[0];
+
+    site.burnMs = burnMs;
+    site.firstStep = store_step_lower_bound(*ctx.store, burnMs);
+
+    OrbitalElements el;
+    if (state_to_elements(&site.pre, &el) != PROPAGATION_SUCCESS) return false;
+    const size_t m = ctx.store->steps - site.firstStep;
+    site.coast.resize(m);
+    return m == 0 || propagate_grid(&el, 1, ctx.timesJd.data() + site.firstStep, m,
+                                    site.coast.data()) == PROPAGATION_SUCCESS;
+}
+
+// Closest approach of two states under straight-line relative motion, within
+// halfStep_s either side of the sample (km); dt is its offset in seconds
+double sub_step_miss_km(const double pr[3], const double pv[3], const double qr[3],
+                        const double qv[3], double halfStep_s, double& dt) {
+    const double r[3] = {pr[0] - qr[0], pr[1] - qr[1], pr[2] - qr[2]};
+    const double v[3] = {pv[0] - qv[0], pv[1] - qv[1], pv[2] - qv[2]};
+    const double vv = v[0] * v[0] + v[1] * v[1] + v[2] * v[2];
+    dt = vv > 0.0 ? -(r[0] * v[0] + r[1] * v[1] + r[2] * v[2]) / vv : 0.0;
+    dt = max(-halfStep_s, min(halfStep_s, dt));
+    double miss2 = 0.0;
+    for (int d = 0; d < 3; ++d) miss2 += (r[d] + v[d] * dt) * (r[d] + v[d] * dt);
+    const double miss = sqrt(miss2);
+    if (!std::isfinite(miss)) {
+        dt = 0.0;
+        return numeric_limits<double>::infinity();
+    }
+    return miss;
+}
+
+// Propagate one burn over the rest of the grid and measure its misses
+void evaluate_candidate(const SearchContext& ctx, const BurnSite& site, const double rtn_mps[3],
+                        const ManeuverSearchOptions& options, SearchWorker& w,
+                        ManeuverCandidate& out) {
+    const TrajectoryStore& store = *ctx.store;
+    const double inf = numeric_limits<double>::infinity();
+    const double nan = numeric_limits<double>::quiet_NaN();
+
+    out.burnTime = site.burnMs;
+    double dv2 = 0.0;
+    for (int d = 0; d < 3; ++d) {
+        out.rtn_mps[d] = rtn_mps[d];
+        out.dv_eci_mps[d] = rtn_mps[0] * site.basis[0][d] + rtn_mps[1] * site.basis[1][d] +
+                            rtn_mps[2] * site.basis[2][d];
+        dv2 += rtn_mps[d] * rtn_mps[d];
+    }
+    out.dv_mps = sqrt(dv2);
+    out.fuel_kg = fuel_consumption(out.dv_mps / 1000.0, options.specificImpulse_s,
+                                   options.dryMass_kg, options.propellantMass_kg, options.efficiency);
+    out.secondaryMiss_m = inf;
+    out.secondaryTca = nan;
+    out.catalogMiss_m = inf;
+    out.catalogObject = UINT32_MAX;
+    out.catalogConflicts = 0;
+    out.miss_m = nan;
+
+    // Post-burn trajectory: elements through the new state are propagated and
+    // their offset from the coasting re-propagation is added to the stored
+    // trajectory. Drag terms and the catalog elements' own epoch then cancel,
+    // so a zero burn reproduces the stored states.
+    StateVectorECI post = site.pre;
+    for (int d = 0; d < 3; ++d) post.v[d] += out.dv_eci_mps[d] / 1000.0;
+    OrbitalElements el;
+    if (state_to_elements(&post, &el) != PROPAGATION_SUCCESS) {
+        out.secondaryMiss_m = out.catalogMiss_m = nan;
+        return;
+    }
+
+    const size_t first = site.firstStep;
+    const size_t m = store.steps - first;
+    w.states.resize(m);
+    if (m && propagate_grid(&el, 1, ctx.timesJd.data() + first, m, w.states.data()) != PROPAGATION_SUCCESS) {
+        out.secondaryMiss_m = out.catalogMiss_m = nan;
+        return;
+    }
+    for (size_t k = first; k < store.steps; ++k) {
+        StateVectorECI& sv = w.states[k - first];
+        const StateVectorECI& c = site.coast[k - first];
+        const State base = store_state(store, ctx.primary, k);
+        sv.r[0] += base.x - c.r[0];
+        sv.r[1] += base.y - c.r[1];
+        sv.r[2] += base.z - c.r[2];
+        sv.v[0] += base.vx - c.v[0];
+        sv.v[1] += base.vy - c.v[1];
+        sv.v[2] += base.vz - c.v[2];
+    }
+
+    // Secondary: every sample, so a fast crossing between two distant samples
+    // is not mistaken for a wide pass
+    const uint32_t s = ctx.secondary;
+    for (size_t k = first; k < store.steps; ++k) {
+        const StateVectorECI& p = w.states[k - first];
+        const State q = store_state(store, s, k);
+        const double qr[3] = {q.x, q.y, q.z};
+        const double qv[3] = {q.vx, q.vy, q.vz};
+        double dt;
+        const double miss_m = sub_step_miss_km(p.r, p.v, qr, qv, ctx.halfStep_s, dt) * 1000.0;
+        if (miss_m < out.secondaryMiss_m) {
+            out.secondaryMiss_m = miss_m;
+            out.secondaryTca = store.time(k) + dt * 1000.0;
+        }
+    }
+
+    // Rest of the catalog, through the broad-phase grid of each step
+    if (ctx.index) {
+        const double limitKm = ctx.index->distance_m / 1000.0;
+        if (++w.current == 0) {
+            fill(w.stamp.begin(), w.stamp.end(), 0u);
+            w.current = 1;
+        }
+        for (size_t k = first; k < store.steps; ++k) {
+            const StateVectorECI& p = w.states[k - first];
+            w.neighbours.clear();
+            screening_index_neighbours(*ctx.index, k, p.r, w.neighbours);
+            const double* xs = store.row(STORE_X, k);
+            const double* ys = store.row(STORE_Y, k);
+            const double* zs = store.row(STORE_Z, k);
+            for (uint32_t o : w.neighbours) {
+                if (o == ctx.primary || o == s) continue;
+                const double qr[3] = {xs[o], ys[o], zs[o]};
+                const double dx = p.r[0] - qr[0], dy = p.r[1] - qr[1], dz = p.r[2] - qr[2];
+                if (!(dx * dx + dy * dy + dz * dz <= limitKm * limitKm)) continue;
+
+                const double qv[3] = {store.row(STORE_VX, k)[o], store.row(STORE_VY, k)[o],
+                                      store.row(STORE_VZ, k)[o]};
+                double dt;
+                const double miss_m = sub_step_miss_km(p.r, p.v, qr, qv, ctx.halfStep_s, dt) * 1000.0;
+                if (miss_m < out.catalogMiss_m) {
+                    out.catalogMiss_m = miss_m;
+                    out.catalogObject = o;
+                }
+                if (miss_m <= options.catalogThreshold_m && w.stamp[o] != w.current) {
+                    w.stamp[o] = w.current;
+                    ++out.catalogConflicts;
+                }
+            }
+        }
+    }
+    out.miss_m = min(out.secondaryMiss_m, out.catalogMiss_m);
+}
+
+bool valid_options(const ManeuverSearchOptions& options) {
+    if (!(options.specificImpulse_s > 0.0) || !(options.dryMass_kg >= 0.0) ||
+        !(options.propellantMass_kg >= 0.0) || !(options.dryMass_kg + options.propellantMass_kg > 0.0)) {
+        return false;
+    }
+    for (double lead : options.leadTimes_s) {
+        if (!(lead >= 0.0) || !std::isfinite(lead)) return false;
+    }
+    for (double mag : options.magnitudes_mps) {
+        if (!(mag >= 0.0) || !std::isfinite(mag)) return false;
+    }
+    return options.catalogThreshold_m >= 0.0;
+}
+
+} // namespace
+
+int search_avoidance(const TrajectoryStore& store, const vector<OrbitalElements>& elements,
+                     const ScreeningIndex* index, uint32_t primary, uint32_t secondary,
+                     double tcaMs, const ManeuverSearchOptions& options,
+                     ManeuverSearchResult& out) {
+    NOVA_SCOPE("search_avoidance");
+    out.candidates.clear();
+    out.pareto.clear();
+    if (store.steps == 0 || elements.size() != store.count || primary >= store.count ||
+        secondary >= store.count || primary == secondary || !valid_options(options)) {
+        return MANEUVER_SEARCH_ERROR_INVALID_INPUT;
+    }
+    if (!(tcaMs >= store.time(0)) || !(tcaMs <= store.time(store.steps - 1))) {
+        return MANEUVER_SEARCH_ERROR_INVALID_INPUT;
+    }
+    if (index && index->cells.size() != store.steps) return MANEUVER_SEARCH_ERROR_INVALID_INPUT;
+
+    SearchContext ctx;
+    ctx.store = &store;
+    ctx.primaryElements = &elements[primary];
+    ctx.index = index;
+    ctx.primary = primary;
+    ctx.secondary = secondary;
+    ctx.timesJd.resize(store.steps);
+    for (size_t k = 0; k < store.steps; ++k) ctx.timesJd[k] = unix_ms_to_jd(store.time(k));
+    ctx.halfStep_s = store.steps > 1 ? 0.5 * (store.time(1) - store.time(0)) / 1000.0 : 0.0;
+
+    vector<BurnSite> sites;
+    for (double lead : options.leadTimes_s) {
+        const double burnMs = tcaMs - lead * 1000.0;
+        BurnSite site;
+        if (burnMs < store.time(0) || !make_site(ctx, burnMs, site)) continue;
+        sites.push_back(site);
+    }
+    if (sites.empty()) return MANEUVER_SEARCH_ERROR_INVALID_INPUT;
+
+    // Lead time-major grid of (site, RTN burn)
+    struct Trial {
+        uint32_t site;
+        double rtn[3];
+    };
+    vector<Trial> trials;
+    for (uint32_t si = 0; si < sites.size(); ++si) {
+        for (int dir = 0; dir < 6; ++dir) {
+            if (!(options.directions & (1u << dir))) continue;
+            for (double mag : options.magnitudes_mps) {
+                Trial t = {si, {0.0, 0.0, 0.0}};
+                t.rtn[dir / 2] = (dir % 2) ? -mag : mag;
+                trials.push_back(t);
+            }
+        }
+    }
+
+    const unsigned threads = resolve_thread_count(options.threads);
+    vector<SearchWorker> workers(threads);
+    for (auto& w : workers) w.stamp.assign(index ? store.count : 0, 0u);
+
+    // No burn, over the longest post-burn span searched
+    size_t earliest = 0;
+    for (size_t si = 1; si < sites.size(); ++si) {
+        if (sites[si].burnMs < sites[earliest].burnMs) earliest = si;
+    }
+    const double zero[3] = {0.0, 0.0, 0.0};
+    evaluate_candidate(ctx, sites[earliest], zero, options, workers[0], out.baseline);
+
+    out.candidates.resize(trials.size());
+    parallel_for_chunks(trials.size(), 4, threads, [&](unsigned wi, size_t begin, size_t end) {
+        for (size_t c = begin; c < end; ++c) {
+            evaluate_candidate(ctx, sites[trials[c].site], trials[c].rtn, options, workers[wi],
+                               out.candidates[c]);
+        }
+    });
+
+    // Pareto set: cheapest first, keeping each candidate that beats every cheaper miss
+    vector<uint32_t> order;
+    for (uint32_t c = 0; c < out.candidates.size(); ++c) {
+        if (!std::isnan(out.candidates[c].miss_m)) order.push_back(c);
+    }
+    sort(order.begin(), order.end(), [&](uint32_t a, uint32_t b) {
+        const ManeuverCandidate& x = out.candidates[a];
+        const ManeuverCandidate& y = out.candidates[b];
+        if (x.fuel_kg != y.fuel_kg) return x.fuel_kg < y.fuel_kg;
+        if (x.miss_m != y.miss_m) return x.miss_m > y.miss_m;
+        return a < b;
+    });
+    double bestMiss = -numeric_limits<double>::infinity();
+    for (uint32_t c : order) {
+        if (out.candidates[c].miss_m > bestMiss) {
+            bestMiss = out.candidates[c].miss_m;
+            out.pareto.push_back(c);
+        }
+    }
+    return MANEUVER_SEARCH_SUCCESS;
+}
+
+void candidate_to_maneuver(const ManeuverCandidate& candidate, Maneuver* out_maneuver) {
+    if (!out_maneuver) return;
+    memset(out_maneuver, 0, sizeof(Maneuver));
+    out_maneuver->epoch = unix_ms_to_jd(candidate.burnTime);
+    for (int d = 0; d < 3; ++d) out_maneuver->delta_v[d] = candidate.dv_eci_mps[d];
+    out_maneuver->fuel_cost = candidate.fuel_kg;
+    long long epoch_int = (long long)(out_maneuver->epoch * 1000000);
+    snprintf(out_maneuver->id, sizeof(out_maneuver->id), "AVOID_%lld", epoch_int);
+}
@@ -0,0 +1,102 @@
+#include "mapped_file.h"
+#include <cstring>
+#include <filesystem>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+MappedFile::~MappedFile() {
+    unmap_file(*this);
+}
+
+bool map_file(const string& filename, MappedFile& out) {
+    unmap_file(out);
+#ifdef _WIN32
+    HANDLE file = CreateFileA(filename.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr,
+                              OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (file == INVALID_HANDLE_VALUE) return false;
+    LARGE_INTEGER size;
+    if (!GetFileSizeEx(file, &size)) { CloseHandle(file); return false; }
+    out.fileHandle = file;
+    out.size = static_cast<size_t>(size.QuadPart);
+    if (out.size == 0) return true;
+    HANDLE mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    if (mapping) {
+        void* view = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+        if (view) {
+            out.mapping = mapping;
+            out.data = static_cast<const char*>(view);
+            return true;
+        }
+        CloseHandle(mapping);
+    }
+#else
+    int fd = open(filename.c_str(), O_RDONLY);
+    if (fd < 0) return false;
+    struct stat st;
+    if (fstat(fd, &st) != 0) { close(fd); return false; }
+    out.size = static_cast<size_t>(st.st_size);
+    if (out.size == 0) { close(fd); return true; }
+    void* view = mmap(nullptr, out.size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd); // the mapping keeps the file referenced
+    if (view != MAP_FAILED) {
+        out.mapping = view;
+        out.data = static_cast<const char*>(view);
+        return true;
+    }
+#endif
+    // Not mappable (pipe, special file, ...): read it instead
+    ifstream file(filename, ios::binary);
+    if (!file.is_open()) {
+        unmap_file(out);
+        return false;
+    }
+    out.fallback.assign(istreambuf_iterator<char>(file), istreambuf_iterator<char>());
+    out.size = out.fallback.size();
+    out.data = out.fallback.data();
+    return true;
+}
+
+void unmap_file(MappedFile& file) {
+#ifdef _WIN32
+    if (file.mapping) {
+        UnmapViewOfFile(file.data);
+        CloseHandle(static_cast<HANDLE>(file.mapping));
+    }
+    if (file.fileHandle) CloseHandle(static_cast<HANDLE>(file.fileHandle));
+#else
+    if (file.mapping) munmap(file.mapping, file.size);
+#endif
+    file.mapping = nullptr;
+    file.fileHandle = nullptr;
+    file.data = nullptr;
+    file.size = 0;
+    vector<char>().swap(file.fallback);
+}
+
+bool host_little_endian() {
+    const uint32_t probe = 1;
+    unsigned char first;
+    memcpy(&first, &probe, 1);
+    return first == 1;
+}
+
+string temp_file_path(const string& path) {
+    return path + ".tmp";
+}
+
+bool commit_file(const string& tmp, const string& path) {
+    error_code ec;
+    filesystem::rename(tmp, path, ec);
+    if (!ec) return true;
+    error_code removeError; // a successful cleanup must not hide the failed rename
+    filesystem::remove(tmp, removeError);
+    return false;
+}
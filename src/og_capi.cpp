@@ -0,0 +1,181 @@
+#include "og_capi.h"
+#include "propagation.h"
+#include "orbit_prefilter.h"
+#include "collision_probability.h"
+#include "tca_refine.h"
+#include <cstring>
+
+static_assert(sizeof(og_encounter) == 48, "og_encounter layout is part of the ABI");
+
+// Everything the C callers see through the opaque handle
+struct og_context {
+    PipelineCatalog catalog;
+    TrajectoryStore store;
+    bool propagated = false;
+    double startMs = 0.0;
+    double stepSeconds = 0.0;
+    double durationHours = 0.0;
+    vector<og_encounter> encounters;
+};
+
+namespace {
+
+// Anything computed from the catalog is stale once it changes
+void drop_results(og_context* ctx) {
+    ctx->store = TrajectoryStore();
+    ctx->propagated = false;
+    ctx->encounters.clear();
+}
+
+} // namespace
+
+og_context* og_create(void) {
+    return new (nothrow) og_context();
+}
+
+void og_destroy(og_context* ctx) {
+    delete ctx;
+}
+
+void og_clear(og_context* ctx) {
+    if (!ctx) return;
+    ctx->catalog = PipelineCatalog();
+    drop_results(ctx);
+}
+
+int og_add_tle_text(og_context* ctx, const char* text, size_t length, int is_debris) {
+    if (!ctx || (!text && length > 0)) return OG_ERROR_INVALID_INPUT;
+    PipelineCatalog& catalog = ctx->catalog;
+    const size_t before = catalog.elements.size();
+    try {
+        vector<TLEView> records;
+        index_tle_buffer(text, length, records);
+        if (before + records.size() > UINT32_MAX) return OG_ERROR_INVALID_INPUT;
+
+        // Same per-record handling as the pipeline's catalog loader
+        for (const TLEView& view : records) {
+            OrbitalElements elements;
+            if (tle_view_to_elements(&view, &elements) != PROPAGATION_SUCCESS) {
+                memset(&elements, 0, sizeof(OrbitalElements));
+            }
+            catalog.ids.push_back(tle_view_name(view));
+            catalog.isDebris.push_back(is_debris != 0);
+            catalog.catalogNumbers.push_back(tle_catalog_number(view.line1, view.line1Len));
+            catalog.elements.push_back(elements);
+        }
+    } catch (...) {
+        // Out of memory part way: keep the catalog as it was (shrinking does not allocate)
+        catalog.ids.resize(min(catalog.ids.size(), before));
+        catalog.isDebris.resize(min(catalog.isDebris.size(), before));
+        catalog.catalogNumbers.resize(min(catalog.catalogNumbers.size(), before));
+        catalog.elements.resize(min(catalog.elements.size(), before));
+        return OG_ERROR_FAILED;
+    }
+    drop_results(ctx);
+    return OG_SUCCESS;
+}
+
+uint32_t og_object_count(const og_context* ctx) {
+    return ctx ? static_cast<uint32_t>(ctx->catalog.elements.size()) : 0;
+}
+
+const char* og_object_name(const og_context* ctx, uint32_t i) {
+    if (!ctx || i >= ctx->catalog.ids.size()) return "";
+    return ctx->catalog.ids[i].c_str();
+}
+
+int og_object_is_debris(const og_context* ctx, uint32_t i) {
+    if (!ctx || i >= ctx->catalog.isDebris.size()) return 0;
+    return ctx->catalog.isDebris[i] ? 1 : 0;
+}
+
+int og_propagate(og_context* ctx, double start_ms, double step_seconds, double duration_hours) {
+    if (!ctx || !isfinite(start_ms) || !window_steps(step_seconds, duration_hours)) {
+        return OG_ERROR_INVALID_INPUT;
+    }
+    drop_results(ctx);
+    try {
+        if (propagate_catalog(ctx->catalog, start_ms, step_seconds, duration_hours, ctx->store, 1) !=
+            PROPAGATION_SUCCESS) {
+            drop_results(ctx);
+            return OG_ERROR_INVALID_INPUT;
+        }
+    } catch (...) {
+        drop_results(ctx); // store too large for memory
+        return OG_ERROR_FAILED;
+    }
+    ctx->propagated = true;
+    ctx->startMs = start_ms;
+    ctx->stepSeconds = step_seconds;
+    ctx->durationHours = duration_hours;
+    return OG_SUCCESS;
+}
+
+uint32_t og_store_steps(const og_context* ctx) {
+    return ctx ? static_cast<uint32_t>(ctx->store.steps) : 0;
+}
+
+const double* og_store_times(const og_context* ctx) {
+    return ctx && ctx->propagated ? ctx->store.times.data() : nullptr;
+}
+
+const double* og_store_plane(const og_context* ctx, int plane) {
+    if (!ctx || !ctx->propagated || plane < 0 || plane >= STORE_COMPONENTS) return nullptr;
+    // Freshly propagated stores start at slot 0, so each plane is in step order
+    return ctx->store.row(plane, 0);
+}
+
+int og_screen(og_context* ctx, double threshold_m, uint32_t flags) {
+    if (!ctx || !(threshold_m > 0.0)) return OG_ERROR_INVALID_INPUT;
+    if (!ctx->propagated) return OG_ERROR_NOT_PROPAGATED;
+    ctx->encounters.clear();
+
+    // Exceptions (bad_alloc on a large catalog, ...) must not cross the C or
+    // WASM boundary
+    try {
+        // Single-threaded throughout: the WASM build has no worker threads
+        const bool refine = (flags & OG_SCREEN_REFINE) != 0;
+        ScreeningOptions options;
+        options.threads = 1;
+        options.refineTca = refine;
+        options.refineMargin_m = refine ? refine_margin_for_step(ctx->stepSeconds) : 0.0;
+
+        PairPrefilter prefilter;
+        if (flags & OG_SCREEN_PREFILTER) {
+            if (build_pair_prefilter(ctx->catalog.elements, ctx->startMs, ctx->durationHours,
+                                     threshold_m + PREFILTER_PAD_M, prefilter, 1) != PREFILTER_SUCCESS) {
+                return OG_ERROR_FAILED;
+            }
+            options.prefilter = &prefilter;
+        }
+        PcOptions probability;
+        probability.threads = 1;
+        if (refine && (flags & OG_SCREEN_PC)) options.probability = &probability;
+
+        const vector<Encounter> found = screen_by_threshold(ctx->store, threshold_m, options);
+        ctx->encounters.resize(found.size());
+        for (size_t e = 0; e < found.size(); ++e) {
+            og_encounter& out = ctx->encounters[e];
+            out.a = found[e].aIndex;
+            out.b = found[e].bIndex;
+            out.t = found[e].t;
+            out.miss_m = found[e].miss_m;
+            out.rel_mps = found[e].rel_mps;
+            out.pc = found[e].pc;
+            out.severity = found[e].severity;
+            out.reserved = 0;
+        }
+        return OG_SUCCESS;
+    } catch (...) {
+        vector<og_encounter>().swap(ctx->encounters);
+        return OG_ERROR_FAILED;
+    }
+}
+
+uint32_t og_encounter_count(const og_context* ctx) {
+    return ctx ? static_cast<uint32_t>(ctx->encounters.size()) : 0;
+}
+
+const og_encounter* og_encounters(const og_context* ctx) {
+    return ctx ? ctx->encounters.data() : nullptr;
+}
@@ -0,0 +1,217 @@
+#include "orbit_prefilter.h"
+#include "propagation.h"
+#include "constants.h"
+#include "parallel.h"
+
+namespace {
+
+// Per-object geometry at mid-window plus how far it can turn either side of it
+struct OrbitShape {
+    bool valid;
+    double q, Q;          // perigee and apogee radius (km)
+    double p, e;          // semi-latus rectum (km), eccentricity
+    double normal[3];     // orbit normal
+    double P[3], Qv[3];   // perigee direction and the in-plane direction 90 deg ahead
+    double normalDrift;   // max rotation of the normal over half the window (rad)
+    double inPlaneDrift;  // max rotation of in-plane directions over half the window (rad)
+};
+
+OrbitShape make_shape(const OrbitalElements& el, double midJd, double halfMinutes) {
+    OrbitShape o;
+    OrbitGeometry g;
+    o.valid = orbit_geometry(&el, midJd, &g) == PROPAGATION_SUCCESS;
+    if (!o.valid) return o;
+
+    o.e = g.e;
+    o.q = g.a * (1.0 - g.e);
+    o.Q = g.a * (1.0 + g.e);
+    o.p = g.a * (1.0 - g.e * g.e);
+
+    const double cO = cos(g.raan), sO = sin(g.raan);
+    const double cw = cos(g.argp), sw = sin(g.argp);
+    const double ci = cos(g.inclination), si = sin(g.inclination);
+    o.normal[0] = sO * si;
+    o.normal[1] = -cO * si;
+    o.normal[2] = ci;
+    o.P[0] = cO * cw - sO * sw * ci;
+    o.P[1] = sO * cw + cO * sw * ci;
+    o.P[2] = sw * si;
+    o.Qv[0] = -cO * sw - sO * cw * ci;
+    o.Qv[1] = -sO * sw + cO * cw * ci;
+    o.Qv[2] = cw * si;
+
+    // A rotation of the node by dO about z moves the normal by at most dO sin i
+    // and any in-plane direction by at most dO; perigee drift adds to the latter
+    const double raanDrift = fabs(g.raanDot) * halfMinutes;
+    const double argpDrift = fabs(g.argpDot) * halfMinutes;
+    o.normalDrift = raanDrift * fabs(si);
+    o.inPlaneDrift = raanDrift + argpDrift;
+    return o;
+}
+
+double dot3(const double* a, const double* b) {
+    return a[0] * b[0] + a[1] * b[1] + a[2] * b[2];
+}
+
+// True if angle x lies within half of centre (mod 2 pi)
+bool angle_within(double x, double centre, double half) {
+    return fabs(remainder(x - centre, TWO_PI)) <= half;
+}
+
+// Radius range of the conic over true anomalies centre +/- half
+void radius_range(const OrbitShape& o, double centre, double half, double& rmin, double& rmax) {
+    if (half >= PI) {
+        rmin = o.q;
+        rmax = o.Q;
+        return;
+    }
+    const double c1 = cos(centre - half), c2 = cos(centre + half);
+    const double cosMax = angle_within(0.0, centre, half) ? 1.0 : max(c1, c2);
+    const double cosMin = angle_within(PI, centre, half) ? -1.0 : min(c1, c2);
+    rmin = o.p / (1.0 + o.e * cosMax);
+    rmax = o.p / (1.0 + o.e * cosMin);
+}
+
+// Apogee/perigee gate: radial shells closer than d (km)
+bool shells_overlap(const OrbitShape& a, const OrbitShape& b, double d) {
+    return max(a.q, b.q) - min(a.Q, b.Q) <= d;
+}
+
+// Orbit-path filter. Two objects within d of each other are each within d of
+// the other's plane, so both sit near the mutual line of nodes; there their
+// radii must also agree to within d. Angular windows are widened by how far
+// the planes and perigees can turn during the window.
+bool orbit_paths_may_meet(const OrbitShape& a, const OrbitShape& b, double d) {
+    double c[3] = {
+        a.normal[1] * b.normal[2] - a.normal[2] * b.normal[1],
+        a.normal[2] * b.normal[0] - a.normal[0] * b.normal[2],
+        a.normal[0] * b.normal[1] - a.normal[1] * b.normal[0]
+    };
+    const double s = sqrt(dot3(c, c));
+    const double relInc = atan2(s, dot3(a.normal, b.normal));
+
+    // Smallest sine of the relative inclination the window allows (10% slack)
+    const double drift = 1.1 * (a.normalDrift + b.normalDrift);
+    const double sinLow = min(sin(max(0.0, relInc - drift)), sin(min(PI, relInc + drift)));
+    if (sinLow < 1e-6) return true; // near coplanar: no usable line of nodes
+
+    // The line of nodes can swing by up to drift / sin(relative inclination)
+    const double swing = drift / sinLow;
+    if (swing >= 0.5 * PI) return true;
+    for (int k = 0; k < 3; ++k) c[k] /= s;
+
+    double centre[2], half[2];
+    const OrbitShape* orbits[2] = {&a, &b};
+    for (int o = 0; o < 2; ++o) {
+        const OrbitShape& orb = *orbits[o];
+        centre[o] = atan2(dot3(c, orb.Qv), dot3(c, orb.P)); // true anomaly of the node
+        const double offPlane = d / (orb.q * sinLow);
+        half[o] = offPlane >= 1.0 ? PI
+                                  : asin(offPlane) + swing + 1.1 * orb.inPlaneDrift + 1e-3;
+    }
+
+    // Ascending node of one orbit meets the ascending node of the other, and
+    // likewise for the descending nodes
+    for (int node = 0; node < 2; ++node) {
+        double aMin, aMax, bMin, bMax;
+        radius_range(a, centre[0] + node * PI, half[0], aMin, aMax);
+        radius_range(b, centre[1] + node * PI, half[1], bMin, bMax);
+        if (max(aMin, bMin) - min(aMax, bMax) <= d) return true;
+    }
+    return false;
+}
+
+// Pair survivors and counts gathered by one worker
+struct PrefilterWorker {
+    vector<uint64_t> keys;
+    uint64_t apsis = 0;
+};
+
+} // namespace
+
+int build_pair_prefilter(const vector<OrbitalElements>& elements, double startMs,
+                         double durationHours, double distance_m, PairPrefilter& out,
+                         unsigned threads) {
+    const size_t n = elements.size();
+    if (!(distance_m >= 0.0) || !(durationHours >= 0.0) ||
+        n > numeric_limits<uint32_t>::max()) {
+        return PREFILTER_ERROR_INVALID_INPUT;
+    }
+
+    const double halfMinutes = durationHours * 30.0;
+    const double midJd = unix_ms_to_jd(startMs) + halfMinutes / MINUTES_PER_DAY;
+    const double d = distance_m / 1000.0;
+
+    vector<OrbitShape> shapes(n);
+    threads = resolve_thread_count(threads);
+    parallel_for_chunks(n, 256, threads, [&](unsigned, size_t begin, size_t end) {
+        for (size_t i = begin; i < end; ++i) shapes[i] = make_shape(elements[i], midJd, halfMinutes);
+    });
+
+    // Valid objects by perigee: partners of the object at position p whose
+    // shells can overlap sit in (p, first position with perigee > apogee + d)
+    vector<uint32_t> order, invalid;
+    for (size_t i = 0; i < n; ++i) {
+        (shapes[i].valid ? order : invalid).push_back(static_cast<uint32_t>(i));
+    }
+    sort(order.begin(), order.end(), [&](uint32_t x, uint32_t y) {
+        return shapes[x].q < shapes[y].q || (shapes[x].q == shapes[y].q && x < y);
+    });
+
+    vector<PrefilterWorker> workers(threads);
+    parallel_for_chunks(order.size(), 64, threads, [&](unsigned w, size_t begin, size_t end) {
+        PrefilterWorker& pw = workers[w];
+        for (size_t p = begin; p < end; ++p) {
+            const uint32_t i = order[p];
+            const OrbitShape& a = shapes[i];
+            for (size_t r = p + 1; r < order.size() && shapes[order[r]].q - a.Q <= d; ++r) {
+                const uint32_t j = order[r];
+                if (!shells_overlap(a, shapes[j], d)) continue;
+                ++pw.apsis;
+                if (orbit_paths_may_meet(a, shapes[j], d)) {
+                    pw.keys.push_back(i < j ? static_cast<uint64_t>(i) * n + j
+                                            : static_cast<uint64_t>(j) * n + i);
+                }
+            }
+        }
+    });
+
+    // Objects without usable elements keep every pair
+    vector<uint64_t> keys;
+    uint64_t apsis = 0;
+    for (auto& pw : workers) {
+        keys.insert(keys.end(), pw.keys.begin(), pw.keys.end());
+        apsis += pw.apsis;
+        vector<uint64_t>().swap(pw.keys);
+    }
+    for (uint32_t bad : invalid) {
+        for (size_t j = 0; j < n; ++j) {
+            if (j == bad || (!shapes[j].valid && j < bad)) continue;
+            keys.push_back(bad < j ? static_cast<uint64_t>(bad) * n + j
+                                   : static_cast<uint64_t>(j) * n + bad);
+            ++apsis;
+        }
+    }
+    sort(keys.begin(), keys.end());
+
+    out.count = n;
+    out.offsets.assign(n + 1, 0);
+    out.partners.resize(keys.size());
+    for (size_t k = 0; k < keys.size(); ++k) {
+        out.offsets[keys[k] / n + 1]++;
+        out.partners[k] = static_cast<uint32_t>(keys[k] % n);
+    }
+    for (size_t i = 0; i < n; ++i) out.offsets[i + 1] += out.offsets[i];
+
+    out.stats.pairs = n < 2 ? 0 : static_cast<uint64_t>(n) * (n - 1) / 2;
+    out.stats.apsis = apsis;
+    out.stats.orbitPath = keys.size();
+    return PREFILTER_SUCCESS;
+}
+
+bool prefilter_allows(const PairPrefilter& filter, uint32_t i, uint32_t j) {
+    if (i >= filter.count || j >= filter.count) return true;
+    const uint32_t* begin = filter.partners.data() + filter.offsets[i];
+    const uint32_t* end = filter.partners.data() + filter.offsets[i + 1];
+    return binary_search(begin, end, j);
+}
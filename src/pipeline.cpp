@@ -0,0 +1,708 @@
+#include "pipeline.h"
+#include "track_export.h"
+#include "tca_refine.h"
+#include "orbit_prefilter.h"
+#include "collision_probability.h"
+#include "instrumentation.h"
+#include "lazy_ephemeris.h"
+#include "compact_store.h"
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+
+namespace fs = std::filesystem;
+
+namespace {
+
+// How many values an option takes
+enum OptionArity {
+    OPTION_FLAG,     // none
+    OPTION_VALUE,    // exactly one
+    OPTION_OPTIONAL  // one if the next argument is not an option
+};
+
+struct OptionSpec {
+    const char* name;
+    OptionArity arity;
+    const char* arg;  // value placeholder for the usage text
+    const char* help;
+};
+
+const OptionSpec OPTIONS[] = {
+    {"config", OPTION_VALUE, "FILE", "apply options from a key = value file"},
+    {"satellites", OPTION_VALUE, "PATH", "satellite TLE catalog (repeatable)"},
+    {"debris", OPTION_VALUE, "PATH", "debris TLE catalog (repeatable)"},
+    {"epoch", OPTION_VALUE, "MS", "window start, Unix ms (default 1734979200000)"},
+    {"step", OPTION_VALUE, "SECONDS", "time step (default 60)"},
+    {"hours", OPTION_VALUE, "HOURS", "window length (default 24)"},
+    {"threshold", OPTION_VALUE, "METERS", "screening threshold (default 5000; repeatable, one job each)"},
+    {"conjunctions", OPTION_VALUE, "PATH", "conjunctions output of the last --threshold"},
+    {"output-dir", OPTION_VALUE, "DIR", "directory for default outputs and the cache (default tests)"},
+    {"cache", OPTION_VALUE, "PATH", "ephemeris cache (default <output-dir>/ephemeris_cache.bin)"},
+    {"no-cache", OPTION_FLAG, "", "always propagate, never read or write the cache"},
+    {"no-tracks", OPTION_FLAG, "", "skip coordinates.json and coordinates.bin"},
+    {"track-stride", OPTION_VALUE, "N", "steps between samples in coordinates.json (default 10)"},
+    {"no-prefilter", OPTION_FLAG, "", "screen every pair, without the orbit-geometry prefilter"},
+    {"no-refine", OPTION_FLAG, "", "report sampled closest approaches (no TCA refinement)"},
+    {"no-pc", OPTION_FLAG, "", "skip collision probability"},
+    {"all-passes", OPTION_FLAG, "", "report every approach window per pair, with entry/exit times"},
+    {"lazy-cache", OPTION_VALUE, "MB", "propagate on demand through a chunk cache of MB (needs --no-tracks)"},
+    {"compact-store", OPTION_FLAG, "", "hold float32 states (half the memory); hits recomputed in double"},
+    {"top", OPTION_VALUE, "N", "write only the N highest-risk conjunctions, in risk order"},
+    {"min-pc", OPTION_VALUE, "P", "drop conjunctions with a collision probability below P"},
+    {"threads", OPTION_VALUE, "N", "worker threads (default 0 = one per hardware thread)"},
+    {"daemon", OPTION_OPTIONAL, "[HOURS]", "rolling screening over a horizon (default 72)"},
+    {"horizon", OPTION_VALUE, "HOURS", "rolling horizon for --daemon"},
+    {"profile", OPTION_VALUE, "PREFIX", "write <PREFIX>_summary.json and <PREFIX>_trace.json"},
+    {"shards", OPTION_VALUE, "N", "split the catalog into N blocks, screened by worker processes"},
+    {"shard-dir", OPTION_VALUE, "DIR", "worker exchange directory (default <output-dir>/shards)"},
+    {"shard-launcher", OPTION_VALUE, "CMD", "command prefix for each worker, e.g. \"srun -N1 -n1\""},
+    {"shard-parallel", OPTION_VALUE, "N", "workers in flight (default 0 = one per hardware thread)"},
+    {"shard-task", OPTION_VALUE, "TASK", "run one worker task: propagate:B or screen:A:B"},
+};
+
+const OptionSpec* find_option(const string& name) {
+    for (const OptionSpec& spec : OPTIONS) {
+        if (name == spec.name) return &spec;
+    }
+    return nullptr;
+}
+
+// Whether repeatable options still hold their defaults
+struct ParseState {
+    bool catalogsGiven = false;
+    bool thresholdsGiven = false;
+    int depth = 0; // nested --config files
+};
+
+const int MAX_CONFIG_DEPTH = 8;
+
+bool parse_number(const string& text, double& out) {
+    if (text.empty()) return false;
+    char* end = nullptr;
+    const double v = strtod(text.c_str(), &end);
+    if (*end != '\0' || !std::isfinite(v)) return false;
+    out = v;
+    return true;
+}
+
+bool parse_count(const string& text, unsigned long& out) {
+    if (text.empty() || text[0] == '-') return false;
+    char* end = nullptr;
+    const unsigned long v = strtoul(text.c_str(), &end, 10);
+    if (*end != '\0') return false;
+    out = v;
+    return true;
+}
+
+bool parse_flag(const string& text, bool& out) {
+    if (text.empty() || text == "true" || text == "1" || text == "yes") {
+        out = true;
+    } else if (text == "false" || text == "0" || text == "no") {
+        out = false;
+    } else {
+        return false;
+    }
+    return true;
+}
+
+int load_config_file(const string& path, PipelineConfig& config, ParseState& state, string& error);
+
+// One option with its value (empty for flags)
+int apply_option(const string& name, const string& value, bool hasValue,
+                 PipelineConfig& config, ParseState& state, string& error) {
+    const OptionSpec* spec = find_option(name);
+    if (!spec) {
+        error = "unknown option --" + name;
+        return PIPELINE_ERROR_INVALID_INPUT;
+    }
+    if (spec->arity == OPTION_VALUE && !hasValue) {
+        error = "--" + name + " needs a value";
+        return PIPELINE_ERROR_INVALID_INPUT;
+    }
+    auto bad_value = [&]() {
+        error = "invalid value for --" + name + ": " + value;
+        return PIPELINE_ERROR_INVALID_INPUT;
+    };
+
+    double number = 0.0;
+    unsigned long count = 0;
+    bool on = true;
+    if (spec->arity == OPTION_FLAG && hasValue && !parse_flag(value, on)) return bad_value();
+
+    if (name == "config") {
+        return load_config_file(value, config, state, error);
+    } else if (name == "satellites" || name == "debris") {
+        if (!state.catalogsGiven) config.catalogs.clear();
+        state.catalogsGiven = true;
+        config.catalogs.push_back({value, name == "debris"});
+    } else if (name == "epoch") {
+        if (!parse_number(value, number)) return bad_value();
+        config.startEpochMs = number;
+    } else if (name == "step") {
+        if (!parse_number(value, number) || !(number > 0.0)) return bad_value();
+        config.stepSeconds = number;
+    } else if (name == "hours") {
+        if (!parse_number(value, number) || !(number > 0.0)) return bad_value();
+        config.durationHours = number;
+    } else if (name == "threshold") {
+        if (!parse_number(value, number) || !(number > 0.0)) return bad_value();
+        // The first threshold takes over the default job (and any path already set for it)
+        if (!state.thresholdsGiven && config.jobs.size() == 1) {
+            config.jobs[0].threshold_m = number;
+        } else {
+            config.jobs.push_back({number, ""});
+        }
+        state.thresholdsGiven = true;
+    } else if (name == "conjunctions") {
+        if (config.jobs.empty()) config.jobs.push_back({5000.0, ""});
+        config.jobs.back().conjunctionsPath = value;
+    } else if (name == "output-dir") {
+        config.outputDir = value;
+    } else if (name == "cache") {
+        config.useCache = true;
+        config.cachePath = value;
+    } else if (name == "no-cache") {
+        config.useCache = !on;
+    } else if (name == "no-tracks") {
+        config.writeTracks = !on;
+    } else if (name == "track-stride") {
+        if (!parse_count(value, count) || count == 0 || count > UINT32_MAX) return bad_value();
+        config.trackJsonStride = static_cast<uint32_t>(count);
+    } else if (name == "no-prefilter") {
+        config.prefilter = !on;
+    } else if (name == "no-refine") {
+        config.refineTca = !on;
+    } else if (name == "no-pc") {
+        config.probability = !on;
+    } else if (name == "all-passes") {
+        config.allPasses = on;
+    } else if (name == "lazy-cache") {
+        if (!parse_count(value, count) || count > (SIZE_MAX >> 20)) return bad_value();
+        config.lazyCacheMB = count;
+    } else if (name == "compact-store") {
+        config.compactStore = on;
+    } else if (name == "top") {
+        if (!parse_count(value, count) || count > UINT32_MAX) return bad_value();
+        config.topRisks = count;
+    } else if (name == "min-pc") {
+        if (!parse_number(value, number) || number < 0.0 || number > 1.0) return bad_value();
+        config.minProbability = number;
+    } else if (name == "threads") {
+        if (!parse_count(value, count) || count > 4096) return bad_value();
+        config.threads = static_cast<unsigned>(count);
+    } else if (name == "daemon") {
+        // --daemon HOURS, or a flag value in config files
+        bool daemon = true;
+        if (hasValue && parse_number(value, number)) {
+            if (!(number > 0.0)) return bad_value();
+            config.horizonHours = number;
+        } else if (hasValue && !parse_flag(value, daemon)) {
+            return bad_value();
+        }
+        config.daemon = daemon;
+    } else if (name == "horizon") {
+        if (!parse_number(value, number) || !(number > 0.0)) return bad_value();
+        config.horizonHours = number;
+    } else if (name == "profile") {
+        config.profilePrefix = value;
+    } else if (name == "shards") {
+        if (!parse_count(value, count) || count > 4096) return bad_value();
+        config.shardBlocks = count;
+    } else if (name == "shard-dir") {
+        config.shardDir = value;
+    } else if (name == "shard-launcher") {
+        config.shardLauncher = value;
+    } else if (name == "shard-parallel") {
+        if (!parse_count(value, count) || count > 4096) return bad_value();
+        config.shardParallel = static_cast<unsigned>(count);
+    } else if (name == "shard-task") {
+        config.shardTask = value;
+    }
+    return PIPELINE_SUCCESS;
+}
+
+string trim(const string& text) {
+    const size_t begin = text.find_first_not_of(" \t\r");
+    if (begin == string::npos) return string();
+    const size_t end = text.find_last_not_of(" \t\r");
+    return text.substr(begin, end - begin + 1);
+}
+
+int load_config_file(const string& path, PipelineConfig& config, ParseState& state, string& error) {
+    if (state.depth >= MAX_CONFIG_DEPTH) {
+        error = "config files nested too deeply at " + path;
+        return PIPELINE_ERROR_INVALID_INPUT;
+    }
+    ifstream in(path);
+    if (!in.is_open()) {
+        error = "cannot open config file " + path;
+        return PIPELINE_ERROR_IO;
+    }
+
+    ++state.depth;
+    string line;
+    int lineNumber = 0;
+    int status = PIPELINE_SUCCESS;
+    while (status == PIPELINE_SUCCESS && getline(in, line)) {
+        ++lineNumber;
+        const size_t hash = line.find('#');
+        if (hash != string::npos) line.resize(hash);
+        line = trim(line);
+        if (line.empty()) continue;
+
+        const size_t eq = line.find('=');
+        const string key = trim(line.substr(0, eq));
+        const string value = eq == string::npos ? string() : trim(line.substr(eq + 1));
+        status = apply_option(key, value, eq != string::npos, config, state, error);
+        if (status != PIPELINE_SUCCESS) {
+            error = path + ":" + to_string(lineNumber) + ": " + error;
+        }
+    }
+    --state.depth;
+    return status;
+}
+
+string join_path(const string& dir, const string& name) {
+    return dir.empty() ? name : (fs::path(dir) / name).string();
+}
+
+// Threshold as it appears in default file names ("5000", "2500.5")
+string threshold_label(double threshold_m) {
+    char text[32];
+    snprintf(text, sizeof(text), "%g", threshold_m);
+    return text;
+}
+
+bool validate_config(const PipelineConfig& config, string& error) {
+    if (config.catalogs.empty()) {
+        error = "no input catalogs";
+        return false;
+    }
+    if (config.jobs.empty()) {
+        error = "no screening thresholds";
+        return false;
+    }
+    if (!(config.stepSeconds > 0.0) || !(config.durationHours > 0.0) || !(config.horizonHours > 0.0)) {
+        error = "step, hours and horizon must be positive";
+        return false;
+    }
+    for (const ScreeningJob& job : config.jobs) {
+        if (!(job.threshold_m > 0.0) || !std::isfinite(job.threshold_m)) {
+            error = "thresholds must be positive";
+            return false;
+        }
+    }
+    if (config.daemon && config.jobs.size() != 1) {
+        error = "--daemon screens a single threshold";
+        return false;
+    }
+    if (config.daemon && config.allPasses) {
+        error = "--all-passes applies to the batch run only";
+        return false;
+    }
+    if (config.shardBlocks > 1 && (config.daemon || config.allPasses)) {
+        error = "--shards runs first-pass batch screening only";
+        return false;
+    }
+    if (config.lazyCacheMB && (config.daemon || config.allPasses || config.shardBlocks > 1)) {
+        error = "--lazy-cache runs first-pass batch screening only";
+        return false;
+    }
+    if (config.compactStore && (config.daemon || config.allPasses || config.shardBlocks > 1 ||
+                                config.lazyCacheMB)) {
+        error = "--compact-store runs first-pass batch screening only";
+        return false;
+    }
+    if ((config.topRisks || config.minProbability > 0.0) && (config.daemon || config.allPasses)) {
+        error = "--top and --min-pc rank first-pass batch screening only";
+        return false;
+    }
+    if (config.minProbability > 0.0 && !(config.probability && config.refineTca)) {
+        error = "--min-pc needs collision probability (drop --no-pc and --no-refine)";
+        return false;
+    }
+    if (config.lazyCacheMB && config.writeTracks) {
+        error = "--lazy-cache never holds every track; add --no-tracks";
+        return false;
+    }
+    if (!config.shardTask.empty() && config.shardBlocks < 2) {
+        error = "--shard-task needs --shards";
+        return false;
+    }
+    for (size_t a = 0; a < config.jobs.size(); ++a) {
+        for (size_t b = a + 1; b < config.jobs.size(); ++b) {
+            if (pipeline_conjunctions_path(config, a) == pipeline_conjunctions_path(config, b)) {
+                error = "two thresholds write " + pipeline_conjunctions_path(config, a);
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+// Parent directories of an output file
+void make_parent_dirs(const string& path) {
+    const fs::path parent = fs::path(path).parent_path();
+    if (parent.empty()) return;
+    error_code ec;
+    fs::create_directories(parent, ec);
+}
+
+} // namespace
+
+int parse_pipeline_args(int argc, const char* const* argv, PipelineConfig& config, string& error) {
+    ParseState state;
+    for (int a = 0; a < argc; ++a) {
+        const string arg = argv[a];
+        if (arg.size() < 3 || arg.compare(0, 2, "--") != 0) {
+            error = "unexpected argument " + arg;
+            return PIPELINE_ERROR_INVALID_INPUT;
+        }
+
+        // --name=value or --name [value]
+        string name = arg.substr(2);
+        string value;
+        bool hasValue = false;
+        const size_t eq = name.find('=');
+        if (eq != string::npos) {
+            value = name.substr(eq + 1);
+            name.resize(eq);
+            hasValue = true;
+        } else if (const OptionSpec* spec = find_option(name)) {
+            const bool next = a + 1 < argc;
+            const bool nextIsOption = next && strncmp(argv[a + 1], "--", 2) == 0;
+            if (spec->arity == OPTION_VALUE && next) {
+                value = argv[++a];
+                hasValue = true;
+            } else if (spec->arity == OPTION_OPTIONAL && next && !nextIsOption) {
+                value = argv[++a];
+                hasValue = true;
+            }
+        }
+
+        const int status = apply_option(name, value, hasValue, config, state, error);
+        if (status != PIPELINE_SUCCESS) return status;
+    }
+    return validate_config(config, error) ? PIPELINE_SUCCESS : PIPELINE_ERROR_INVALID_INPUT;
+}
+
+int load_pipeline_config(const string& path, PipelineConfig& config, string& error) {
+    ParseState state;
+    const int status = load_config_file(path, config, state, error);
+    if (status != PIPELINE_SUCCESS) return status;
+    return validate_config(config, error) ? PIPELINE_SUCCESS : PIPELINE_ERROR_INVALID_INPUT;
+}
+
+int write_pipeline_config(const string& path, const PipelineConfig& config) {
+    ofstream out(path, ios::trunc);
+    if (!out.is_open()) return PIPELINE_ERROR_IO;
+    auto number = [](double v) {
+        char text[40];
+        snprintf(text, sizeof(text), "%.17g", v);
+        return string(text);
+    };
+    auto flag = [](bool v) { return v ? "true" : "false"; };
+
+    for (const CatalogInput& input : config.catalogs) {
+        out << (input.isDebris ? "debris = " : "satellites = ") << input.path << "\n";
+    }
+    out << "epoch = " << number(config.startEpochMs) << "\n"
+        << "step = " << number(config.stepSeconds) << "\n"
+        << "hours = " << number(config.durationHours) << "\n";
+    for (const ScreeningJob& job : config.jobs) {
+        out << "threshold = " << number(job.threshold_m) << "\n";
+        if (!job.conjunctionsPath.empty()) out << "conjunctions = " << job.conjunctionsPath << "\n";
+    }
+    out << "output-dir = " << config.outputDir << "\n";
+    if (!config.cachePath.empty()) out << "cache = " << config.cachePath << "\n";
+    out << "no-cache = " << flag(!config.useCache) << "\n"
+        << "no-tracks = " << flag(!config.writeTracks) << "\n"
+        << "track-stride = " << config.trackJsonStride << "\n"
+        << "no-prefilter = " << flag(!config.prefilter) << "\n"
+        << "no-refine = " << flag(!config.refineTca) << "\n"
+        << "no-pc = " << flag(!config.probability) << "\n"
+        << "all-passes = " << flag(config.allPasses) << "\n"
+        << "lazy-cache = " << config.lazyCacheMB << "\n"
+        << "compact-store = " << flag(config.compactStore) << "\n"
+        << "top = " << config.topRisks << "\n"
+        << "min-pc = " << number(config.minProbability) << "\n"
+        << "threads = " << config.threads << "\n";
+    if (config.daemon) out << "daemon = true\nhorizon = " << number(config.horizonHours) << "\n";
+    if (!config.profilePrefix.empty()) out << "profile = " << config.profilePrefix << "\n";
+    if (config.shardBlocks) out << "shards = " << config.shardBlocks << "\n";
+    if (!config.shardDir.empty()) out << "shard-dir = " << config.shardDir << "\n";
+    if (!config.shardLauncher.empty()) out << "shard-launcher = " << config.shardLauncher << "\n";
+    if (config.shardParallel) out << "shard-parallel = " << config.shardParallel << "\n";
+    out.flush();
+    return out ? PIPELINE_SUCCESS : PIPELINE_ERROR_IO;
+}
+
+string pipeline_usage(const char* program) {
+    string text = string("Usage: ") + program + " [options]\n\nOptions:\n";
+    for (const OptionSpec& spec : OPTIONS) {
+        string left = string("  --") + spec.name;
+        if (*spec.arg) left += string(" ") + spec.arg;
+        left.resize(max<size_t>(left.size() + 1, 26), ' ');
+        text += left + spec.help + "\n";
+    }
+    text += "\nConfig files take the same options as \"name = value\" lines.\n";
+    return text;
+}
+
+string pipeline_conjunctions_path(const PipelineConfig& config, size_t job) {
+    const ScreeningJob& j = config.jobs[job];
+    if (!j.conjunctionsPath.empty()) return j.conjunctionsPath;
+    if (config.jobs.size() == 1) return join_path(config.outputDir, "conjunctions.json");
+    return join_path(config.outputDir, "conjunctions_" + threshold_label(j.threshold_m) + "m.json");
+}
+
+string pipeline_cache_path(const PipelineConfig& config) {
+    if (!config.useCache) return string();
+    return config.cachePath.empty() ? join_path(config.outputDir, "ephemeris_cache.bin")
+                                    : config.cachePath;
+}
+
+string pipeline_shard_dir(const PipelineConfig& config) {
+    return config.shardDir.empty() ? join_path(config.outputDir, "shards") : config.shardDir;
+}
+
+void pipeline_screening_options(const PipelineConfig& config, PcOptions& probability,
+                                ScreeningOptions& out) {
+    // Refine each flagged pass to its true closest approach; the margin keeps
+    // passes that only dip under the threshold between samples
+    out = ScreeningOptions();
+    out.threads = config.threads;
+    out.refineTca = config.refineTca;
+    out.refineMargin_m = config.refineTca ? refine_margin_for_step(config.stepSeconds) : 0.0;
+    probability = PcOptions();
+    probability.threads = config.threads;
+    if (config.probability && config.refineTca) out.probability = &probability;
+}
+
+bool pipeline_prefilter(const PipelineConfig& config, const vector<OrbitalElements>& elements,
+                        PairPrefilter& out) {
+    if (!config.prefilter) return false;
+
+    // A prefilter for the largest threshold keeps every pair a smaller one can flag
+    double maxThreshold_m = 0.0;
+    for (const ScreeningJob& job : config.jobs) maxThreshold_m = max(maxThreshold_m, job.threshold_m);
+    if (build_pair_prefilter(elements, config.startEpochMs, config.durationHours,
+                             maxThreshold_m + PREFILTER_PAD_M, out) != PREFILTER_SUCCESS) {
+        return false;
+    }
+    cout << "Prefilter: " << out.stats.pairs << " pairs, "
+         << out.stats.apsis << " after apogee/perigee, "
+         << out.stats.orbitPath << " after orbit path" << endl;
+    return true;
+}
+
+bool pipeline_rank_encounters(const PipelineConfig& config, vector<Encounter>& encounters) {
+    if (config.topRisks) {
+        // Risk ties keep their input order; time order makes that independent
+        // of how the screen (or a sharded merge) collected them
+        sort_encounters_by_time(encounters.data(), encounters.size(), config.threads);
+        encounters = top_encounters_by_risk(encounters.data(), encounters.size(), config.topRisks,
+                                            config.minProbability, config.threads);
+        return true;
+    }
+    encounters.resize(filter_by_probability(encounters.data(), encounters.size(), config.minProbability));
+    return false;
+}
+
+namespace {
+
+// Batch run over a lazy ephemeris: one screen_lazy pass per job, sharing the cache
+int run_lazy_jobs(const PipelineConfig& config, const PipelineCatalog& catalog) {
+    LazyEphemeris eph;
+    if (lazy_ephemeris_open(eph, catalog, config.startEpochMs, config.stepSeconds,
+                            config.durationHours, config.lazyCacheMB << 20) != LAZY_EPHEMERIS_SUCCESS) {
+        return PIPELINE_ERROR_INVALID_INPUT;
+    }
+    if (eph.count == 0) {
+        cout << "No satellite tracks generated." << endl;
+        return PIPELINE_ERROR_NO_OBJECTS;
+    }
+    const size_t chunkBytes = eph.chunkSteps * STORE_COMPONENTS * sizeof(double);
+    if (eph.maxChunks < eph.count && (config.refineTca || config.jobs.size() > 1)) {
+        // Refined pairs and later jobs read tracks back through the cache
+        cout << "Warning: --lazy-cache " << config.lazyCacheMB << " holds " << eph.maxChunks
+             << " of " << eph.count << " objects' chunks; refinement and later jobs will"
+             << " re-propagate (one chunk per object needs "
+             << (eph.count * chunkBytes + (1 << 20) - 1) / (1 << 20) << " MB)" << endl;
+    }
+
+    ScreeningOptions screening;
+    PcOptions probability;
+    pipeline_screening_options(config, probability, screening);
+    PairPrefilter prefilter;
+    if (pipeline_prefilter(config, catalog.elements, prefilter)) screening.prefilter = &prefilter;
+
+    for (size_t j = 0; j < config.jobs.size(); ++j) {
+        const string path = pipeline_conjunctions_path(config, j);
+        vector<Encounter> encounters = screen_lazy(eph, config.jobs[j].threshold_m, screening);
+        const bool ranked = pipeline_rank_encounters(config, encounters);
+        make_parent_dirs(path);
+        if (!writeEncountersJSON(path, encounters, eph.ids, eph.times.front(), eph.times.back(),
+                                 !ranked)) {
+            return PIPELINE_ERROR_IO;
+        }
+        cout << "Wrote " << encounters.size() << " conjunctions to " << path << endl;
+    }
+    cout << "Lazy ephemeris: " << eph.stats.misses << " chunks propagated, " << eph.stats.hits
+         << " cache hits, peak " << eph.stats.peakChunks * chunkBytes / 1000000.0 << " MB of "
+         << eph.count * ((eph.steps + eph.chunkSteps - 1) / eph.chunkSteps) * chunkBytes / 1000000.0
+         << " MB" << endl;
+    return PIPELINE_SUCCESS;
+}
+
+// Batch run over a mixed-precision store: tracks exported from the float
+// planes, then one screen_compact pass per job
+int run_compact_jobs(const PipelineConfig& config, const PipelineCatalog& catalog) {
+    CompactStore compact;
+    if (compact_store_propagate(catalog, config.startEpochMs, config.stepSeconds,
+                                config.durationHours, compact, config.threads) != COMPACT_STORE_SUCCESS) {
+        return PIPELINE_ERROR_INVALID_INPUT;
+    }
+    if (compact.count == 0) {
+        cout << "No satellite tracks generated." << endl;
+        return PIPELINE_ERROR_NO_OBJECTS;
+    }
+    cout << "Generated " << compact.count << " total trajectories ("
+         << compact.data.size() * sizeof(float) / 1000000.0 << " MB of float32 states, within "
+         << compact.error_m << " m)" << endl;
+
+    if (config.writeTracks) {
+        const string json = join_path(config.outputDir, "coordinates.json");
+        const string blob = join_path(config.outputDir, "coordinates.bin");
+        make_parent_dirs(json);
+        TrackExportOptions jsonExport;
+        jsonExport.stride = config.trackJsonStride;
+        if (write_tracks_json(json, compact, jsonExport) != TRACK_EXPORT_SUCCESS ||
+            write_tracks_blob(blob, compact) != TRACK_EXPORT_SUCCESS) {
+            cout << "Could not write " << json << " / " << blob << endl;
+            return PIPELINE_ERROR_IO;
+        }
+    }
+
+    ScreeningOptions screening;
+    PcOptions probability;
+    pipeline_screening_options(config, probability, screening);
+    PairPrefilter prefilter;
+    if (pipeline_prefilter(config, catalog.elements, prefilter)) screening.prefilter = &prefilter;
+
+    for (size_t j = 0; j < config.jobs.size(); ++j) {
+        const string path = pipeline_conjunctions_path(config, j);
+        vector<Encounter> encounters = screen_compact(compact, config.jobs[j].threshold_m, screening);
+        const bool ranked = pipeline_rank_encounters(config, encounters);
+        make_parent_dirs(path);
+        if (!writeEncountersJSON(path, encounters, compact.ids, compact.times.front(),
+                                 compact.times.back(), !ranked)) {
+            return PIPELINE_ERROR_IO;
+        }
+        cout << "Wrote " << encounters.size() << " conjunctions to " << path << endl;
+    }
+    return PIPELINE_SUCCESS;
+}
+
+} // namespace
+
+int run_pipeline(const PipelineConfig& config) {
+    NOVA_SCOPE("run_pipeline");
+    string error;
+    if (!validate_config(config, error)) {
+        cout << "Invalid configuration: " << error << endl;
+        return PIPELINE_ERROR_INVALID_INPUT;
+    }
+
+    PipelineCatalog catalog;
+    if (load_catalog_inputs(config.catalogs, catalog) != PROPAGATION_SUCCESS) {
+        cout << "Could not open every input catalog" << endl;
+        return PIPELINE_ERROR_IO;
+    }
+    size_t debris = 0;
+    for (bool d : catalog.isDebris) debris += d ? 1 : 0;
+    cout << "Loaded " << catalog.ids.size() << " objects (" << catalog.ids.size() - debris
+         << " satellites + " << debris << " debris) from " << config.catalogs.size()
+         << " catalogs" << endl;
+
+    if (config.lazyCacheMB) return run_lazy_jobs(config, catalog);
+    if (config.compactStore) return run_compact_jobs(config, catalog);
+
+    // One propagation (or cache read) shared by every output and screening job
+    const string cachePath = pipeline_cache_path(config);
+    if (!cachePath.empty()) make_parent_dirs(cachePath);
+    TrajectoryStore store;
+    if (propagate_catalog_cached(config.catalogs, catalog, config.startEpochMs, config.stepSeconds,
+                                 config.durationHours, cachePath, store, config.threads)) {
+        cout << "Loaded " << store.count << " trajectories from ephemeris cache " << cachePath << endl;
+    } else {
+        cout << "Generated " << store.count << " total trajectories" << endl;
+    }
+    if (store.count == 0) {
+        cout << "No satellite tracks generated." << endl;
+        return PIPELINE_ERROR_NO_OBJECTS;
+    }
+
+    // Full time series for the viewer in the blob, every stride-th step in the JSON
+    if (config.writeTracks) {
+        const string json = join_path(config.outputDir, "coordinates.json");
+        const string blob = join_path(config.outputDir, "coordinates.bin");
+        make_parent_dirs(json);
+        TrackExportOptions jsonExport;
+        jsonExport.stride = config.trackJsonStride;
+        if (write_tracks_json(json, store, jsonExport) != TRACK_EXPORT_SUCCESS ||
+            write_tracks_blob(blob, store) != TRACK_EXPORT_SUCCESS) {
+            cout << "Could not write " << json << " / " << blob << endl;
+            return PIPELINE_ERROR_IO;
+        }
+    }
+
+    ScreeningOptions screening;
+    PcOptions probability;
+    pipeline_screening_options(config, probability, screening);
+    PairPrefilter prefilter;
+    if (pipeline_prefilter(config, catalog.elements, prefilter)) screening.prefilter = &prefilter;
+
+    // Every window per pair: one pass per job, they do not share tiers
+    if (config.allPasses) {
+        for (size_t j = 0; j < config.jobs.size(); ++j) {
+            const string path = pipeline_conjunctions_path(config, j);
+            const vector<EncounterPass> passes = screen_passes(store, config.jobs[j].threshold_m, screening);
+            make_parent_dirs(path);
+            if (!writePassesJSON(path, passes, store)) return PIPELINE_ERROR_IO;
+            cout << "Wrote " << passes.size() << " approach windows to " << path << endl;
+        }
+        return PIPELINE_SUCCESS;
+    }
+
+    // One job streams as it screens; several (or a ranked one) share one tiered
+    // pass. Both write a threshold's conjunctions in the same time order.
+    if (config.jobs.size() == 1 && !config.topRisks && !(config.minProbability > 0.0)) {
+        const string path = pipeline_conjunctions_path(config, 0);
+        make_parent_dirs(path);
+        if (!streamConjunctionsJSON(path, store, config.jobs[0].threshold_m, screening)) {
+            return PIPELINE_ERROR_IO;
+        }
+        return PIPELINE_SUCCESS;
+    }
+
+    vector<double> thresholds;
+    for (const ScreeningJob& job : config.jobs) thresholds.push_back(job.threshold_m);
+    vector<EncounterTier> tiers = screen_by_thresholds(store, thresholds, screening);
+    for (size_t j = 0; j < config.jobs.size(); ++j) {
+        const string path = pipeline_conjunctions_path(config, j);
+        const auto tier = find_if(tiers.begin(), tiers.end(), [&](const EncounterTier& t) {
+            return t.threshold_m == config.jobs[j].threshold_m;
+        });
+        if (tier == tiers.end()) return PIPELINE_ERROR_IO;
+        const bool ranked = pipeline_rank_encounters(config, tier->encounters);
+        make_parent_dirs(path);
+        if (!writeEncountersJSON(path, tier->encounters, store.ids, store.time(0),
+                                 store.time(store.steps - 1), !ranked)) {
+            return PIPELINE_ERROR_IO;
+        }
+        cout << "Wrote " << tier->encounters.size() << " conjunctions to " << path << endl;
+    }
+    return PIPELINE_SUCCESS;
+}
@@ -1,118 +1,768 @@
 #include "simplified_core.h"
 #include "types.h"
- 
+#include "propagation.h"
+#include "constants.h"
+#include "parallel.h"
+#include "ephemeris.h"
+#include "instrumentation.h"
+#include <cstdlib>
+#include <cstring>
 
-vector<Trajectory> propagate_coords_only(
-    vector<string>& ids,
-    vector<bool>& isDebrisFlags,
-    double startEpochMs,
-    double stepSeconds,
-    double durationHours) {
-    
-    vector<Trajectory> trajectories;
-    
-    // Load satellite and debris TLE data
+namespace {
+
+// Per-object quantities that do not depend on time
+struct PropagationConstants {
+    double epoch;       // Julian date
+    double a;           // semi-major axis (km)
+    double e;
+    double sqrt1me2;    // sqrt(1 - e^2)
+    double n;           // mean motion (rad/min)
+    double ndot;        // mean motion rate (rad/min^2)
+    double m0;          // mean anomaly at epoch (rad)
+    double raan0, raanDot;  // rad, rad/min (J2 secular)
+    double argp0, argpDot;  // rad, rad/min (J2 secular)
+    double cosi, sini;
+    double vscale;      // sqrt(MU * a), for velocity (km^2/s)
+};
+
+int make_constants(const OrbitalElements* el, PropagationConstants* c) {
+    if (!el || !c) return PROPAGATION_ERROR_INVALID_INPUT;
+    const double e = el->eccentricity;
+    if (!(el->mean_motion > 0.0) || !(e >= 0.0) || !(e < 1.0)) {
+        return PROPAGATION_ERROR_INVALID_INPUT;
+    }
+
+    c->epoch = el->epoch;
+    c->e = e;
+    c->sqrt1me2 = sqrt(1.0 - e * e);
+    c->n = el->mean_motion * TWO_PI / MINUTES_PER_DAY;
+    c->ndot = el->ndot * TWO_PI / (MINUTES_PER_DAY * MINUTES_PER_DAY);
+    c->m0 = el->mean_anomaly;
+    c->cosi = cos(el->inclination);
+    c->sini = sin(el->inclination);
+
+    const double nSec = c->n / 60.0;
+    c->a = cbrt(MU / (nSec * nSec));
+    c->vscale = sqrt(MU * c->a);
+
+    // J2 secular drift of the node and perigee
+    const double p = c->a * (1.0 - e * e);
+    const double k = 1.5 * J2 * (EARTH_RADIUS / p) * (EARTH_RADIUS / p) * c->n;
+    c->raan0 = el->raan;
+    c->raanDot = -k * c->cosi;
+    c->argp0 = el->arg_perigee;
+    c->argpDot = 0.5 * k * (5.0 * c->cosi * c->cosi - 1.0);
+    return PROPAGATION_SUCCESS;
+}
+
+// Solve Kepler's equation M = E - e sin E (Newton)
+int solve_kepler(double M, double e, double* E_out) {
+    M = fmod(M, TWO_PI);
+    if (M < 0.0) M += TWO_PI;
+    double E = (e < 0.8) ? M : PI;
+    for (int iter = 0; iter < 50; ++iter) {
+        const double f = E - e * sin(E) - M;
+        const double dE = f / (1.0 - e * cos(E));
+        E -= dE;
+        if (fabs(dE) < 1e-12) {
+            *E_out = E;
+            return PROPAGATION_SUCCESS;
+        }
+    }
+    return PROPAGATION_ERROR_CONVERGENCE;
+}
+
+// State at a time after epoch. Without Velocity only the position is
+// computed (the same bits as the full state) and the velocity is NaN.
+template <bool Velocity = true>
+int evaluate(const PropagationConstants& c, double minutes, StateVectorECI* out) {
+    const double M = c.m0 + c.n * minutes + 0.5 * c.ndot * minutes * minutes;
+    double E;
+    const int rc = solve_kepler(M, c.e, &E);
+    if (rc != PROPAGATION_SUCCESS) return rc;
+
+    const double cosE = cos(E), sinE = sin(E);
+
+    // Perifocal position
+    const double xp = c.a * (cosE - c.e);
+    const double yp = c.a * c.sqrt1me2 * sinE;
+
+    const double raan = c.raan0 + c.raanDot * minutes;
+    const double argp = c.argp0 + c.argpDot * minutes;
+    const double cO = cos(raan), sO = sin(raan);
+    const double cw = cos(argp), sw = sin(argp);
+
+    // Perifocal -> ECI basis vectors
+    const double Px = cO * cw - sO * sw * c.cosi;
+    const double Py = sO * cw + cO * sw * c.cosi;
+    const double Pz = sw * c.sini;
+    const double Qx = -cO * sw - sO * cw * c.cosi;
+    const double Qy = -sO * sw + cO * cw * c.cosi;
+    const double Qz = cw * c.sini;
+
+    out->t = c.epoch + minutes / MINUTES_PER_DAY;
+    out->r[0] = xp * Px + yp * Qx;
+    out->r[1] = xp * Py + yp * Qy;
+    out->r[2] = xp * Pz + yp * Qz;
+    if constexpr (Velocity) {
+        // Perifocal velocity
+        const double r = c.a * (1.0 - c.e * cosE);
+        const double vxp = -c.vscale / r * sinE;
+        const double vyp = c.vscale / r * c.sqrt1me2 * cosE;
+        out->v[0] = vxp * Px + vyp * Qx;
+        out->v[1] = vxp * Py + vyp * Qy;
+        out->v[2] = vxp * Pz + vyp * Qz;
+    } else {
+        out->v[0] = out->v[1] = out->v[2] = numeric_limits<double>::quiet_NaN();
+    }
+
+    for (int d = 0; d < 3; ++d) {
+        if (!std::isfinite(out->r[d]) || (Velocity && !std::isfinite(out->v[d]))) {
+            return PROPAGATION_ERROR_NAN_RESULT;
+        }
+    }
+    return PROPAGATION_SUCCESS;
+}
+
+// propagate_grid for one output shape
+template <bool Velocity>
+int grid_states(const OrbitalElements* elements, size_t n, const double* times_jd, size_t m,
+                StateVectorECI* out_states) {
+    int status = PROPAGATION_SUCCESS;
+    for (size_t i = 0; i < n; ++i) {
+        StateVectorECI* row = out_states + i * m;
+        PropagationConstants c;
+        int rc = make_constants(&elements[i], &c);
+        for (size_t j = 0; j < m; ++j) {
+            int srs = rc;
+            if (srs == PROPAGATION_SUCCESS) {
+                srs = evaluate<Velocity>(c, (times_jd[j] - c.epoch) * MINUTES_PER_DAY, &row[j]);
+            }
+            if (srs != PROPAGATION_SUCCESS) {
+                // failed state: emit NaN so screening skips it
+                const double nan = numeric_limits<double>::quiet_NaN();
+                row[j].t = times_jd[j];
+                for (int d = 0; d < 3; ++d) { row[j].r[d] = nan; row[j].v[d] = nan; }
+                if (status == PROPAGATION_SUCCESS) status = srs;
+            }
+        }
+    }
+    return status;
+}
+
+// Propagate object i of the store over steps [firstStep, endStep) of its time
+// grid (minutesJd[k] is the Julian date of sample k); failed states are NaN
+int fill_object(const OrbitalElements& el, size_t i, const vector<double>& minutesJd,
+                size_t firstStep, size_t endStep, TrajectoryStore& store) {
+    const double nan = numeric_limits<double>::quiet_NaN();
+    PropagationConstants c;
+    const int rc = make_constants(&el, &c);
+    int status = PROPAGATION_SUCCESS;
+    for (size_t k = firstStep; k < endStep; ++k) {
+        StateVectorECI sv;
+        int srs = rc;
+        if (srs == PROPAGATION_SUCCESS) {
+            srs = evaluate(c, (minutesJd[k] - c.epoch) * MINUTES_PER_DAY, &sv);
+        }
+        if (srs != PROPAGATION_SUCCESS) {
+            for (int d = 0; d < 3; ++d) { sv.r[d] = nan; sv.v[d] = nan; }
+            if (status == PROPAGATION_SUCCESS) status = srs;
+        }
+        store.row(STORE_X, k)[i] = sv.r[0];
+        store.row(STORE_Y, k)[i] = sv.r[1];
+        store.row(STORE_Z, k)[i] = sv.r[2];
+        store.row(STORE_VX, k)[i] = sv.v[0];
+        store.row(STORE_VY, k)[i] = sv.v[1];
+        store.row(STORE_VZ, k)[i] = sv.v[2];
+    }
+    return status;
+}
+
+// Objects per work item, so concurrent writers rarely share a cache line of a row
+const size_t OBJECT_CHUNK = 64;
+
+// Bounded copy of a field into a NUL-terminated scratch buffer (fields are
+// never NUL-terminated inside a mapped catalog)
+size_t field_copy(const char* p, size_t n, char* buf, size_t cap) {
+    if (n + 1 > cap) n = cap - 1;
+    memcpy(buf, p, n);
+    buf[n] = '\0';
+    return n;
+}
+
+// Parse a number from p[0..n); returns false when it holds no number
+bool field_value(const char* p, size_t n, double* out) {
+    char buf[32];
+    field_copy(p, n, buf, sizeof(buf));
+    char* endp = nullptr;
+    *out = strtod(buf, &endp);
+    return endp != buf;
+}
+
+// Parse a fixed-column field; returns false when the columns are blank
+bool column_value(const char* line, size_t len, size_t begin, size_t end, double* out) {
+    if (begin >= len) return false;
+    if (end > len) end = len;
+    return field_value(line + begin, end - begin, out);
+}
+
+// TLE "implied decimal" field, e.g. "-11606-4" -> -0.11606e-4
+double implied_decimal(const char* p, size_t n) {
+    char buf[32];
+    n = field_copy(p, n, buf, sizeof(buf));
+    if (n == 0) return 0.0;
+    size_t pos = 0;
+    double sign = 1.0;
+    if (buf[0] == '-' || buf[0] == '+') {
+        if (buf[0] == '-') sign = -1.0;
+        ++pos;
+    }
+    size_t expPos = pos;
+    while (expPos < n && buf[expPos] != '-' && buf[expPos] != '+') ++expPos;
+    double exponent = (expPos < n) ? atof(buf + expPos) : 0.0;
+    buf[expPos] = '\0';
+    char mant[40] = "0.";
+    strncat(mant, buf + pos, sizeof(mant) - 3);
+    return sign * atof(mant) * pow(10.0, exponent);
+}
+
+// Julian date of 0h on January 1 of a Gregorian year
+double jd_january_first(int year) {
+    const int y = year - 1;
+    const int a = y / 100;
+    const int b = 2 - a + a / 4;
+    return floor(365.25 * (y + 4716)) + floor(30.6001 * 14) + 1 + b - 1524.5;
+}
+
+int two_digit_year(int yy) {
+    return yy < 57 ? 2000 + yy : 1900 + yy;
+}
+
+} // namespace
+
+double unix_ms_to_jd(double unix_ms) {
+    return UNIX_EPOCH_JD + unix_ms / MS_PER_DAY;
+}
+
+double jd_to_unix_ms(double jd) {
+    return (jd - UNIX_EPOCH_JD) * MS_PER_DAY;
+}
+
+int propagate(const OrbitalElements* elements, double minutes_since_epoch, StateVectorECI* out_state) {
+    if (!elements || !out_state) return PROPAGATION_ERROR_INVALID_INPUT;
+    PropagationConstants c;
+    const int rc = make_constants(elements, &c);
+    if (rc != PROPAGATION_SUCCESS) return rc;
+    return evaluate(c, minutes_since_epoch, out_state);
+}
+
+int orbit_geometry(const OrbitalElements* elements, double jd, OrbitGeometry* out) {
+    if (!out) return PROPAGATION_ERROR_INVALID_INPUT;
+    PropagationConstants c;
+    const int rc = make_constants(elements, &c);
+    if (rc != PROPAGATION_SUCCESS) return rc;
+
+    const double minutes = (jd - c.epoch) * MINUTES_PER_DAY;
+    out->a = c.a;
+    out->e = c.e;
+    out->inclination = elements->inclination;
+    out->raan = c.raan0 + c.raanDot * minutes;
+    out->argp = c.argp0 + c.argpDot * minutes;
+    out->raanDot = c.raanDot;
+    out->argpDot = c.argpDot;
+    return PROPAGATION_SUCCESS;
+}
+
+double propagation_step_bound_m(const OrbitalElements* elements, double firstJd, double lastJd,
+                                double stepSeconds) {
+    PropagationConstants c;
+    if (make_constants(elements, &c) != PROPAGATION_SUCCESS) return numeric_limits<double>::infinity();
+
+    // Position is R(t) * p(M(t)): the ellipse point moves at most at its
+    // perigee rate |dp/dM| = a sqrt((1 + e) / (1 - e)) times |dM/dt|, and the
+    // J2 rotation of the orbit adds at most |raanDot| + |argpDot| times the
+    // apogee radius. A chord between samples is no longer than the arc.
+    const double minutes = max(fabs(firstJd - c.epoch), fabs(lastJd - c.epoch)) * MINUTES_PER_DAY;
+    const double meanRate = c.n + fabs(c.ndot) * minutes;
+    const double speed = c.a * sqrt((1.0 + c.e) / (1.0 - c.e)) * meanRate +
+                         (fabs(c.raanDot) + fabs(c.argpDot)) * c.a * (1.0 + c.e); // km/min
+    // Padded for rounding and the Kepler solver tolerance
+    return speed * stepSeconds / 60.0 * 1000.0 * (1.0 + 1e-6) + 1e-3;
+}
+
+int state_to_elements(const StateVectorECI* state, OrbitalElements* out_elements) {
+    if (!state || !out_elements) return PROPAGATION_ERROR_INVALID_INPUT;
+    const double* r = state->r;
+    const double* v = state->v;
+    const double rMag = sqrt(r[0] * r[0] + r[1] * r[1] + r[2] * r[2]);
+    const double v2 = v[0] * v[0] + v[1] * v[1] + v[2] * v[2];
+    const double rv = r[0] * v[0] + r[1] * v[1] + r[2] * v[2];
+    const double h[3] = {r[1] * v[2] - r[2] * v[1], r[2] * v[0] - r[0] * v[2], r[0] * v[1] - r[1] * v[0]};
+    const double hMag = sqrt(h[0] * h[0] + h[1] * h[1] + h[2] * h[2]);
+    const double inv_a = 2.0 / rMag - v2 / MU;
+    if (!(rMag > 0.0) || !(hMag > 0.0) || !(inv_a > 0.0)) return PROPAGATION_ERROR_INVALID_INPUT;
+
+    double ev[3];
+    for (int d = 0; d < 3; ++d) ev[d] = ((v2 - MU / rMag) * r[d] - rv * v[d]) / MU;
+    const double e = sqrt(ev[0] * ev[0] + ev[1] * ev[1] + ev[2] * ev[2]);
+    if (!(e < 1.0)) return PROPAGATION_ERROR_INVALID_INPUT;
+
+    // In-plane basis: ascending node direction (x axis for equatorial orbits)
+    // and the direction 90 deg ahead of it
+    const double inc = acos(max(-1.0, min(1.0, h[2] / hMag)));
+    const double nMag = sqrt(h[0] * h[0] + h[1] * h[1]);
+    const double raan = nMag > 1e-12 * hMag ? atan2(h[0], -h[1]) : 0.0;
+    const double nx = cos(raan), ny = sin(raan);
+    const double m[3] = {-h[2] * ny / hMag, h[2] * nx / hMag, (h[0] * ny - h[1] * nx) / hMag};
+
+    // Argument of latitude, split into perigee and true anomaly (perigee at
+    // the node for circular orbits)
+    const double u = atan2(r[0] * m[0] + r[1] * m[1] + r[2] * m[2], r[0] * nx + r[1] * ny);
+    const double argp = e > 1e-12 ? atan2(ev[0] * m[0] + ev[1] * m[1] + ev[2] * m[2],
+                                          ev[0] * nx + ev[1] * ny)
+                                  : 0.0;
+    const double nu = u - argp;
+    const double E = 2.0 * atan2(sqrt(1.0 - e) * sin(0.5 * nu), sqrt(1.0 + e) * cos(0.5 * nu));
+    double M = fmod(E - e * sin(E), TWO_PI);
+    if (M < 0.0) M += TWO_PI;
+
+    const double a = 1.0 / inv_a;
+    memset(out_elements, 0, sizeof(OrbitalElements));
+    out_elements->semi_major_axis = a;
+    out_elements->eccentricity = e;
+    out_elements->inclination = out_elements->tilt = inc;
+    out_elements->raan = out_elements->node = raan;
+    out_elements->arg_perigee = out_elements->perigee_angle = argp;
+    out_elements->position = nu;
+    out_elements->mean_anomaly = M;
+    out_elements->mean_motion = sqrt(MU / (a * a * a)) * 86400.0 / TWO_PI;
+    out_elements->epoch = out_elements->time = state->t;
+    return PROPAGATION_SUCCESS;
+}
+
+int propagate_grid(const OrbitalElements* elements, size_t n,
+                   const double* times_jd, size_t m, StateVectorECI* out_states, bool velocities) {
+    if ((n && !elements) || (m && !times_jd) || (n && m && !out_states)) {
+        return PROPAGATION_ERROR_INVALID_INPUT;
+    }
+    NOVA_SCOPE("propagate_grid");
+    NOVA_COUNT(COUNTER_STATES_PROPAGATED, n * m);
+    return velocities ? grid_states<true>(elements, n, times_jd, m, out_states)
+                      : grid_states<false>(elements, n, times_jd, m, out_states);
+}
+
+int propagate_batch(const OrbitalElements* elements, size_t n, double t0, double step,
+                    size_t steps, TrajectoryStore& store, unsigned threads) {
+    if (n && !elements) return PROPAGATION_ERROR_INVALID_INPUT;
+    NOVA_SCOPE("propagate_batch");
+    NOVA_COUNT(COUNTER_STATES_PROPAGATED, n * steps);
+    if (store.count != n || store.steps != steps) {
+        store_resize(store, n, steps);
+    }
+
+    vector<double> minutesJd(steps);
+    for (size_t k = 0; k < steps; ++k) {
+        store.times[store.slot(k)] = t0 + k * step * 1000.0;
+        minutesJd[k] = unix_ms_to_jd(store.time(k));
+    }
+
+    atomic<int> status{PROPAGATION_SUCCESS};
+    parallel_for_chunks(n, OBJECT_CHUNK, threads, [&](unsigned, size_t begin, size_t end) {
+        for (size_t i = begin; i < end; ++i) {
+            const int rc = fill_object(elements[i], i, minutesJd, 0, steps, store);
+            if (rc != PROPAGATION_SUCCESS) {
+                int expected = PROPAGATION_SUCCESS;
+                status.compare_exchange_strong(expected, rc);
+            }
+        }
+    });
+    return status.load();
+}
+
+int propagate_objects(const OrbitalElements* elements, const uint32_t* indices, size_t m,
+                      TrajectoryStore& store, unsigned threads) {
+    if (m && (!elements || !indices)) return PROPAGATION_ERROR_INVALID_INPUT;
+    for (size_t o = 0; o < m; ++o) {
+        if (indices[o] >= store.count) return PROPAGATION_ERROR_INVALID_INPUT;
+    }
+    NOVA_SCOPE("propagate_objects");
+    NOVA_COUNT(COUNTER_STATES_PROPAGATED, m * store.steps);
+
+    vector<double> minutesJd(store.steps);
+    for (size_t k = 0; k < store.steps; ++k) minutesJd[k] = unix_ms_to_jd(store.time(k));
+
+    atomic<int> status{PROPAGATION_SUCCESS};
+    parallel_for_chunks(m, 1, threads, [&](unsigned, size_t begin, size_t end) {
+        for (size_t o = begin; o < end; ++o) {
+            const int rc = fill_object(elements[o], indices[o], minutesJd, 0, store.steps, store);
+            if (rc != PROPAGATION_SUCCESS) {
+                int expected = PROPAGATION_SUCCESS;
+                status.compare_exchange_strong(expected, rc);
+            }
+        }
+    });
+    return status.load();
+}
+
+int propagate_steps(const OrbitalElements* elements, size_t n, size_t firstStep, size_t endStep,
+                    TrajectoryStore& store, unsigned threads) {
+    if (n && !elements) return PROPAGATION_ERROR_INVALID_INPUT;
+    if (n != store.count || firstStep > endStep || endStep > store.steps) {
+        return PROPAGATION_ERROR_INVALID_INPUT;
+    }
+    NOVA_SCOPE("propagate_steps");
+    NOVA_COUNT(COUNTER_STATES_PROPAGATED, n * (endStep - firstStep));
+
+    vector<double> minutesJd(store.steps);
+    for (size_t k = firstStep; k < endStep; ++k) minutesJd[k] = unix_ms_to_jd(store.time(k));
+
+    atomic<int> status{PROPAGATION_SUCCESS};
+    parallel_for_chunks(n, OBJECT_CHUNK, threads, [&](unsigned, size_t begin, size_t end) {
+        for (size_t i = begin; i < end; ++i) {
+            const int rc = fill_object(elements[i], i, minutesJd, firstStep, endStep, store);
+            if (rc != PROPAGATION_SUCCESS) {
+                int expected = PROPAGATION_SUCCESS;
+                status.compare_exchange_strong(expected, rc);
+            }
+        }
+    });
+    return status.load();
+}
+
+uint32_t tle_catalog_number(const char* line1, size_t len) {
+    // Columns 3-7 of line 1, possibly space padded
+    uint32_t number = 0;
+    bool digits = false;
+    for (size_t c = 2; c < 7 && c < len; ++c) {
+        if (line1[c] >= '0' && line1[c] <= '9') {
+            number = number * 10 + static_cast<uint32_t>(line1[c] - '0');
+            digits = true;
+        } else if (line1[c] != ' ' || digits) {
+            return 0;
+        }
+    }
+    return number;
+}
+
+int tle_to_elements(const TLE* tle, OrbitalElements* out) {
+    if (!tle) return PROPAGATION_ERROR_INVALID_INPUT;
+    return tle_lines_to_elements(tle->line1, strlen(tle->line1),
+                                 tle->line2, strlen(tle->line2), out);
+}
+
+int tle_view_to_elements(const TLEView* view, OrbitalElements* out) {
+    if (!view) return PROPAGATION_ERROR_INVALID_INPUT;
+    return tle_lines_to_elements(view->line1, view->line1Len,
+                                 view->line2, view->line2Len, out);
+}
+
+int tle_lines_to_elements(const char* line1, size_t len1,
+                          const char* line2, size_t len2, OrbitalElements* out) {
+    if (!line1 || !line2 || !out) return PROPAGATION_ERROR_INVALID_INPUT;
+    if (len1 == 0 || len2 == 0 || line1[0] != '1' || line2[0] != '2') return PROPAGATION_ERROR_INVALID_INPUT;
+    memset(out, 0, sizeof(OrbitalElements));
+
+    // Line 1: tokens after the catalog number; the epoch is the first one with a '.'
+    const size_t MAX_TOKENS = 12;
+    const char* tok[MAX_TOKENS];
+    size_t tokLen[MAX_TOKENS];
+    size_t ntok = 0;
+    for (size_t p = 0; p < len1 && ntok < MAX_TOKENS;) {
+        while (p < len1 && line1[p] == ' ') ++p;
+        const size_t start = p;
+        while (p < len1 && line1[p] != ' ') ++p;
+        if (p > start) {
+            tok[ntok] = line1 + start;
+            tokLen[ntok] = p - start;
+            ++ntok;
+        }
+    }
+    size_t ep = 2;
+    while (ep < ntok && !memchr(tok[ep], '.', tokLen[ep])) ++ep;
+    if (ep >= ntok) return PROPAGATION_ERROR_INVALID_INPUT;
+
+    double epochField;
+    if (!field_value(tok[ep], tokLen[ep], &epochField)) return PROPAGATION_ERROR_INVALID_INPUT;
+    int year;
+    double day;
+    if (epochField >= 1000.0) {
+        const int yy = static_cast<int>(epochField / 1000.0);
+        year = two_digit_year(yy);
+        day = epochField - yy * 1000.0;
+    } else {
+        // Day-of-year only: take the year from the international designator (YYNNNP)
+        if (ep < 3 || tokLen[2] < 2 || !isdigit(static_cast<unsigned char>(tok[2][0])) ||
+            !isdigit(static_cast<unsigned char>(tok[2][1]))) {
+            return PROPAGATION_ERROR_INVALID_INPUT;
+        }
+        year = two_digit_year((tok[2][0] - '0') * 10 + (tok[2][1] - '0'));
+        day = epochField;
+    }
+    out->epoch = jd_january_first(year) + day - 1.0;
+    out->time = out->epoch;
+
+    // TLE carries ndot/2 (rev/day^2) and nddot/6 (rev/day^3)
+    double ndotHalf;
+    if (ep + 1 < ntok && field_value(tok[ep + 1], tokLen[ep + 1], &ndotHalf)) out->ndot = 2.0 * ndotHalf;
+    if (ep + 2 < ntok) out->nddot = 6.0 * implied_decimal(tok[ep + 2], tokLen[ep + 2]);
+    if (ep + 3 < ntok) out->bstar = implied_decimal(tok[ep + 3], tokLen[ep + 3]);
+
+    // Line 2: standard fixed columns
+    double inc, raan, ecc, argp, ma, mm;
+    if (!column_value(line2, len2, 8, 16, &inc) || !column_value(line2, len2, 17, 25, &raan) ||
+        !column_value(line2, len2, 26, 33, &ecc) || !column_value(line2, len2, 34, 42, &argp) ||
+        !column_value(line2, len2, 43, 51, &ma) || !column_value(line2, len2, 52, 63, &mm)) {
+        return PROPAGATION_ERROR_INVALID_INPUT;
+    }
+    out->inclination = inc * DEG_TO_RAD;
+    out->tilt = out->inclination;
+    out->raan = raan * DEG_TO_RAD;
+    out->node = out->raan;
+    out->eccentricity = ecc * 1e-7; // implied leading decimal point
+    out->arg_perigee = argp * DEG_TO_RAD;
+    out->perigee_angle = out->arg_perigee;
+    out->mean_anomaly = ma * DEG_TO_RAD;
+    out->mean_motion = mm;
+
+    if (!(mm > 0.0) || out->eccentricity >= 1.0) return PROPAGATION_ERROR_INVALID_INPUT;
+    const double nSec = mm * TWO_PI / SECONDS_PER_DAY;
+    out->semi_major_axis = cbrt(MU / (nSec * nSec));
+
+    // True anomaly at epoch
+    double E;
+    if (solve_kepler(out->mean_anomaly, out->eccentricity, &E) == PROPAGATION_SUCCESS) {
+        const double e = out->eccentricity;
+        out->position = 2.0 * atan2(sqrt(1.0 + e) * sin(E / 2.0), sqrt(1.0 - e) * cos(E / 2.0));
+    }
+    return PROPAGATION_SUCCESS;
+}
+
+namespace {
+
+// Catalog loaded for propagation: ids plus parsed elements, read in place from
+// the mapped file. Unparsable records keep zeroed elements, which the
+// propagator rejects (their states come out NaN and are skipped by screening).
+struct LoadedCatalog {
+    bool opened = false;
+    vector<string> names;
+    vector<uint32_t> catalogNumbers;
+    vector<OrbitalElements> elements;
+};
+
+LoadedCatalog load_catalog(const string& filename) {
+    NOVA_SCOPE("load_catalog");
+    LoadedCatalog out;
+    TLECatalog catalog;
+    if (!open_tle_catalog(filename, catalog, 0)) {
+        cout << "ERROR COULD NOT OPEN" << endl;
+        return out;
+    }
+    out.opened = true;
+
+    const size_t n = catalog.records.size();
+    out.names.resize(n);
+    out.catalogNumbers.resize(n);
+    out.elements.resize(n);
+    atomic<size_t> bad{0};
+    parallel_for_chunks(n, 256, 0, [&](unsigned, size_t begin, size_t end) {
+        for (size_t i = begin; i < end; ++i) {
+            const TLEView& view = catalog.records[i];
+            out.names[i] = tle_view_name(view);
+            out.catalogNumbers[i] = tle_catalog_number(view.line1, view.line1Len);
+            if (tle_view_to_elements(&view, &out.elements[i]) != PROPAGATION_SUCCESS) {
+                memset(&out.elements[i], 0, sizeof(OrbitalElements));
+                bad.fetch_add(1, memory_order_relaxed);
+            }
+        }
+    });
+    if (bad.load()) cout << "Skipped " << bad.load() << " unparsable TLE records" << endl;
+    return out;
+}
+
+// Input catalogs
+const char* SATELLITE_CATALOG = "data/satellites_1000.tle";
+const char* DEBRIS_CATALOG = "data/debris_3000.tle";
+
+// Load satellite and debris TLE data
+void load_catalogs(LoadedCatalog& satellites, LoadedCatalog& debris) {
     cout << "Loading satellite TLE data..." << endl;
-    vector<TLE> satellites = parseTLEfile("data/satellites_1000.tle");
-    cout << "Loaded " << satellites.size() << " satellites" << endl;
-    
+    satellites = load_catalog(SATELLITE_CATALOG);
+    cout << "Loaded " << satellites.names.size() << " satellites" << endl;
+
     cout << "Loading debris TLE data..." << endl;
-    vector<TLE> debris = parseTLEfile("data/debris_3000.tle");
-    cout << "Loaded " << debris.size() << " debris objects" << endl;
-    
-    // Clear and populate the output vectors
-    ids.clear();
-    isDebrisFlags.clear();
-    
+    debris = load_catalog(DEBRIS_CATALOG);
+    cout << "Loaded " << debris.names.size() << " debris objects" << endl;
+}
+
+// One element table for the whole catalog: satellites first, then debris
+void merge_catalogs(const LoadedCatalog& satellites, const LoadedCatalog& debris,
+                    vector<OrbitalElements>& elements) {
+    elements.clear();
+    elements.reserve(satellites.elements.size() + debris.elements.size());
+    elements.insert(elements.end(), satellites.elements.begin(), satellites.elements.end());
+    elements.insert(elements.end(), debris.elements.begin(), debris.elements.end());
+}
+
+} // namespace
+
+size_t window_steps(double stepSeconds, double durationHours) {
     const double totalMinutes = durationHours * 60.0;
     const double stepMinutes = stepSeconds / 60.0;
-    const int numSteps = static_cast<int>(totalMinutes / stepMinutes) + 1;
-    
-    // Process satellites
-    for (const auto& tle : satellites) {
-        Trajectory traj;
-        traj.id = tle.name;
-        traj.isDebris = false;
-        
-        ids.push_back(tle.name);
-        isDebrisFlags.push_back(false);
-        
-        // Generate simplified orbital trajectory
-        for (int step = 0; step < numSteps; ++step) {
-            State state;
-            state.t = startEpochMs + step * stepMinutes * 60000.0;
-            
-            // Simple circular orbit approximation based on TLE data
-            double timeHours = step * stepMinutes / 60.0;
-            double angle = timeHours * 0.1; // Simplified orbital motion
-            
-            // Vary orbital parameters based on satellite index for visual diversity
-            size_t satIndex = trajectories.size();
-            double radius = 6800.0 + (satIndex % 100) * 10.0; // 6800-7800 km
-            double inclination = (satIndex % 180) * M_PI / 180.0; // 0-179 degrees
-            
-            state.x = radius * cos(angle) * cos(inclination);
-            state.y = radius * sin(angle) * cos(inclination);
-            state.z = radius * sin(inclination) * sin(angle * 0.5);
-            
-            // Simple velocity calculation
-            state.vx = -radius * sin(angle) * 0.1 * cos(inclination);
-            state.vy = radius * cos(angle) * 0.1 * cos(inclination);
-            state.vz = radius * cos(inclination) * 0.05;
-            
-            state.rad = radius;
-            
-            traj.states.push_back(state);
+    const double intervals = totalMinutes / stepMinutes;
+    if (!(stepSeconds > 0.0) || !(durationHours >= 0.0) ||
+        !(intervals < static_cast<double>(MAX_WINDOW_STEPS - 1))) {
+        return 0;
+    }
+    return static_cast<size_t>(static_cast<int>(intervals) + 1);
+}
+
+void load_pipeline_elements(vector<OrbitalElements>& out) {
+    merge_catalogs(load_catalog(SATELLITE_CATALOG), load_catalog(DEBRIS_CATALOG), out);
+}
+
+void load_pipeline_catalog(PipelineCatalog& out) {
+    const LoadedCatalog satellites = load_catalog(SATELLITE_CATALOG);
+    const LoadedCatalog debris = load_catalog(DEBRIS_CATALOG);
+    merge_catalogs(satellites, debris, out.elements);
+
+    out.ids = satellites.names;
+    out.ids.insert(out.ids.end(), debris.names.begin(), debris.names.end());
+    out.isDebris.assign(satellites.names.size(), false);
+    out.isDebris.resize(out.ids.size(), true);
+    out.catalogNumbers = satellites.catalogNumbers;
+    out.catalogNumbers.insert(out.catalogNumbers.end(), debris.catalogNumbers.begin(),
+                              debris.catalogNumbers.end());
+}
+
+vector<CatalogInput> default_catalog_inputs() {
+    return {{SATELLITE_CATALOG, false}, {DEBRIS_CATALOG, true}};
+}
+
+int load_catalog_inputs(const vector<CatalogInput>& inputs, PipelineCatalog& out) {
+    out = PipelineCatalog();
+    for (const CatalogInput& input : inputs) {
+        const LoadedCatalog loaded = load_catalog(input.path);
+        if (!loaded.opened) {
+            out = PipelineCatalog();
+            return PROPAGATION_ERROR_INVALID_INPUT;
         }
-        
-        trajectories.push_back(traj);
-    }
-    
-    // Process debris
-    for (const auto& tle : debris) {
-        Trajectory traj;
-        traj.id = tle.name;
-        traj.isDebris = true;
-        
-        ids.push_back(tle.name);
-        isDebrisFlags.push_back(true);
-        
-        // Generate more chaotic trajectories for debris
-        for (int step = 0; step < numSteps; ++step) {
-            State state;
-            state.t = startEpochMs + step * stepMinutes * 60000.0;
-            
-            double timeHours = step * stepMinutes / 60.0;
-            size_t debrisIndex = trajectories.size() - satellites.size();
-            
-            // More varied orbital parameters for debris
-            double angle = timeHours * (0.05 + (debrisIndex % 50) * 0.002); // Varied orbital periods
-            double radius = 6500.0 + (debrisIndex % 200) * 15.0; // 6500-9500 km
-            double inclination = (debrisIndex % 180) * M_PI / 180.0;
-            double eccentricity = (debrisIndex % 30) * 0.01; // 0-0.3 eccentricity
-            
-            // Elliptical orbit approximation
-            double r = radius * (1 - eccentricity) / (1 + eccentricity * cos(angle));
-            
-            state.x = r * cos(angle) * cos(inclination);
-            state.y = r * sin(angle) * cos(inclination);
-            state.z = r * sin(inclination) * sin(angle * 0.3);
-            
-            // More chaotic velocity for debris
-            state.vx = -r * sin(angle) * (0.05 + eccentricity * 0.02) * cos(inclination);
-            state.vy = r * cos(angle) * (0.05 + eccentricity * 0.02) * cos(inclination);
-            state.vz = r * cos(inclination) * (0.02 + eccentricity * 0.01);
-            
-            state.rad = r;
-            
-            traj.states.push_back(state);
+        out.ids.insert(out.ids.end(), loaded.names.begin(), loaded.names.end());
+        out.isDebris.resize(out.ids.size(), input.isDebris);
+        out.catalogNumbers.insert(out.catalogNumbers.end(), loaded.catalogNumbers.begin(),
+                                  loaded.catalogNumbers.end());
+        out.elements.insert(out.elements.end(), loaded.elements.begin(), loaded.elements.end());
+    }
+    return PROPAGATION_SUCCESS;
+}
+
+int propagate_catalog(const PipelineCatalog& catalog, double startEpochMs, double stepSeconds,
+                      double durationHours, TrajectoryStore& store, unsigned threads) {
+    const size_t n = catalog.elements.size();
+    const size_t steps = window_steps(stepSeconds, durationHours);
+    if (!steps || !std::isfinite(startEpochMs)) return PROPAGATION_ERROR_INVALID_INPUT;
+    store_resize(store, n, steps);
+    for (size_t i = 0; i < n; ++i) {
+        store_add_id(store, i, catalog.ids[i], catalog.isDebris[i]);
+    }
+    propagate_batch(catalog.elements.data(), n, startEpochMs, stepSeconds, steps, store, threads);
+    return PROPAGATION_SUCCESS;
+}
+
+bool propagate_catalog_cached(const vector<CatalogInput>& inputs, const PipelineCatalog& catalog,
+                              double startEpochMs, double stepSeconds, double durationHours,
+                              const string& cachePath, TrajectoryStore& store, unsigned threads) {
+    uint64_t key = 0;
+    if (!cachePath.empty()) {
+        vector<string> paths;
+        for (const CatalogInput& input : inputs) paths.push_back(input.path);
+        key = ephemeris_key(paths, startEpochMs, stepSeconds, durationHours);
+
+        // The key covers file contents only, so ids and kinds come from the catalog
+        if (read_ephemeris(cachePath, store, key) == EPHEMERIS_SUCCESS &&
+            store.count == catalog.elements.size()) {
+            store.index.clear();
+            for (size_t i = 0; i < store.count; ++i) {
+                store_add_id(store, i, catalog.ids[i], catalog.isDebris[i]);
+            }
+            return true;
         }
-        
-        trajectories.push_back(traj);
-    }
-    
-    cout << "Generated " << trajectories.size() << " total trajectories (" 
-          << satellites.size() << " satellites + " << debris.size() << " debris)" << endl;
-    
-    return trajectories;
-}
\ No newline at end of file
+    }
+
+    propagate_catalog(catalog, startEpochMs, stepSeconds, durationHours, store, threads);
+    if (!cachePath.empty() && write_ephemeris(cachePath, store, key) != EPHEMERIS_SUCCESS) {
+        cout << "Could not write ephemeris cache " << cachePath << endl;
+    }
+    return false;
+}
+
+vector<Trajectory> propagate_coords_only(
+    vector<string>& ids,
+    vector<bool>& isDebrisFlags,
+    double startEpochMs,
+    double stepSeconds,
+    double durationHours) {
+
+    // An invalid grid leaves the store empty, so no tracks come back
+    TrajectoryStore store;
+    propagate_coords_only(store, startEpochMs, stepSeconds, durationHours);
+
+    // Populate the output vectors
+    ids = store.ids;
+    isDebrisFlags = store.isDebris;
+
+    return store_to_trajectories(store);
+}
+
+bool propagate_coords_only(
+    TrajectoryStore& store,
+    double startEpochMs,
+    double stepSeconds,
+    double durationHours) {
+
+    const size_t numSteps = window_steps(stepSeconds, durationHours);
+    if (!numSteps) return false;
+
+    LoadedCatalog satellites, debris;
+    load_catalogs(satellites, debris);
+
+    const size_t nSat = satellites.names.size();
+    const size_t nDeb = debris.names.size();
+    vector<OrbitalElements> elements;
+    merge_catalogs(satellites, debris, elements);
+
+    store_resize(store, elements.size(), numSteps);
+    for (size_t i = 0; i < nSat; ++i) {
+        store_add_id(store, i, satellites.names[i], false);
+    }
+    for (size_t d = 0; d < nDeb; ++d) {
+        store_add_id(store, nSat + d, debris.names[d], true);
+    }
+
+    // Kepler + J2 secular propagation over the window, in parallel across objects
+    propagate_batch(elements.data(), elements.size(), startEpochMs, stepSeconds, numSteps, store);
+
+    cout << "Generated " << store.count << " total trajectories ("
+          << nSat << " satellites + " << nDeb << " debris)" << endl;
+    return true;
+}
+
+bool propagate_coords_cached(
+    TrajectoryStore& store,
+    double startEpochMs,
+    double stepSeconds,
+    double durationHours,
+    const string& cachePath) {
+
+    const uint64_t key = ephemeris_key({SATELLITE_CATALOG, DEBRIS_CATALOG},
+                                       startEpochMs, stepSeconds, durationHours);
+    if (read_ephemeris(cachePath, store, key) == EPHEMERIS_SUCCESS) {
+        cout << "Loaded " << store.count << " trajectories from ephemeris cache " << cachePath << endl;
+        return true;
+    }
+
+    if (!propagate_coords_only(store, startEpochMs, stepSeconds, durationHours)) return false;
+    if (write_ephemeris(cachePath, store, key) != EPHEMERIS_SUCCESS) {
+        cout << "Could not write ephemeris cache " << cachePath << endl;
+    }
+    return true;
+}
@@ -0,0 +1,98 @@
+#include "rolling_screen.h"
+#include "instrumentation.h"
+
+namespace {
+
+// Screen passes starting in every step that is not yet screened, keeping the
+// last one back (its passes come with the next advance)
+void screen_new_steps(RollingScreen& window, vector<Encounter>& out) {
+    const TrajectoryStore& store = window.store;
+    const size_t ready = store.steps ? store.steps - 1 : 0;
+    out.clear();
+    if (window.screenedSteps >= ready) return;
+
+    // Passes still open at the end wait for more steps, but only while they
+    // started within the last ROLLING_MAX_HOLD_STEPS; older ones are refined
+    // on what is stored so resume (and each update's work) stays bounded
+    size_t resume = ready;
+    const size_t holdFrom = ready > ROLLING_MAX_HOLD_STEPS ? ready - ROLLING_MAX_HOLD_STEPS : 0;
+    const vector<Encounter> found = screen_step_range(store, window.screenedSteps, ready,
+                                                      window.threshold_m, window.options, &resume,
+                                                      holdFrom);
+    // A pair's passes complete in time order, so a pass screened again is
+    // one at or before the latest reported for its pair
+    for (const Encounter& e : found) {
+        const uint64_t key = pair_key(e.aIndex, e.bIndex, store.count);
+        auto it = window.lastReported.find(key);
+        if (it != window.lastReported.end() && e.t <= it->second) continue;
+        window.lastReported[key] = e.t;
+        out.push_back(e);
+    }
+    window.screenedSteps = resume;
+
+    // Passes screened again start at resume or later, so their closest
+    // approach is after the step before it
+    const double oldest = resume ? store.time(resume - 1) : store.time(0);
+    for (auto it = window.lastReported.begin(); it != window.lastReported.end();) {
+        it = it->second < oldest ? window.lastReported.erase(it) : next(it);
+    }
+}
+
+} // namespace
+
+int rolling_open(RollingScreen& window, const PipelineCatalog& catalog, double startMs,
+                 double stepSeconds, double horizonHours, double threshold_m,
+                 const ScreeningOptions& options, vector<Encounter>& out) {
+    const size_t n = catalog.elements.size();
+    const size_t steps = window_steps(stepSeconds, horizonHours);
+    if (!steps || !(horizonHours > 0.0) || !(threshold_m >= 0.0) ||
+        catalog.ids.size() != n || catalog.isDebris.size() != n) {
+        return ROLLING_ERROR_INVALID_INPUT;
+    }
+
+    store_resize(window.store, n, steps);
+    for (size_t i = 0; i < n; ++i) {
+        store_add_id(window.store, i, catalog.ids[i], catalog.isDebris[i]);
+    }
+    propagate_batch(catalog.elements.data(), n, startMs, stepSeconds, steps,
+                    window.store, options.threads);
+
+    window.elements = catalog.elements;
+    window.stepSeconds = stepSeconds;
+    window.threshold_m = threshold_m;
+    window.options = options;
+    window.options.prefilter = nullptr;
+    window.screenedSteps = 0;
+    window.lastReported.clear();
+    screen_new_steps(window, out);
+    return ROLLING_SUCCESS;
+}
+
+int rolling_advance(RollingScreen& window, double nowMs, vector<Encounter>& out) {
+    NOVA_SCOPE("rolling_advance");
+    TrajectoryStore& store = window.store;
+    out.clear();
+    if (!store.steps) return ROLLING_ERROR_INVALID_INPUT;
+
+    const double stepMs = window.stepSeconds * 1000.0;
+    if (!(nowMs >= store.time(0) + stepMs)) return ROLLING_SUCCESS;
+    const double advance = floor((nowMs - store.time(0)) / stepMs);
+
+    if (advance >= static_cast<double>(store.steps)) {
+        // Jumped past the whole horizon: start over from now
+        const double startMs = store.time(0) + advance * stepMs;
+        store.head = 0;
+        propagate_batch(window.elements.data(), window.elements.size(), startMs,
+                        window.stepSeconds, store.steps, store, window.options.threads);
+        window.screenedSteps = 0;
+        window.lastReported.clear();
+    } else {
+        const size_t dropped = static_cast<size_t>(advance);
+        store_advance(store, dropped);
+        propagate_steps(window.elements.data(), window.elements.size(), store.steps - dropped,
+                        store.steps, store, window.options.threads);
+        window.screenedSteps -= min(window.screenedSteps, dropped);
+    }
+    screen_new_steps(window, out);
+    return ROLLING_SUCCESS;
+}
@@ -1,73 +1,1565 @@
 #include "simplified_core.h"
-#include "types.h" // for severity_to_string
+#include "types.h" // Severity levels
+#include "parallel.h"
+#include "distance_kernel.h"
+#include "tca_refine.h"
+#include "orbit_prefilter.h"
+#include "screening_index.h"
+#include "arena.h"
+#include "collision_probability.h"
+#include "instrumentation.h"
+#include "lazy_ephemeris.h"
+#include "compact_store.h"
+
+uint64_t pair_key(uint32_t i, uint32_t j, size_t n) {
+    return static_cast<uint64_t>(i) * n + j;
+}
+
+// <= 1/3 threshold: High, <= 2/3: Medium, <= threshold: Low, else: None
+int severity_level(double distance_m, double threshold_m) {
+    if (distance_m <= (threshold_m / 3.0)) return HIGH;
+    if (distance_m <= (2.0 * threshold_m / 3.0)) return MEDIUM;
+    if (distance_m <= threshold_m) return LOW;
+    return NONE;
+}
+
+namespace {
+
+// One object binned into the broad-phase grid for the current time step
+typedef ScreeningCell CellEntry;
+
+// Pair that passed the narrow-phase distance test
+struct Hit {
+    uint32_t i, j;
+    uint32_t k;
+    double distance_m;
+};
+
+// Pack signed cell coordinates into one key (21 bits per axis, wrapping).
+// A wrap collision only adds candidates to the narrow phase, it never hides one.
+inline uint64_t cell_key(int64_t cx, int64_t cy, int64_t cz) {
+    const uint64_t mask = (1ull << 21) - 1;
+    return ((static_cast<uint64_t>(cx) & mask) << 42) |
+           ((static_cast<uint64_t>(cy) & mask) << 21) |
+           (static_cast<uint64_t>(cz) & mask);
+}
+
+// Half of the 26-cell neighbourhood plus the cell itself: each unordered pair of
+// adjacent cells is visited exactly once
+const int NEIGHBOUR_OFFSETS[14][3] = {
+    { 0, 0, 0},
+    { 1, 0, 0}, {-1, 1, 0}, { 0, 1, 0}, { 1, 1, 0},
+    {-1,-1, 1}, { 0,-1, 1}, { 1,-1, 1},
+    {-1, 0, 1}, { 0, 0, 1}, { 1, 0, 1},
+    {-1, 1, 1}, { 0, 1, 1}, { 1, 1, 1}
+};
+
+// Positions in cell order, so each cell is contiguous
+template <typename T>
+struct CellCoords {
+    vector<T> x, y, z;
+};
+
+// Per-worker broad-phase scratch and results
+struct ScreenWorker {
+    ScratchArena arena;          // backs hits and found for the whole run
+    vector<CellEntry> cells;
+    CellCoords<double> coords;
+    CellCoords<float> floatCoords; // same, for float stores
+    vector<uint32_t> candidates; // kernel output
+    pmr::vector<Hit> hits{&arena.resource};
+    pmr::unordered_set<uint64_t> found{&arena.resource}; // pairs already reported by this worker
+};
+
+// Empty hits and found and give their arena's blocks back. A monotonic arena
+// never reuses freed nodes, so a worker that clears them between blocks of
+// one run releases the arena instead and stays bounded by its largest block.
+void release_scratch(ScreenWorker& w) {
+    pmr::vector<Hit>(&w.arena.resource).swap(w.hits);
+    pmr::unordered_set<uint64_t>(&w.arena.resource).swap(w.found);
+    w.arena.resource.release();
+}
+
+inline CellCoords<double>& cell_coords(ScreenWorker& w, double) { return w.coords; }
+inline CellCoords<float>& cell_coords(ScreenWorker& w, float) { return w.floatCoords; }
+
+// Bin every object with a finite position into the grid for one time step
+// (of a TrajectoryStore or a CompactStore)
+template <typename Store>
+void bin_step(const Store& store, size_t k, double invCell, vector<CellEntry>& cells) {
+    const auto* xs = store.row(STORE_X, k);
+    const auto* ys = store.row(STORE_Y, k);
+    const auto* zs = store.row(STORE_Z, k);
+    cells.clear();
+    for (size_t i = 0; i < store.count; ++i) {
+        if (!std::isfinite(xs[i]) || !std::isfinite(ys[i]) || !std::isfinite(zs[i])) continue;
+        cells.push_back({cell_key(static_cast<int64_t>(floor(xs[i] * invCell)),
+                                  static_cast<int64_t>(floor(ys[i] * invCell)),
+                                  static_cast<int64_t>(floor(zs[i] * invCell))),
+                         static_cast<uint32_t>(i)});
+    }
+    sort(cells.begin(), cells.end(), [](const CellEntry& a, const CellEntry& b) {
+        return a.key < b.key || (a.key == b.key && a.idx < b.idx);
+    });
+}
+
+// Compile-time shape of a narrow phase: which pair filters it applies.
+// screen_step instantiates one per combination, so the candidate loop of a
+// screen without a prefilter or split carries no test for them. The store
+// type fixes the precision (double or float positions).
+template <bool Prefilter, bool Split>
+struct NarrowPolicy {
+    static constexpr bool prefilter = Prefilter;
+    static constexpr bool split = Split;
+};
+
+// screen_step for one policy
+template <typename Policy, typename Store, typename Record>
+void screen_step_policy(const Store& store, size_t k, double invCell,
+                        double threshold_m, double radius2Km, const PairPrefilter* prefilter,
+                        uint32_t split, ScreenWorker& w, Record& record) {
+    const auto* xs = store.row(STORE_X, k);
+    const auto* ys = store.row(STORE_Y, k);
+    const auto* zs = store.row(STORE_Z, k);
+    typedef remove_cv_t<remove_pointer_t<decltype(xs)>> Scalar;
+    size_t tested = 0;
+    size_t inThreshold = 0;
+
+    // Narrow phase for a kernel candidate: exact distance, first hit per pair
+    auto test_pair = [&](uint32_t a, uint32_t b) {
+        const uint32_t i = a < b ? a : b;
+        const uint32_t j = a < b ? b : a;
+        if constexpr (Policy::split) {
+            if ((i < split) == (j < split)) return;
+        }
+        if constexpr (Policy::prefilter) {
+            if (!prefilter_allows(*prefilter, i, j)) return;
+        }
+
+        // Check threshold (caller-provided threshold may already account for object radii)
+        const double distance_m = separation_m(static_cast<double>(xs[i]) - xs[j],
+                                               static_cast<double>(ys[i]) - ys[j],
+                                               static_cast<double>(zs[i]) - zs[j]);
+        if (distance_m <= threshold_m) {
+            ++inThreshold;
+            record(i, j, distance_m);
+        }
+    };
+
+    // Bin every object into the grid for this time step
+    auto& cells = w.cells;
+    bin_step(store, k, invCell, cells);
+
+    const size_t m = cells.size();
+    CellCoords<Scalar>& sc = cell_coords(w, Scalar());
+    sc.x.resize(m);
+    sc.y.resize(m);
+    sc.z.resize(m);
+    w.candidates.resize(m);
+    for (size_t c = 0; c < m; ++c) {
+        sc.x[c] = xs[cells[c].idx];
+        sc.y[c] = ys[cells[c].idx];
+        sc.z[c] = zs[cells[c].idx];
+    }
+
+    // Squared-distance prefilter (km, no sqrt), padded so it never rejects a
+    // pair the exact test would accept
+    auto probe_range = [&](size_t c, size_t begin, size_t end) {
+        if (begin >= end) return;
+        tested += end - begin;
+        const size_t found = within_radius(sc.x.data() + begin, sc.y.data() + begin,
+                                           sc.z.data() + begin, end - begin,
+                                           sc.x[c], sc.y[c], sc.z[c],
+                                           static_cast<Scalar>(radius2Km), w.candidates.data());
+        for (size_t f = 0; f < found; ++f) {
+            test_pair(cells[c].idx, cells[begin + w.candidates[f]].idx);
+        }
+    };
+
+    // Walk each occupied cell and test it against itself and its forward neighbours
+    size_t runBegin = 0;
+    while (runBegin < m) {
+        const uint64_t key = cells[runBegin].key;
+        size_t runEnd = runBegin + 1;
+        while (runEnd < m && cells[runEnd].key == key) ++runEnd;
+
+        const int64_t cx = static_cast<int64_t>(floor(sc.x[runBegin] * invCell));
+        const int64_t cy = static_cast<int64_t>(floor(sc.y[runBegin] * invCell));
+        const int64_t cz = static_cast<int64_t>(floor(sc.z[runBegin] * invCell));
+
+        for (size_t a = runBegin; a < runEnd; ++a) {
+            probe_range(a, a + 1, runEnd);
+        }
+
+        for (int o = 1; o < 14; ++o) {
+            const uint64_t nkey = cell_key(cx + NEIGHBOUR_OFFSETS[o][0],
+                                           cy + NEIGHBOUR_OFFSETS[o][1],
+                                           cz + NEIGHBOUR_OFFSETS[o][2]);
+            if (nkey == key) continue;
+            auto it = lower_bound(cells.begin(), cells.end(), nkey,
+                                  [](const CellEntry& e, uint64_t v) { return e.key < v; });
+            if (it == cells.end() || it->key != nkey) continue;
+            const size_t nBegin = static_cast<size_t>(it - cells.begin());
+            size_t nEnd = nBegin + 1;
+            while (nEnd < m && cells[nEnd].key == nkey) ++nEnd;
+            for (size_t a = runBegin; a < runEnd; ++a) {
+                probe_range(a, nBegin, nEnd);
+            }
+        }
+        runBegin = runEnd;
+    }
+    NOVA_COUNT(COUNTER_PAIRS_TESTED, tested);
+    NOVA_COUNT(COUNTER_PAIRS_IN_THRESHOLD, inThreshold);
+}
+
+// Grid broad phase plus distance test for one time step; record(i, j, distance_m)
+// receives every pair within threshold (i < j). A non-zero split keeps only
+// pairs with i < split <= j. Float stores use the float kernel and distances
+// of the rounded positions.
+template <typename Store, typename Record>
+void screen_step(const Store& store, size_t k, double invCell,
+                 double threshold_m, double radius2Km, const PairPrefilter* prefilter,
+                 uint32_t split, ScreenWorker& w, Record&& record) {
+    if (prefilter && split) {
+        screen_step_policy<NarrowPolicy<true, true>>(store, k, invCell, threshold_m, radius2Km,
+                                                     prefilter, split, w, record);
+    } else if (prefilter) {
+        screen_step_policy<NarrowPolicy<true, false>>(store, k, invCell, threshold_m, radius2Km,
+                                                      prefilter, split, w, record);
+    } else if (split) {
+        screen_step_policy<NarrowPolicy<false, true>>(store, k, invCell, threshold_m, radius2Km,
+                                                      prefilter, split, w, record);
+    } else {
+        screen_step_policy<NarrowPolicy<false, false>>(store, k, invCell, threshold_m, radius2Km,
+                                                       prefilter, split, w, record);
+    }
+}
+
+// Time steps handed to a worker at a time
+const size_t STEP_CHUNK = 8;
+
+// Grid cell edge and squared prefilter radius (km) for a threshold in metres
+struct ScreenGeometry {
+    double invCell;
+    double radius2Km;
+};
+
+ScreenGeometry screen_geometry(double threshold_m) {
+    // Grid cell edge (km) must be at least the threshold so that any pair within
+    // threshold lands in the same or a neighbouring cell; pad slightly for rounding
+    double cellKm = threshold_m / 1000.0 * (1.0 + 1e-9);
+    if (!(cellKm > 1e-6)) cellKm = 1e-6;
+
+    // Threshold scaled to km once; squared and padded for the SIMD prefilter
+    const double thresholdKm = threshold_m / 1000.0;
+    return {1.0 / cellKm, thresholdKm * thresholdKm * (1.0 + 1e-9)};
+}
+
+uint64_t pair_key(const Hit& hit, size_t n) {
+    return ::pair_key(hit.i, hit.j, n);
+}
+
+// Encounter at the sampled hit; relative speed from the stored velocities
+Encounter make_encounter(const TrajectoryStore& store, const Hit& hit, double threshold_m) {
+    double dv2 = 0.0;
+    for (int c = STORE_VX; c <= STORE_VZ; ++c) {
+        const double* v = store.row(c, hit.k);
+        const double d = v[hit.j] - v[hit.i];
+        dv2 += d * d;
+    }
+
+    Encounter encounter;
+    encounter.t = store.time(hit.k);
+    encounter.miss_m = hit.distance_m;
+    encounter.rel_mps = sqrt(dv2) * 1000.0;
+    encounter.severity = severity_level(hit.distance_m, threshold_m);
+    encounter.aIndex = hit.i;
+    encounter.bIndex = hit.j;
+    return encounter;
+}
+
+
+// Prefilter to apply, if one was given for a catalog of this size (any store
+// with a count: TrajectoryStore, LazyEphemeris, CompactStore)
+template <typename Store>
+const PairPrefilter* active_prefilter(const Store& store, const ScreeningOptions& options) {
+    return options.prefilter && options.prefilter->count == store.count ? options.prefilter : nullptr;
+}
+
+// Append encounters for first hits, in hit order. With refineTca each hit is
+// replaced by the first refined pass within threshold, or dropped if none;
+// hitEnds, if given, bounds the search per hit instead of endStep.
+void build_encounters(const TrajectoryStore& store, const vector<Hit>& hits,
+                      double threshold_m, const ScreeningOptions& options,
+                      unsigned threads, vector<Encounter>& out, size_t endStep = SIZE_MAX,
+                      const vector<uint32_t>* hitEnds = nullptr) {
+    if (!options.refineTca) {
+        out.reserve(out.size() + hits.size());
+        for (const auto& hit : hits) {
+            out.push_back(make_encounter(store, hit, threshold_m));
+        }
+        return;
+    }
+
+    NOVA_SCOPE("refine_tca");
+    const double margin_m = screening_candidate_distance(threshold_m, options) - threshold_m;
+    vector<Encounter> refined(hits.size());
+    vector<char> keep(hits.size(), 0);
+    parallel_for_chunks(hits.size(), 64, threads,
+        [&](unsigned, size_t begin, size_t end) {
+            for (size_t h = begin; h < end; ++h) {
+                const Hit& hit = hits[h];
+                TcaEstimate tca;
+                const size_t last = hitEnds ? (*hitEnds)[h] : endStep;
+                if (!find_first_tca(store, hit.i, hit.j, hit.k, threshold_m, margin_m, tca, last)) continue;
+                Encounter& e = refined[h];
+                e.t = tca.t;
+                e.miss_m = tca.miss_m;
+                e.rel_mps = tca.rel_mps;
+                e.severity = severity_level(tca.miss_m, threshold_m);
+                e.aIndex = hit.i;
+                e.bIndex = hit.j;
+                keep[h] = 1;
+            }
+        });
+    const size_t first = out.size();
+    for (size_t h = 0; h < hits.size(); ++h) {
+        if (keep[h]) out.push_back(std::move(refined[h]));
+    }
+    if (options.probability) {
+        score_encounters(store, out.data() + first, out.size() - first, *options.probability);
+    }
+}
+
+// Worker hit buffers merged into one list in the same (i, j) order as a plain
+// pairwise sweep, keeping the earliest sample when several workers saw a pair
+vector<Hit> merge_first_hits(vector<ScreenWorker>& workers) {
+    size_t total = 0;
+    for (const auto& w : workers) total += w.hits.size();
+    vector<Hit> hits;
+    hits.reserve(total);
+    for (const auto& w : workers) {
+        hits.insert(hits.end(), w.hits.begin(), w.hits.end());
+    }
+
+    sort(hits.begin(), hits.end(), [](const Hit& a, const Hit& b) {
+        if (a.i != b.i) return a.i < b.i;
+        if (a.j != b.j) return a.j < b.j;
+        return a.k < b.k;
+    });
+    hits.erase(unique(hits.begin(), hits.end(), [](const Hit& a, const Hit& b) {
+        return a.i == b.i && a.j == b.j;
+    }), hits.end());
+    return hits;
+}
+
+// Encounters for the first hits of a screen that holds no double store.
+// Each flagged pair gets a two-object store of its own from fill(objects,
+// firstStep, endStep, pair), holding only the steps its encounter reads:
+// refinement looks one sample back, then ahead. isDebris is by object index.
+template <typename Fill>
+void build_pair_encounters(const vector<Hit>& hits, size_t steps, const vector<bool>& isDebris,
+                           double threshold_m, const ScreeningOptions& options,
+                           unsigned threads, Fill&& fill, vector<Encounter>& out) {
+    vector<Encounter> built(hits.size());
+    vector<char> keep(hits.size(), 0);
+    parallel_for_chunks(hits.size(), 16, threads,
+        [&](unsigned, size_t begin, size_t end) {
+            TrajectoryStore pair;
+            ScreeningOptions local = options;
+            local.prefilter = nullptr;
+            local.splitIndex = 0;
+            PcOptions pc;
+            vector<Encounter> one;
+            for (size_t h = begin; h < end; ++h) {
+                const Hit& hit = hits[h];
+                const uint32_t objects[2] = {hit.i, hit.j};
+                const size_t lo = options.refineTca && hit.k > 0 ? hit.k - 1 : hit.k;
+                fill(objects, lo, options.refineTca ? steps : hit.k + 1, pair);
+                if (options.probability) {
+                    // Per-object overrides follow the objects to store indices 0 and 1;
+                    // the seed is shifted so Monte Carlo draws the global pair's streams
+                    const PcOptions& global = *options.probability;
+                    pc = global;
+                    pc.threads = 1;
+                    pc.seed = global.seed ^ (static_cast<uint64_t>(hit.i) << 32 | hit.j) ^ 1u;
+                    if (!global.radii_m.empty()) {
+                        pc.radii_m.clear();
+                        for (uint32_t o : objects) {
+                            pc.radii_m.push_back(o < global.radii_m.size() ? global.radii_m[o]
+                                                 : isDebris[o] ? global.debrisRadius_m
+                                                               : global.satelliteRadius_m);
+                        }
+                    }
+                    if (!global.sigmas.empty()) {
+                        pc.sigmas.clear();
+                        for (uint32_t o : objects) {
+                            pc.sigmas.push_back(o < global.sigmas.size() ? global.sigmas[o]
+                                                : isDebris[o] ? global.debrisSigma
+                                                              : global.satelliteSigma);
+                        }
+                    }
+                    local.probability = &pc;
+                }
+                one.clear();
+                build_encounters(pair, {{0, 1, static_cast<uint32_t>(hit.k - lo), hit.distance_m}},
+                                 threshold_m, local, 1, one);
+                if (one.empty()) continue;
+                built[h] = one[0];
+                built[h].aIndex = hit.i;
+                built[h].bIndex = hit.j;
+                keep[h] = 1;
+            }
+        });
+    for (size_t h = 0; h < hits.size(); ++h) {
+        if (keep[h]) out.push_back(built[h]);
+    }
+}
+
+// Positions of the objects over one chunk of a lazy ephemeris, laid out like
+// store rows (planes of steps x count) so the grid broad phase reads them as
+// it reads a TrajectoryStore. Objects left out are NaN, which binning skips.
+struct LazyChunkRows {
+    size_t count = 0;
+    size_t steps = 0;
+    vector<double> data;
+    const double* row(int c, size_t k) const { return data.data() + (c * steps + k) * count; }
+};
+
+// Gather chunk c of every object, or of those marked in live. Each chunk is
+// asked for once per screen, so a cache smaller than the catalog's chunk row
+// costs no extra propagation here.
+void fill_chunk_rows(LazyEphemeris& eph, size_t c, const vector<char>* live, unsigned threads,
+                     LazyChunkRows& rows) {
+    const size_t first = c * eph.chunkSteps;
+    rows.count = eph.count;
+    rows.steps = min(eph.chunkSteps, eph.steps - first);
+    rows.data.assign(3 * rows.steps * rows.count, numeric_limits<double>::quiet_NaN());
+    parallel_for_chunks(eph.count, 64, threads,
+        [&](unsigned, size_t begin, size_t end) {
+            for (size_t i = begin; i < end; ++i) {
+                if (live && !(*live)[i]) continue;
+                const shared_ptr<const EphemerisChunk> chunk = lazy_chunk(eph, i, c);
+                for (size_t s = 0; s < rows.steps; ++s) {
+                    const double* state = chunk->states.data() + s * STORE_COMPONENTS;
+                    for (int d = 0; d < 3; ++d) {
+                        rows.data[((STORE_X + d) * rows.steps + s) * rows.count + i] = state[STORE_X + d];
+                    }
+                }
+            }
+        });
+}
+
+// Object-major float copy of the positions for pair walks: each object's
+// track is contiguous, so walking a pair streams two arrays instead of
+// touching new store rows at every sample. Also holds how far each object
+// moves between consecutive samples.
+struct PairTracks {
+    size_t steps = 0;
+    vector<float> xyz;    // (i * steps + k) * 3 + c, km
+    vector<double> reach; // per object, largest sampled step (m); +inf if a sample is not finite
+    double error_m = 0.0; // bound on |float distance - exact distance|
+};
+
+void build_pair_tracks(const TrajectoryStore& store, unsigned threads, PairTracks& out) {
+    const size_t steps = store.steps;
+    out.steps = steps;
+    out.xyz.resize(store.count * steps * 3);
+    out.reach.assign(store.count, 0.0);
+    vector<double> extent(store.count, 0.0); // largest |coordinate| (km)
+    parallel_for_chunks(store.count, 64, threads, [&](unsigned, size_t begin, size_t end) {
+        for (size_t k = 0; k < steps; ++k) {
+            const double* xs = store.row(STORE_X, k);
+            const double* ys = store.row(STORE_Y, k);
+            const double* zs = store.row(STORE_Z, k);
+            const double* px = store.row(STORE_X, k ? k - 1 : k);
+            const double* py = store.row(STORE_Y, k ? k - 1 : k);
+            const double* pz = store.row(STORE_Z, k ? k - 1 : k);
+            for (size_t i = begin; i < end; ++i) {
+                float* p = out.xyz.data() + (i * steps + k) * 3;
+                p[0] = static_cast<float>(xs[i]);
+                p[1] = static_cast<float>(ys[i]);
+                p[2] = static_cast<float>(zs[i]);
+                const double d = separation_m(xs[i] - px[i], ys[i] - py[i], zs[i] - pz[i]);
+                if (!std::isfinite(d)) {
+                    out.reach[i] = numeric_limits<double>::infinity();
+                    continue;
+                }
+                if (d > out.reach[i]) out.reach[i] = d;
+                extent[i] = max(extent[i], max(fabs(xs[i]), max(fabs(ys[i]), fabs(zs[i]))));
+            }
+        }
+    });
+
+    // Rounding to float moves each coordinate by at most half an ulp
+    // (|x| * 2^-24); the distance moves by at most the length of the sum of
+    // both objects' error vectors. Padded for the double arithmetic.
+    double maxExtent = 0.0;
+    for (double e : extent) maxExtent = max(maxExtent, e);
+    out.error_m = 2.0 * sqrt(3.0) * maxExtent * ldexp(1.0, -24) * 1000.0 * 1.01 + 1e-6;
+}
+
+// Consecutive samples of one pair within the screening distance
+struct SampleRun {
+    uint32_t i, j;
+    uint32_t first, last; // steps
+    uint32_t closest;     // step of the smallest sampled distance (earliest on ties)
+    double distance_m;
+};
+
+// Screening scratch plus the runs still open (by pair key) and those closed.
+// Workers take chunks in increasing step order, so a run only has to look
+// at the step before; a pair's entry is reused when its next run opens.
+struct PassWorker {
+    ScreenWorker screen;
+    pmr::unordered_map<uint64_t, SampleRun> open{&screen.arena.resource};
+    pmr::vector<SampleRun> closed{&screen.arena.resource};
+};
+
+// Closed runs of every worker, with runs split at chunk boundaries joined
+vector<SampleRun> merge_runs(vector<PassWorker>& workers) {
+    size_t total = 0;
+    for (const auto& w : workers) total += w.closed.size() + w.open.size();
+    vector<SampleRun> runs;
+    runs.reserve(total);
+    for (auto& w : workers) {
+        runs.insert(runs.end(), w.closed.begin(), w.closed.end());
+        for (const auto& entry : w.open) runs.push_back(entry.second);
+    }
+
+    sort(runs.begin(), runs.end(), [](const SampleRun& a, const SampleRun& b) {
+        if (a.i != b.i) return a.i < b.i;
+        if (a.j != b.j) return a.j < b.j;
+        return a.first < b.first;
+    });
+    size_t out = 0;
+    for (size_t r = 0; r < runs.size(); ++r) {
+        SampleRun& prev = runs[out > 0 ? out - 1 : 0];
+        const SampleRun& run = runs[r];
+        if (out > 0 && prev.i == run.i && prev.j == run.j && prev.last + 1 == run.first) {
+            prev.last = run.last;
+            if (run.distance_m < prev.distance_m) {
+                prev.closest = run.closest;
+                prev.distance_m = run.distance_m;
+            }
+            continue;
+        }
+        runs[out++] = run;
+    }
+    runs.resize(out);
+    return runs;
+}
+
+// Approach windows of one run, appended to out
+void run_passes(const TrajectoryStore& store, const SampleRun& run, double threshold_m,
+                double margin_m, bool refine, vector<TcaEstimate>& tcas,
+                vector<EncounterPass>& out) {
+    if (!refine) {
+        const Hit hit = {run.i, run.j, run.closest, run.distance_m};
+        out.push_back({make_encounter(store, hit, threshold_m),
+                       store.time(run.first), store.time(run.last)});
+        return;
+    }
+
+    tcas.clear();
+    find_pass_tcas(store, run.i, run.j, run.first, threshold_m, margin_m, tcas, run.last + 1);
+    const size_t first = out.size();
+    for (const TcaEstimate& tca : tcas) {
+        EncounterPass pass;
+        pass_window(store, run.i, run.j, tca, threshold_m, pass.entry, pass.exit);
+        pass.tca.t = tca.t;
+        pass.tca.miss_m = tca.miss_m;
+        pass.tca.rel_mps = tca.rel_mps;
+        pass.tca.severity = severity_level(tca.miss_m, threshold_m);
+        pass.tca.aIndex = run.i;
+        pass.tca.bIndex = run.j;
+
+        // Two minima with no exit between them are one window
+        if (out.size() > first && pass.entry <= out.back().exit) {
+            EncounterPass& prev = out.back();
+            prev.exit = max(prev.exit, pass.exit);
+            if (pass.tca.miss_m < prev.tca.miss_m) prev.tca = pass.tca;
+            continue;
+        }
+        out.push_back(pass);
+    }
+}
+
+// What risk order compares, plus the encounter's position for ties
+struct RiskKey {
+    double pc;      // -1 for an encounter without a Pc
+    double miss_m;
+    int severity;
+    uint32_t index;
+};
+
+RiskKey risk_key(const Encounter& e, size_t index) {
+    return {std::isnan(e.pc) ? -1.0 : e.pc, e.miss_m, e.severity, static_cast<uint32_t>(index)};
+}
+
+bool risk_before(const RiskKey& a, const RiskKey& b) {
+    if (a.pc != b.pc) return a.pc > b.pc;
+    if (a.severity != b.severity) return a.severity > b.severity;
+    if (a.miss_m != b.miss_m) return a.miss_m < b.miss_m;
+    return a.index < b.index;
+}
+
+struct TimeKey {
+    double t;
+    uint32_t aIndex, bIndex;
+    uint32_t index;
+};
+
+bool time_before(const TimeKey& a, const TimeKey& b) {
+    if (a.t != b.t) return a.t < b.t;
+    if (a.aIndex != b.aIndex) return a.aIndex < b.aIndex;
+    if (a.bIndex != b.bIndex) return a.bIndex < b.bIndex;
+    return a.index < b.index;
+}
+
+bool passes_probability(const Encounter& e, double min_probability) {
+    return min_probability <= 0.0 || e.pc >= min_probability;
+}
+
+// Below this many keys per worker, one std::sort beats splitting the work
+const size_t SORT_RUN = 1 << 14;
+
+// Sort keys with a total order: each worker sorts one run, then runs are
+// merged pairwise, every merge of a round in parallel
+template <typename Key, typename Less>
+void parallel_sort(vector<Key>& keys, unsigned threads, Less less) {
+    const size_t count = keys.size();
+    const size_t runs = min<size_t>(resolve_thread_count(threads), max<size_t>(1, count / SORT_RUN));
+    if (runs <= 1) {
+        sort(keys.begin(), keys.end(), less);
+        return;
+    }
+    vector<size_t> bounds(runs + 1);
+    for (size_t r = 0; r <= runs; ++r) bounds[r] = count * r / runs;
+    parallel_for_chunks(runs, 1, threads, [&](unsigned, size_t begin, size_t end) {
+        for (size_t r = begin; r < end; ++r) {
+            sort(keys.begin() + bounds[r], keys.begin() + bounds[r + 1], less);
+        }
+    });
+
+    vector<Key> merged(count);
+    for (size_t width = 1; width < runs; width *= 2) {
+        const size_t merges = (runs + 2 * width - 1) / (2 * width);
+        parallel_for_chunks(merges, 1, threads, [&](unsigned, size_t begin, size_t end) {
+            for (size_t m = begin; m < end; ++m) {
+                const size_t lo = bounds[2 * width * m];
+                const size_t mid = bounds[min(runs, 2 * width * m + width)];
+                const size_t hi = bounds[min(runs, 2 * width * (m + 1))];
+                merge(keys.begin() + lo, keys.begin() + mid, keys.begin() + mid, keys.begin() + hi,
+                      merged.begin() + lo, less);
+            }
+        });
+        keys.swap(merged);
+    }
+}
+
+// Rewrite encounters in key order
+template <typename Key>
+void apply_key_order(Encounter* encounters, const vector<Key>& keys) {
+    vector<Encounter> sorted(keys.size());
+    for (size_t e = 0; e < keys.size(); ++e) sorted[e] = encounters[keys[e].index];
+    copy(sorted.begin(), sorted.end(), encounters);
+}
+
+} // namespace
+
+double screening_candidate_distance(double threshold_m, const ScreeningOptions& options) {
+    // Refinement examines passes that come within the margin of the threshold at a sample
+    return options.refineTca && options.refineMargin_m > 0.0
+               ? threshold_m + options.refineMargin_m : threshold_m;
+}
 
 vector<Encounter> screen_by_threshold(
-    const vector<Trajectory>& tracks, 
+    const vector<Trajectory>& tracks,
     double threshold_m) {
-    
-    vector<Encounter> encounters;
-    
+    return screen_by_threshold(tracks, threshold_m, ScreeningOptions{});
+}
+
+vector<Encounter> screen_by_threshold(
+    const vector<Trajectory>& tracks,
+    double threshold_m,
+    const ScreeningOptions& options) {
     if (tracks.size() < 2) {
+        return vector<Encounter>();
+    }
+    return screen_by_threshold(store_from_trajectories(tracks), threshold_m, options);
+}
+
+vector<Encounter> screen_by_threshold(
+    const TrajectoryStore& store,
+    double threshold_m,
+    const ScreeningOptions& options) {
+    NOVA_SCOPE("screen_by_threshold");
+
+    vector<Encounter> encounters;
+
+    if (store.count < 2) {
+        return encounters;
+    }
+
+    const double screen_m = screening_candidate_distance(threshold_m, options);
+    const ScreenGeometry geometry = screen_geometry(screen_m);
+    const PairPrefilter* prefilter = active_prefilter(store, options);
+    const size_t n = store.count;
+
+    // Time steps are split across workers; each keeps its own hit buffer
+    const unsigned threads = resolve_thread_count(options.threads);
+    vector<ScreenWorker> workers(threads);
+    parallel_for_chunks(store.steps, STEP_CHUNK, threads,
+        [&](unsigned wi, size_t begin, size_t end) {
+            NOVA_SCOPE("screen_steps");
+            ScreenWorker& w = workers[wi];
+            for (size_t k = begin; k < end; ++k) {
+                screen_step(store, k, geometry.invCell, screen_m, geometry.radius2Km, prefilter,
+                    options.splitIndex, w,
+                    [&](uint32_t i, uint32_t j, double distance_m) {
+                        // Record only first hit per pair to avoid duplicates
+                        const Hit hit = {i, j, static_cast<uint32_t>(k), distance_m};
+                        if (w.found.insert(pair_key(hit, n)).second) {
+                            w.hits.push_back(hit);
+                        }
+                    });
+            }
+        });
+
+    const vector<Hit> hits = merge_first_hits(workers);
+    build_encounters(store, hits, threshold_m, options, threads, encounters);
+    return encounters;
+}
+
+vector<Encounter> screen_by_threshold_adaptive(
+    const TrajectoryStore& store,
+    double threshold_m,
+    const ScreeningOptions& options) {
+    NOVA_SCOPE("screen_by_threshold_adaptive");
+
+    vector<Encounter> encounters;
+    if (store.count < 2) {
+        return encounters;
+    }
+
+    const double screen_m = screening_candidate_distance(threshold_m, options);
+    const PairPrefilter* prefilter = active_prefilter(store, options);
+    const uint32_t split = options.splitIndex;
+    const size_t n = store.count;
+    const unsigned threads = resolve_thread_count(options.threads);
+    PairTracks tracks;
+    build_pair_tracks(store, threads, tracks);
+    const size_t steps = store.steps;
+
+    // Samples skipped over are strictly farther than screen_m; the slack keeps
+    // rounding in the reach sums from ever skipping the first sample within it
+    const double slack = 1.0 - 1e-9;
+    vector<ScreenWorker> workers(threads);
+    parallel_for_chunks(n, 16, threads,
+        [&](unsigned wi, size_t begin, size_t end) {
+            NOVA_SCOPE("screen_pairs");
+            ScreenWorker& w = workers[wi];
+            size_t tested = 0;
+            size_t inThreshold = 0;
+            auto walk = [&](uint32_t i, uint32_t j) {
+                const double pairReach = tracks.reach[i] + tracks.reach[j];
+                const float* a = tracks.xyz.data() + i * steps * 3;
+                const float* b = tracks.xyz.data() + j * steps * 3;
+                size_t k = 0;
+                while (k < steps) {
+                    double gap_m = separation_m(static_cast<double>(a[3 * k]) - b[3 * k],
+                                                static_cast<double>(a[3 * k + 1]) - b[3 * k + 1],
+                                                static_cast<double>(a[3 * k + 2]) - b[3 * k + 2]) -
+                                   tracks.error_m - screen_m;
+                    ++tested;
+                    if (!(gap_m > 0.0)) {
+                        // Possibly within reach: the exact test of the grid narrow phase
+                        const double* xs = store.row(STORE_X, k);
+                        const double* ys = store.row(STORE_Y, k);
+                        const double* zs = store.row(STORE_Z, k);
+                        const double distance_m = separation_m(xs[i] - xs[j], ys[i] - ys[j], zs[i] - zs[j]);
+                        if (distance_m <= screen_m) {
+                            ++inThreshold;
+                            w.hits.push_back({i, j, static_cast<uint32_t>(k), distance_m});
+                            return;
+                        }
+                        gap_m = distance_m - screen_m;
+                    }
+                    // NaN (non-finite states or an unbounded reach) falls back to one step
+                    const double jump = gap_m * slack / pairReach;
+                    k += jump >= 2.0 ? static_cast<size_t>(min(jump, static_cast<double>(steps))) : 1;
+                }
+            };
+            for (size_t a = begin; a < end; ++a) {
+                const uint32_t i = static_cast<uint32_t>(a);
+                if (prefilter) {
+                    for (uint64_t p = prefilter->offsets[i]; p < prefilter->offsets[i + 1]; ++p) {
+                        const uint32_t j = prefilter->partners[p];
+                        if (split && (i < split) == (j < split)) continue;
+                        walk(i, j);
+                    }
+                    continue;
+                }
+                if (split && i >= split) break;
+                for (size_t j = split ? max<size_t>(split, a + 1) : a + 1; j < n; ++j) {
+                    walk(i, static_cast<uint32_t>(j));
+                }
+            }
+            NOVA_COUNT(COUNTER_PAIRS_TESTED, tested);
+            NOVA_COUNT(COUNTER_PAIRS_IN_THRESHOLD, inThreshold);
+        });
+
+    const vector<Hit> hits = merge_first_hits(workers);
+    build_encounters(store, hits, threshold_m, options, threads, encounters);
+    return encounters;
+}
+
+vector<Encounter> screen_lazy(LazyEphemeris& eph, double threshold_m, const ScreeningOptions& options) {
+    NOVA_SCOPE("screen_lazy");
+
+    vector<Encounter> encounters;
+    if (eph.count < 2) {
+        return encounters;
+    }
+
+    const double screen_m = screening_candidate_distance(threshold_m, options);
+    const PairPrefilter* prefilter = active_prefilter(eph, options);
+    const uint32_t split = options.splitIndex;
+    const size_t n = eph.count;
+    const size_t steps = eph.steps;
+    const unsigned threads = resolve_thread_count(options.threads);
+
+    // One chunk of steps at a time: the positions every walk below needs are
+    // gathered once, and the walks read them there
+    vector<ScreenWorker> workers(threads);
+    LazyChunkRows rows;
+    if (!prefilter) {
+        // Every pair is a candidate: the grid broad phase and narrow phase of
+        // screen_by_threshold, step by step over the gathered rows
+        const ScreenGeometry geometry = screen_geometry(screen_m);
+        for (size_t first = 0; first < steps; first += eph.chunkSteps) {
+            fill_chunk_rows(eph, first / eph.chunkSteps, nullptr, threads, rows);
+            parallel_for_chunks(rows.steps, STEP_CHUNK, threads,
+                [&](unsigned wi, size_t begin, size_t end) {
+                    NOVA_SCOPE("screen_steps");
+                    ScreenWorker& w = workers[wi];
+                    for (size_t s = begin; s < end; ++s) {
+                        const uint32_t k = static_cast<uint32_t>(first + s);
+                        screen_step(rows, s, geometry.invCell, screen_m, geometry.radius2Km, nullptr,
+                            split, w,
+                            [&](uint32_t i, uint32_t j, double distance_m) {
+                                const Hit hit = {i, j, k, distance_m};
+                                if (w.found.insert(pair_key(hit, n)).second) {
+                                    w.hits.push_back(hit);
+                                }
+                            });
+                    }
+                });
+        }
+    } else {
+        // Same walk as screen_by_threshold_adaptive over the prefilter's pairs,
+        // on the exact states and the propagator's step bounds. Each pair
+        // resumes at its next step, so only objects with a pair due in the
+        // chunk are gathered, and chunks every pair jumps over are never
+        // propagated.
+        const double slack = 1.0 - 1e-9;
+        vector<uint32_t> next(prefilter->partners.size(), 0); // steps when the pair is done
+        if (split) {
+            for (size_t i = 0; i < n; ++i) {
+                for (uint64_t p = prefilter->offsets[i]; p < prefilter->offsets[i + 1]; ++p) {
+                    if ((i < split) == (prefilter->partners[p] < split)) next[p] = static_cast<uint32_t>(steps);
+                }
+            }
+        }
+        vector<char> live(n);
+        for (size_t first = 0; first < steps; first += eph.chunkSteps) {
+            const size_t last = min(steps, first + eph.chunkSteps);
+            fill(live.begin(), live.end(), 0);
+            for (size_t i = 0; i < n; ++i) {
+                for (uint64_t p = prefilter->offsets[i]; p < prefilter->offsets[i + 1]; ++p) {
+                    if (next[p] < last) live[i] = live[prefilter->partners[p]] = 1;
+                }
+            }
+            fill_chunk_rows(eph, first / eph.chunkSteps, &live, threads, rows);
+            parallel_for_chunks(n, 16, threads,
+                [&](unsigned wi, size_t begin, size_t end) {
+                    NOVA_SCOPE("screen_pairs");
+                    ScreenWorker& w = workers[wi];
+                    size_t tested = 0;
+                    size_t inThreshold = 0;
+                    for (size_t a = begin; a < end; ++a) {
+                        const uint32_t i = static_cast<uint32_t>(a);
+                        for (uint64_t p = prefilter->offsets[i]; p < prefilter->offsets[i + 1]; ++p) {
+                            size_t k = next[p];
+                            if (k >= last) continue;
+                            const uint32_t j = prefilter->partners[p];
+                            const double pairReach = eph.stepBound_m[i] + eph.stepBound_m[j];
+                            while (k < last) {
+                                const size_t s = k - first;
+                                const double distance_m =
+                                    separation_m(rows.row(STORE_X, s)[i] - rows.row(STORE_X, s)[j],
+                                                 rows.row(STORE_Y, s)[i] - rows.row(STORE_Y, s)[j],
+                                                 rows.row(STORE_Z, s)[i] - rows.row(STORE_Z, s)[j]);
+                                ++tested;
+                                if (distance_m <= screen_m) {
+                                    ++inThreshold;
+                                    w.hits.push_back({i, j, static_cast<uint32_t>(k), distance_m});
+                                    k = steps;
+                                    break;
+                                }
+                                // NaN (failed states) falls back to one step
+                                const double jump = (distance_m - screen_m) * slack / pairReach;
+                                k += jump >= 2.0 ? static_cast<size_t>(min(jump, static_cast<double>(steps))) : 1;
+                            }
+                            next[p] = static_cast<uint32_t>(min(k, steps));
+                        }
+                    }
+                    NOVA_COUNT(COUNTER_PAIRS_TESTED, tested);
+                    NOVA_COUNT(COUNTER_PAIRS_IN_THRESHOLD, inThreshold);
+                });
+        }
+    }
+    const vector<Hit> hits = merge_first_hits(workers);
+
+    build_pair_encounters(hits, steps, eph.isDebris, threshold_m, options, threads,
+        [&](const uint32_t* objects, size_t first, size_t end, TrajectoryStore& pair) {
+            lazy_fill_store(eph, objects, 2, pair, first, end);
+        }, encounters);
+    return encounters;
+}
+
+vector<Encounter> screen_compact(const CompactStore& compact, double threshold_m,
+                                 const ScreeningOptions& options) {
+    NOVA_SCOPE("screen_compact");
+
+    vector<Encounter> encounters;
+    if (compact.count < 2) {
         return encounters;
     }
-    
-    // Find minimum number of time steps across all trajectories
-    size_t minSteps = tracks[0].states.size();
-    for (const auto& track : tracks) {
-        if (track.states.size() < minSteps) {
-            minSteps = track.states.size();
-        }
-    }
-    
-    // Pairwise distance check at each time step
-    for (size_t i = 0; i < tracks.size() - 1; ++i) {
-        for (size_t j = i + 1; j < tracks.size(); ++j) {
-            const auto& track1 = tracks[i];
-            const auto& track2 = tracks[j];
-            
-            // Check each time-aligned sample
-            for (size_t k = 0; k < minSteps; ++k) {
-                const auto& state1 = track1.states[k];
-                const auto& state2 = track2.states[k];
-                
-                // Compute Euclidean distance in meters
-                double dx = (state1.x - state2.x) * 1000.0; // Convert km to m
-                double dy = (state1.y - state2.y) * 1000.0;
-                double dz = (state1.z - state2.z) * 1000.0;
-                double distance_m = sqrt(dx*dx + dy*dy + dz*dz);
-                
-                // Check threshold (caller-provided threshold may already account for object radii)
-                if (distance_m <= threshold_m) {
-                    // Severity bands relative to threshold
-                    // <= 1/3 threshold: High, <= 2/3: Medium, <= threshold: Low, else: None
-                    int level = NONE;
-                    if (distance_m <= (threshold_m / 3.0)) {
-                        level = HIGH;
-                    } else if (distance_m <= (2.0 * threshold_m / 3.0)) {
-                        level = MEDIUM;
-                    } else { // <= threshold_m
-                        level = LOW;
+
+    // The float phase screens at the screening distance plus the rounding
+    // bound, so it passes every sample the exact test would accept; the
+    // kernel radius is padded for the float arithmetic of the squared distance
+    const double screen_m = screening_candidate_distance(threshold_m, options);
+    const double padded_m = screen_m + compact.error_m;
+    ScreenGeometry geometry = screen_geometry(padded_m);
+    geometry.radius2Km *= 1.0 + 1e-5;
+    const PairPrefilter* prefilter = active_prefilter(compact, options);
+    const size_t n = compact.count;
+
+    const unsigned threads = resolve_thread_count(options.threads);
+    vector<ScreenWorker> workers(threads);
+    parallel_for_chunks(compact.steps, STEP_CHUNK, threads,
+        [&](unsigned wi, size_t begin, size_t end) {
+            NOVA_SCOPE("screen_steps");
+            ScreenWorker& w = workers[wi];
+            vector<pair<uint32_t, uint32_t>> candidates;
+            vector<uint32_t> objects;
+            vector<uint32_t> slot(n, UINT32_MAX); // index into objects, per object
+            vector<OrbitalElements> elements;
+            vector<StateVectorECI> states;
+            for (size_t k = begin; k < end; ++k) {
+                candidates.clear();
+                screen_step(compact, k, geometry.invCell, padded_m, geometry.radius2Km, prefilter,
+                    options.splitIndex, w,
+                    [&](uint32_t i, uint32_t j, double) {
+                        if (!w.found.count(pair_key(i, j, n))) candidates.push_back({i, j});
+                    });
+                if (candidates.empty()) continue;
+
+                // Candidate samples: the exact positions, as the double store holds
+                // them, propagated once per object the step's candidates name
+                objects.clear();
+                elements.clear();
+                for (const auto& c : candidates) {
+                    for (const uint32_t o : {c.first, c.second}) {
+                        if (slot[o] != UINT32_MAX) continue;
+                        slot[o] = static_cast<uint32_t>(objects.size());
+                        objects.push_back(o);
+                        elements.push_back(compact.elements[o]);
                     }
+                }
+                states.resize(objects.size());
+                propagate_grid(elements.data(), elements.size(), &compact.timesJd[k], 1, states.data(), false);
+                for (const auto& c : candidates) {
+                    const StateVectorECI& a = states[slot[c.first]];
+                    const StateVectorECI& b = states[slot[c.second]];
+                    const Hit hit = {c.first, c.second, static_cast<uint32_t>(k),
+                                     separation_m(a.r[0] - b.r[0], a.r[1] - b.r[1], a.r[2] - b.r[2])};
+                    if (!(hit.distance_m <= screen_m)) continue;
+                    w.found.insert(pair_key(hit, n));
+                    w.hits.push_back(hit);
+                }
+                for (const uint32_t o : objects) slot[o] = UINT32_MAX;
+            }
+        });
+
+    const vector<Hit> hits = merge_first_hits(workers);
+    build_pair_encounters(hits, compact.steps, compact.isDebris, threshold_m, options, threads,
+        [&](const uint32_t* objects, size_t first, size_t end, TrajectoryStore& pair) {
+            compact_fill_store(compact, objects, 2, pair, first, end);
+        }, encounters);
+    return encounters;
+}
+
+vector<EncounterTier> screen_by_thresholds(
+    const TrajectoryStore& store,
+    const vector<double>& thresholds_m,
+    const ScreeningOptions& options) {
+    NOVA_SCOPE("screen_by_thresholds");
+
+    vector<double> levels;
+    for (double t : thresholds_m) {
+        if (t > 0.0 && std::isfinite(t)) levels.push_back(t);
+    }
+    sort(levels.begin(), levels.end());
+    levels.erase(unique(levels.begin(), levels.end()), levels.end());
+
+    vector<EncounterTier> tiers(levels.size());
+    for (size_t t = 0; t < levels.size(); ++t) tiers[t].threshold_m = levels[t];
+    if (store.count < 2 || levels.empty()) {
+        return tiers;
+    }
+
+    vector<double> screen_m(levels.size());
+    for (size_t t = 0; t < levels.size(); ++t) {
+        screen_m[t] = screening_candidate_distance(levels[t], options);
+    }
+    const double outer_m = screen_m.back();
+    const ScreenGeometry geometry = screen_geometry(outer_m);
+    const PairPrefilter* prefilter = active_prefilter(store, options);
+    const size_t n = store.count;
+
+    // workers[t][w] keeps worker w's first hits for tier t; the outer tier's
+    // workers also hold the broad-phase scratch
+    const unsigned threads = resolve_thread_count(options.threads);
+    vector<vector<ScreenWorker>> workers;
+    workers.reserve(levels.size());
+    for (size_t t = 0; t < levels.size(); ++t) workers.emplace_back(threads);
+
+    parallel_for_chunks(store.steps, STEP_CHUNK, threads,
+        [&](unsigned wi, size_t begin, size_t end) {
+            NOVA_SCOPE("screen_steps");
+            ScreenWorker& outer = workers.back()[wi];
+            for (size_t k = begin; k < end; ++k) {
+                screen_step(store, k, geometry.invCell, outer_m, geometry.radius2Km, prefilter,
+                    options.splitIndex, outer,
+                    [&](uint32_t i, uint32_t j, double distance_m) {
+                        // Tiers are nested: a sample within tier t is within every
+                        // larger one, so a pair already seen in tier t is in all of them
+                        const Hit hit = {i, j, static_cast<uint32_t>(k), distance_m};
+                        const uint64_t key = pair_key(hit, n);
+                        size_t t = 0;
+                        while (distance_m > screen_m[t]) ++t;
+                        for (; t < levels.size(); ++t) {
+                            ScreenWorker& w = workers[t][wi];
+                            if (!w.found.insert(key).second) break;
+                            w.hits.push_back(hit);
+                        }
+                    });
+            }
+        });
+
+    for (size_t t = 0; t < levels.size(); ++t) {
+        const vector<Hit> hits = merge_first_hits(workers[t]);
+        build_encounters(store, hits, levels[t], options, threads, tiers[t].encounters);
+    }
+    return tiers;
+}
+
+vector<EncounterPass> screen_passes(
+    const TrajectoryStore& store,
+    double threshold_m,
+    const ScreeningOptions& options) {
+    NOVA_SCOPE("screen_passes");
+
+    vector<EncounterPass> passes;
+    if (store.count < 2) {
+        return passes;
+    }
+
+    const double screen_m = screening_candidate_distance(threshold_m, options);
+    const ScreenGeometry geometry = screen_geometry(screen_m);
+    const PairPrefilter* prefilter = active_prefilter(store, options);
+    const size_t n = store.count;
+
+    const unsigned threads = resolve_thread_count(options.threads);
+    vector<PassWorker> workers(threads);
+    parallel_for_chunks(store.steps, STEP_CHUNK, threads,
+        [&](unsigned wi, size_t begin, size_t end) {
+            NOVA_SCOPE("screen_steps");
+            PassWorker& w = workers[wi];
+            for (size_t k = begin; k < end; ++k) {
+                const uint32_t step = static_cast<uint32_t>(k);
+                screen_step(store, k, geometry.invCell, screen_m, geometry.radius2Km, prefilter,
+                    options.splitIndex, w.screen,
+                    [&](uint32_t i, uint32_t j, double distance_m) {
+                        const SampleRun sample = {i, j, step, step, step, distance_m};
+                        const uint64_t key = pair_key(i, j, n);
+                        auto it = w.open.find(key);
+                        if (it == w.open.end()) {
+                            w.open.emplace(key, sample);
+                            return;
+                        }
+                        SampleRun& run = it->second;
+                        if (run.last + 1 != step) {
+                            // Gap since the pair was last seen: that window is over
+                            w.closed.push_back(run);
+                            run = sample;
+                            return;
+                        }
+                        run.last = step;
+                        if (distance_m < run.distance_m) {
+                            run.closest = step;
+                            run.distance_m = distance_m;
+                        }
+                    });
+            }
+        });
+
+    const vector<SampleRun> runs = merge_runs(workers);
+    workers.clear();
+
+    // Runs are independent; each worker appends its windows and the result is
+    // put back into (pair, time) order
+    NOVA_SCOPE("refine_passes");
+    const double margin_m = screen_m - threshold_m;
+    vector<vector<EncounterPass>> found(threads);
+    parallel_for_chunks(runs.size(), 64, threads,
+        [&](unsigned wi, size_t begin, size_t end) {
+            vector<TcaEstimate> tcas;
+            for (size_t r = begin; r < end; ++r) {
+                run_passes(store, runs[r], threshold_m, margin_m, options.refineTca, tcas, found[wi]);
+            }
+        });
+    size_t total = 0;
+    for (const auto& f : found) total += f.size();
+    passes.reserve(total);
+    for (auto& f : found) {
+        passes.insert(passes.end(), f.begin(), f.end());
+        vector<EncounterPass>().swap(f);
+    }
+    sort(passes.begin(), passes.end(), [](const EncounterPass& a, const EncounterPass& b) {
+        if (a.tca.aIndex != b.tca.aIndex) return a.tca.aIndex < b.tca.aIndex;
+        if (a.tca.bIndex != b.tca.bIndex) return a.tca.bIndex < b.tca.bIndex;
+        return a.entry < b.entry;
+    });
+
+    if (options.refineTca && options.probability) {
+        vector<Encounter> scored(passes.size());
+        for (size_t p = 0; p < passes.size(); ++p) scored[p] = passes[p].tca;
+        score_encounters(store, scored.data(), scored.size(), *options.probability);
+        for (size_t p = 0; p < passes.size(); ++p) passes[p].tca.pc = scored[p].pc;
+    }
+    return passes;
+}
+
+vector<Encounter> screen_step_range(
+    const TrajectoryStore& store,
+    size_t firstStep,
+    size_t endStep,
+    double threshold_m,
+    const ScreeningOptions& options,
+    size_t* resumeStep,
+    size_t holdFrom) {
+    NOVA_SCOPE("screen_step_range");
+
+    vector<Encounter> encounters;
+    endStep = min(endStep, store.steps);
+    if (resumeStep) *resumeStep = endStep;
+    if (store.count < 2 || firstStep >= endStep) {
+        return encounters;
+    }
+
+    const double screen_m = screening_candidate_distance(threshold_m, options);
+    const ScreenGeometry geometry = screen_geometry(screen_m);
+    const PairPrefilter* prefilter = active_prefilter(store, options);
+
+    const unsigned threads = resolve_thread_count(options.threads);
+    vector<ScreenWorker> workers(threads);
+    parallel_for_chunks(endStep - firstStep, STEP_CHUNK, threads,
+        [&](unsigned wi, size_t begin, size_t end) {
+            NOVA_SCOPE("screen_steps");
+            ScreenWorker& w = workers[wi];
+            for (size_t k = firstStep + begin; k < firstStep + end; ++k) {
+                const double* px = k ? store.row(STORE_X, k - 1) : nullptr;
+                const double* py = k ? store.row(STORE_Y, k - 1) : nullptr;
+                const double* pz = k ? store.row(STORE_Z, k - 1) : nullptr;
+                screen_step(store, k, geometry.invCell, screen_m, geometry.radius2Km, prefilter,
+                    options.splitIndex, w,
+                    [&](uint32_t i, uint32_t j, double distance_m) {
+                        // Within the screening distance one step earlier: same pass
+                        if (px && separation_m(px[i] - px[j], py[i] - py[j], pz[i] - pz[j]) <= screen_m) {
+                            return;
+                        }
+                        // Each pass start is its own hit (a pair is visited once per step)
+                        w.hits.push_back({i, j, static_cast<uint32_t>(k), distance_m});
+                    });
+            }
+        });
+
+    size_t total = 0;
+    for (const auto& w : workers) total += w.hits.size();
+    vector<Hit> hits;
+    hits.reserve(total);
+    for (const auto& w : workers) hits.insert(hits.end(), w.hits.begin(), w.hits.end());
+    sort(hits.begin(), hits.end(), [](const Hit& a, const Hit& b) {
+        if (a.i != b.i) return a.i < b.i;
+        if (a.j != b.j) return a.j < b.j;
+        return a.k < b.k;
+    });
+
+    // Refinement stays within each hit's run of samples inside the screening
+    // distance, so a pass that refines out never stands in for a later one
+    // (which has a hit of its own, now or in a later range)
+    vector<uint32_t> ends;
+    if (options.refineTca) {
+        ends.resize(hits.size());
+        parallel_for_chunks(hits.size(), 256, threads, [&](unsigned, size_t begin, size_t end) {
+            for (size_t h = begin; h < end; ++h) {
+                const Hit& hit = hits[h];
+                size_t e = hit.k + 1;
+                while (e < store.steps) {
+                    const double* xs = store.row(STORE_X, e);
+                    const double* ys = store.row(STORE_Y, e);
+                    const double* zs = store.row(STORE_Z, e);
+                    // NaN compares false, which also ends the run
+                    if (!(separation_m(xs[hit.i] - xs[hit.j], ys[hit.i] - ys[hit.j],
+                                       zs[hit.i] - zs[hit.j]) <= screen_m)) break;
+                    ++e;
+                }
+                ends[h] = static_cast<uint32_t>(e);
+            }
+        });
 
-                    // Mapping to string
-                    (void)severity_to_string(level);
-
-                    Encounter encounter;
-                    encounter.aId = track1.id;
-                    encounter.bId = track2.id;
-                    encounter.t = state1.t;
-                    encounter.miss_m = distance_m;
-                    encounter.rel_mps = 0.0; // keep simple: no velocity-based logic
-                    encounter.severity = level;
-                    
-                    encounters.push_back(encounter);
-                    
-                    // Record only first hit per pair to avoid duplicates
-                    break;
+        // Recent passes that run into the last stored step wait for more steps
+        if (resumeStep) {
+            size_t kept = 0;
+            for (size_t h = 0; h < hits.size(); ++h) {
+                if (ends[h] >= store.steps && hits[h].k >= holdFrom) {
+                    *resumeStep = min<size_t>(*resumeStep, hits[h].k);
+                    continue;
                 }
+                hits[kept] = hits[h];
+                ends[kept++] = ends[h];
+            }
+            hits.resize(kept);
+            ends.resize(kept);
+        }
+    }
+    build_encounters(store, hits, threshold_m, options, threads, encounters, SIZE_MAX,
+                     options.refineTca ? &ends : nullptr);
+    return encounters;
+}
+
+size_t screen_by_threshold_streaming(
+    const TrajectoryStore& store,
+    double threshold_m,
+    const ScreeningOptions& options,
+    const EncounterBatchFn& onBatch) {
+    NOVA_SCOPE("screen_by_threshold_streaming");
+
+    if (store.count < 2) {
+        return 0;
+    }
+
+    const double screen_m = screening_candidate_distance(threshold_m, options);
+    const ScreenGeometry geometry = screen_geometry(screen_m);
+    const PairPrefilter* prefilter = active_prefilter(store, options);
+    const size_t n = store.count;
+
+    // Steps are screened a block at a time; only the block's hits and the keys
+    // of pairs already reported are kept between blocks
+    const unsigned threads = resolve_thread_count(options.threads);
+    const size_t blockSteps = STEP_CHUNK * threads;
+    vector<ScreenWorker> workers(threads);
+    ScratchArena reportedArena;
+    pmr::unordered_set<uint64_t> reported(&reportedArena.resource);
+    vector<Hit> hits;
+    vector<Encounter> pending;
+    size_t total = 0;
+
+    for (size_t blockBegin = 0; blockBegin < store.steps; blockBegin += blockSteps) {
+        const size_t blockEnd = min(store.steps, blockBegin + blockSteps);
+
+        // Workers read the reported set but only the merge below writes it
+        parallel_for_chunks(blockEnd - blockBegin, STEP_CHUNK, threads,
+            [&](unsigned wi, size_t begin, size_t end) {
+                NOVA_SCOPE("screen_steps");
+                ScreenWorker& w = workers[wi];
+                for (size_t k = blockBegin + begin; k < blockBegin + end; ++k) {
+                    screen_step(store, k, geometry.invCell, screen_m, geometry.radius2Km, prefilter,
+                        options.splitIndex, w,
+                        [&](uint32_t i, uint32_t j, double distance_m) {
+                            const Hit hit = {i, j, static_cast<uint32_t>(k), distance_m};
+                            const uint64_t key = pair_key(hit, n);
+                            if (reported.count(key) == 0 && w.found.insert(key).second) {
+                                w.hits.push_back(hit);
+                            }
+                        });
+                }
+            });
+
+        hits.clear();
+        for (auto& w : workers) {
+            hits.insert(hits.end(), w.hits.begin(), w.hits.end());
+            release_scratch(w);
+        }
+
+        // Earliest sample of each new pair, in time then (i, j) order
+        sort(hits.begin(), hits.end(), [](const Hit& a, const Hit& b) {
+            if (a.k != b.k) return a.k < b.k;
+            if (a.i != b.i) return a.i < b.i;
+            return a.j < b.j;
+        });
+
+        // A pair counts as reported once flagged, even if refinement drops
+        // it: refinement has already looked at all of its later passes
+        size_t fresh = 0;
+        for (const auto& hit : hits) {
+            if (reported.insert(pair_key(hit, n)).second) hits[fresh++] = hit;
+        }
+        hits.resize(fresh);
+
+        // Later blocks flag pairs from step blockEnd on, and refinement looks
+        // at most one sample back, so every encounter before the block's last
+        // sample is final and goes out in the conjunction writers' time order
+        const size_t held = pending.size();
+        build_encounters(store, hits, threshold_m, options, threads, pending);
+        if (pending.size() > held) sort_encounters_by_time(pending.data(), pending.size(), threads);
+        const double settled = blockEnd < store.steps ? store.time(blockEnd - 1) : HUGE_VAL;
+        const size_t ready = static_cast<size_t>(partition_point(pending.begin(), pending.end(),
+            [&](const Encounter& e) { return e.t < settled; }) - pending.begin());
+        if (ready) {
+            total += ready;
+            onBatch(pending.data(), ready);
+            pending.erase(pending.begin(), pending.begin() + ready);
+        }
+    }
+
+    return total;
+}
+
+void screening_index_build(ScreeningIndex& index, const TrajectoryStore& store,
+                           double distance_m, unsigned threads) {
+    NOVA_SCOPE("screening_index_build");
+    index.distance_m = distance_m;
+    index.invCell = screen_geometry(distance_m).invCell;
+    index.cells.assign(store.steps, vector<ScreeningCell>());
+    parallel_for_chunks(store.steps, STEP_CHUNK, threads, [&](unsigned, size_t begin, size_t end) {
+        for (size_t k = begin; k < end; ++k) bin_step(store, k, index.invCell, index.cells[k]);
+    });
+}
+
+void screening_index_update(ScreeningIndex& index, const TrajectoryStore& store,
+                            const vector<uint32_t>& objects, unsigned threads) {
+    NOVA_SCOPE("screening_index_update");
+    if (index.cells.size() != store.steps) {
+        screening_index_build(index, store, index.distance_m, threads);
+        return;
+    }
+
+    vector<char> changed(store.count, 0);
+    for (uint32_t i : objects) {
+        if (i < store.count) changed[i] = 1;
+    }
+
+    // Per step: drop the changed objects' old cells, bin them again and merge
+    const double invCell = index.invCell;
+    parallel_for_chunks(store.steps, STEP_CHUNK, threads, [&](unsigned, size_t begin, size_t end) {
+        vector<CellEntry> fresh;
+        for (size_t k = begin; k < end; ++k) {
+            vector<CellEntry>& cells = index.cells[k];
+            cells.erase(remove_if(cells.begin(), cells.end(), [&](const CellEntry& e) {
+                return e.idx >= changed.size() || changed[e.idx];
+            }), cells.end());
+
+            const double* xs = store.row(STORE_X, k);
+            const double* ys = store.row(STORE_Y, k);
+            const double* zs = store.row(STORE_Z, k);
+            fresh.clear();
+            for (uint32_t i : objects) {
+                if (i >= store.count) continue;
+                if (!std::isfinite(xs[i]) || !std::isfinite(ys[i]) || !std::isfinite(zs[i])) continue;
+                fresh.push_back({cell_key(static_cast<int64_t>(floor(xs[i] * invCell)),
+                                          static_cast<int64_t>(floor(ys[i] * invCell)),
+                                          static_cast<int64_t>(floor(zs[i] * invCell))), i});
+            }
+            auto order = [](const CellEntry& a, const CellEntry& b) {
+                return a.key < b.key || (a.key == b.key && a.idx < b.idx);
+            };
+            sort(fresh.begin(), fresh.end(), order);
+            fresh.erase(unique(fresh.begin(), fresh.end(), [](const CellEntry& a, const CellEntry& b) {
+                return a.idx == b.idx;
+            }), fresh.end());
+            const size_t old = cells.size();
+            cells.insert(cells.end(), fresh.begin(), fresh.end());
+            inplace_merge(cells.begin(), cells.begin() + old, cells.end(), order);
+        }
+    });
+}
+
+void screening_index_neighbours(const ScreeningIndex& index, size_t k, const double r_km[3],
+                                vector<uint32_t>& out) {
+    if (k >= index.cells.size()) return;
+    if (!std::isfinite(r_km[0]) || !std::isfinite(r_km[1]) || !std::isfinite(r_km[2])) return;
+    const vector<CellEntry>& cells = index.cells[k];
+    const int64_t cx = static_cast<int64_t>(floor(r_km[0] * index.invCell));
+    const int64_t cy = static_cast<int64_t>(floor(r_km[1] * index.invCell));
+    const int64_t cz = static_cast<int64_t>(floor(r_km[2] * index.invCell));
+    for (int ox = -1; ox <= 1; ++ox) {
+        for (int oy = -1; oy <= 1; ++oy) {
+            for (int oz = -1; oz <= 1; ++oz) {
+                const uint64_t key = cell_key(cx + ox, cy + oy, cz + oz);
+                auto it = lower_bound(cells.begin(), cells.end(), key,
+                    [](const CellEntry& e, uint64_t v) { return e.key < v; });
+                for (; it != cells.end() && it->key == key; ++it) out.push_back(it->idx);
             }
         }
     }
-    
+}
+
+vector<Encounter> screen_objects(const TrajectoryStore& store, const ScreeningIndex& index,
+                                 const vector<uint32_t>& objects, double threshold_m,
+                                 const ScreeningOptions& options) {
+    NOVA_SCOPE("screen_objects");
+    vector<Encounter> encounters;
+    if (store.count < 2 || objects.empty() || index.cells.size() != store.steps) {
+        return encounters;
+    }
+
+    const double screen_m = screening_candidate_distance(threshold_m, options);
+    const double invCell = index.invCell;
+    const size_t n = store.count;
+
+    vector<char> inSet(n, 0);
+    vector<uint32_t> subset;
+    for (uint32_t i : objects) {
+        if (i < n && !inSet[i]) {
+            inSet[i] = 1;
+            subset.push_back(i);
+        }
+    }
+
+    // Probe the full 27-cell neighbourhood of every changed object; a pair of
+    // two changed objects is tested once, from its lower index
+    const unsigned threads = resolve_thread_count(options.threads);
+    vector<ScreenWorker> workers(threads);
+    parallel_for_chunks(store.steps, STEP_CHUNK, threads,
+        [&](unsigned wi, size_t begin, size_t end) {
+            NOVA_SCOPE("screen_steps");
+            ScreenWorker& w = workers[wi];
+            for (size_t k = begin; k < end; ++k) {
+                const vector<CellEntry>& cells = index.cells[k];
+                const double* xs = store.row(STORE_X, k);
+                const double* ys = store.row(STORE_Y, k);
+                const double* zs = store.row(STORE_Z, k);
+                size_t tested = 0;
+                size_t inThreshold = 0;
+                for (uint32_t c : subset) {
+                    if (!std::isfinite(xs[c]) || !std::isfinite(ys[c]) || !std::isfinite(zs[c])) continue;
+                    const int64_t cx = static_cast<int64_t>(floor(xs[c] * invCell));
+                    const int64_t cy = static_cast<int64_t>(floor(ys[c] * invCell));
+                    const int64_t cz = static_cast<int64_t>(floor(zs[c] * invCell));
+                    for (int ox = -1; ox <= 1; ++ox) {
+                        for (int oy = -1; oy <= 1; ++oy) {
+                            for (int oz = -1; oz <= 1; ++oz) {
+                                const uint64_t key = cell_key(cx + ox, cy + oy, cz + oz);
+                                auto it = lower_bound(cells.begin(), cells.end(), key,
+                                    [](const CellEntry& e, uint64_t v) { return e.key < v; });
+                                for (; it != cells.end() && it->key == key; ++it) {
+                                    const uint32_t o = it->idx;
+                                    if (o == c || (inSet[o] && o < c)) continue;
+                                    const uint32_t i = c < o ? c : o;
+                                    const uint32_t j = c < o ? o : c;
+
+                                    // Same exact test as the full screening narrow phase
+                                    const double distance_m =
+                                        separation_m(xs[i] - xs[j], ys[i] - ys[j], zs[i] - zs[j]);
+                                    ++tested;
+                                    if (distance_m > screen_m) continue;
+                                    ++inThreshold;
+
+                                    const Hit hit = {i, j, static_cast<uint32_t>(k), distance_m};
+                                    if (w.found.insert(pair_key(hit, n)).second) {
+                                        w.hits.push_back(hit);
+                                    }
+                                }
+                            }
+                        }
+                    }
+                }
+                NOVA_COUNT(COUNTER_PAIRS_TESTED, tested);
+                NOVA_COUNT(COUNTER_PAIRS_IN_THRESHOLD, inThreshold);
+            }
+        });
+
+    const vector<Hit> hits = merge_first_hits(workers);
+    build_encounters(store, hits, threshold_m, options, threads, encounters);
     return encounters;
 }
+
+void sort_encounters_by_risk(Encounter* encounters, size_t count, unsigned threads) {
+    NOVA_SCOPE("sort_encounters_by_risk");
+    vector<RiskKey> keys(count);
+    for (size_t e = 0; e < count; ++e) keys[e] = risk_key(encounters[e], e);
+    parallel_sort(keys, threads, risk_before);
+    apply_key_order(encounters, keys);
+}
+
+void sort_encounters_by_time(Encounter* encounters, size_t count, unsigned threads) {
+    NOVA_SCOPE("sort_encounters_by_time");
+    vector<TimeKey> keys(count);
+    for (size_t e = 0; e < count; ++e) {
+        const Encounter& x = encounters[e];
+        keys[e] = {x.t, x.aIndex, x.bIndex, static_cast<uint32_t>(e)};
+    }
+    parallel_sort(keys, threads, time_before);
+    apply_key_order(encounters, keys);
+}
+
+size_t filter_by_probability(Encounter* encounters, size_t count, double min_probability) {
+    size_t kept = 0;
+    for (size_t e = 0; e < count; ++e) {
+        if (passes_probability(encounters[e], min_probability)) encounters[kept++] = encounters[e];
+    }
+    return kept;
+}
+
+vector<Encounter> top_encounters_by_risk(const Encounter* encounters, size_t count, size_t k,
+                                         double min_probability, unsigned threads) {
+    NOVA_SCOPE("top_encounters_by_risk");
+    vector<Encounter> out;
+    if (k == 0 || count == 0) return out;
+
+    // Each worker filters its share into at most 2k keys: once full, the k
+    // best are kept and the k-th becomes the bar later keys must beat
+    threads = resolve_thread_count(threads);
+    vector<vector<RiskKey>> best(threads);
+    vector<char> pruned(threads, 0);
+    auto prune = [&](unsigned w) {
+        vector<RiskKey>& keys = best[w];
+        nth_element(keys.begin(), keys.begin() + (k - 1), keys.end(), risk_before);
+        keys.resize(k);
+        pruned[w] = 1;
+    };
+    parallel_for_chunks(count, SORT_RUN, threads, [&](unsigned w, size_t begin, size_t end) {
+        vector<RiskKey>& keys = best[w];
+        for (size_t e = begin; e < end; ++e) {
+            if (!passes_probability(encounters[e], min_probability)) continue;
+            const RiskKey key = risk_key(encounters[e], e);
+            if (pruned[w] && !risk_before(key, keys[k - 1])) continue;
+            keys.push_back(key);
+            if (keys.size() == 2 * k) prune(w);
+        }
+    });
+
+    vector<RiskKey> keys;
+    for (const vector<RiskKey>& worker : best) keys.insert(keys.end(), worker.begin(), worker.end());
+    const size_t kept = min(k, keys.size());
+    partial_sort(keys.begin(), keys.begin() + kept, keys.end(), risk_before);
+    out.reserve(kept);
+    for (size_t e = 0; e < kept; ++e) out.push_back(encounters[keys[e].index]);
+    return out;
+}
@@ -0,0 +1,251 @@
+#include "screening_session.h"
+#include "instrumentation.h"
+#include <cstring>
+
+namespace {
+
+uint64_t encounter_key(const Encounter& e) {
+    return (static_cast<uint64_t>(e.aIndex) << 32) | e.bIndex;
+}
+
+bool same_encounter(const Encounter& a, const Encounter& b) {
+    const bool samePc = a.pc == b.pc || (std::isnan(a.pc) && std::isnan(b.pc));
+    return a.t == b.t && a.miss_m == b.miss_m && a.rel_mps == b.rel_mps &&
+           a.severity == b.severity && samePc;
+}
+
+bool by_pair(const Encounter& a, const Encounter& b) {
+    return a.aIndex < b.aIndex || (a.aIndex == b.aIndex && a.bIndex < b.bIndex);
+}
+
+// Compare re-screened pairs against their previous encounters (consumed)
+void diff_encounters(unordered_map<uint64_t, Encounter>& before, const vector<Encounter>& fresh,
+                     EncounterDiff& diff) {
+    for (const Encounter& e : fresh) {
+        auto old = before.find(encounter_key(e));
+        if (old == before.end()) {
+            diff.added.push_back(e);
+        } else {
+            if (!same_encounter(old->second, e)) {
+                diff.changed.push_back(e);
+                diff.previous.push_back(old->second);
+            }
+            before.erase(old);
+        }
+    }
+    for (const auto& kv : before) diff.removed.push_back(kv.second);
+    sort(diff.removed.begin(), diff.removed.end(), by_pair);
+}
+
+// Objects whose TLEs were applied by one update
+struct AppliedUpdate {
+    vector<uint32_t> objects;           // store indices, ascending
+    vector<OrbitalElements> elements;   // parallel to objects
+};
+
+} // namespace
+
+int session_open(ScreeningSession& session, const PipelineCatalog& catalog,
+                 double startMs, double stepSeconds, double durationHours,
+                 double threshold_m, const ScreeningOptions& options) {
+    const size_t n = catalog.elements.size();
+    const size_t steps = window_steps(stepSeconds, durationHours);
+    if (!steps || !(threshold_m >= 0.0) ||
+        catalog.ids.size() != n || catalog.isDebris.size() != n ||
+        catalog.catalogNumbers.size() != n || n > numeric_limits<uint32_t>::max()) {
+        return SESSION_ERROR_INVALID_INPUT;
+    }
+
+    store_resize(session.store, n, steps);
+    for (size_t i = 0; i < n; ++i) {
+        store_add_id(session.store, i, catalog.ids[i], catalog.isDebris[i]);
+    }
+    propagate_batch(catalog.elements.data(), n, startMs, stepSeconds, steps,
+                    session.store, options.threads);
+
+    session.elements = catalog.elements;
+    session.catalogNumbers = catalog.catalogNumbers;
+    session.byCatalogNumber.clear();
+    for (size_t i = 0; i < n; ++i) {
+        // Later records with the same number win, as they would in an update
+        if (catalog.catalogNumbers[i]) session.byCatalogNumber[catalog.catalogNumbers[i]] = static_cast<uint32_t>(i);
+    }
+
+    session.threshold_m = threshold_m;
+    session.options = options;
+    session.options.prefilter = nullptr;
+    screening_index_build(session.index, session.store,
+                          screening_candidate_distance(threshold_m, session.options), options.threads);
+
+    session.encounters.clear();
+    for (const Encounter& e : screen_by_threshold(session.store, threshold_m, session.options)) {
+        session.encounters.emplace(encounter_key(e), e);
+    }
+    return SESSION_SUCCESS;
+}
+
+int session_update(ScreeningSession& session, const vector<TLE>& updates, EncounterDiff& diff) {
+    NOVA_SCOPE("session_update");
+    diff = EncounterDiff();
+
+    // Parse everything first so a bad record leaves the session untouched
+    vector<OrbitalElements> parsed(updates.size());
+    vector<uint32_t> numbers(updates.size());
+    for (size_t u = 0; u < updates.size(); ++u) {
+        const TLE& tle = updates[u];
+        numbers[u] = tle_catalog_number(tle.line1, strnlen(tle.line1, sizeof(tle.line1)));
+        if (!numbers[u] || tle_to_elements(&tle, &parsed[u]) != PROPAGATION_SUCCESS) {
+            return SESSION_ERROR_INVALID_INPUT;
+        }
+    }
+
+    // Resolve every update to a store index, appending unknown objects
+    unordered_map<uint32_t, size_t> latest; // store index -> position in updates
+    vector<uint32_t> appended;
+    for (size_t u = 0; u < updates.size(); ++u) {
+        const uint32_t number = numbers[u];
+        auto it = session.byCatalogNumber.find(number);
+        uint32_t i;
+        if (it != session.byCatalogNumber.end()) {
+            i = it->second;
+        } else {
+            i = static_cast<uint32_t>(session.catalogNumbers.size());
+            session.byCatalogNumber.emplace(number, i);
+            session.catalogNumbers.push_back(number);
+            session.elements.push_back(OrbitalElements());
+            appended.push_back(static_cast<uint32_t>(u));
+        }
+        latest[i] = u;
+    }
+    if (latest.empty()) return SESSION_SUCCESS;
+
+    const size_t oldCount = session.store.count;
+    if (session.catalogNumbers.size() > oldCount) {
+        store_grow(session.store, session.catalogNumbers.size());
+        for (size_t a = 0; a < appended.size(); ++a) {
+            store_add_id(session.store, oldCount + a, updates[appended[a]].name, false);
+        }
+    }
+
+    AppliedUpdate applied;
+    for (const auto& kv : latest) applied.objects.push_back(kv.first);
+    sort(applied.objects.begin(), applied.objects.end());
+    for (uint32_t i : applied.objects) {
+        session.elements[i] = parsed[latest[i]];
+        applied.elements.push_back(session.elements[i]);
+    }
+
+    propagate_objects(applied.elements.data(), applied.objects.data(), applied.objects.size(),
+                      session.store, session.options.threads);
+    screening_index_update(session.index, session.store, applied.objects, session.options.threads);
+    vector<Encounter> fresh = screen_objects(session.store, session.index, applied.objects,
+                                             session.threshold_m, session.options);
+
+    // Previous encounters of every pair that was re-screened
+    vector<char> touched(session.store.count, 0);
+    for (uint32_t i : applied.objects) touched[i] = 1;
+    unordered_map<uint64_t, Encounter> before;
+    for (auto it = session.encounters.begin(); it != session.encounters.end();) {
+        if (touched[it->second.aIndex] || touched[it->second.bIndex]) {
+            before.emplace(it->first, it->second);
+            it = session.encounters.erase(it);
+        } else {
+            ++it;
+        }
+    }
+
+    diff_encounters(before, fresh, diff);
+    for (const Encounter& e : fresh) session.encounters.emplace(encounter_key(e), e);
+    return SESSION_SUCCESS;
+}
+
+int session_what_if(ScreeningSession& session, uint32_t catalogNumber,
+                    const vector<Maneuver>& maneuvers, vector<ManeuverWhatIf>& out) {
+    NOVA_SCOPE("session_what_if");
+    out.clear();
+    auto found = session.byCatalogNumber.find(catalogNumber);
+    if (found == session.byCatalogNumber.end()) return SESSION_ERROR_INVALID_INPUT;
+    const uint32_t i = found->second;
+    const OrbitalElements& el = session.elements[i];
+    TrajectoryStore& store = session.store;
+
+    // Post-burn trajectory of every maneuver, before anything is touched
+    vector<size_t> firstSteps(maneuvers.size());
+    vector<vector<StateVectorECI>> offsets(maneuvers.size());
+    vector<double> timesJd(store.steps);
+    for (size_t k = 0; k < store.steps; ++k) timesJd[k] = unix_ms_to_jd(store.time(k));
+    for (size_t w = 0; w < maneuvers.size(); ++w) {
+        const Maneuver& m = maneuvers[w];
+        if (!std::isfinite(m.epoch)) return SESSION_ERROR_INVALID_INPUT;
+        const size_t first = store_step_lower_bound(store, jd_to_unix_ms(m.epoch));
+        firstSteps[w] = first;
+
+        // Offset of the post-burn orbit from the coasting one, both re-propagated
+        // from the burn; drag terms and the element epoch cancel in the difference
+        StateVectorECI pre, post;
+        if (propagate(&el, (m.epoch - el.epoch) * MINUTES_PER_DAY, &pre) != PROPAGATION_SUCCESS) {
+            return SESSION_ERROR_INVALID_INPUT;
+        }
+        apply_maneuver(&el, &m, jd_to_unix_ms(m.epoch), &post);
+        OrbitalElements coastEl, burnEl;
+        if (state_to_elements(&pre, &coastEl) != PROPAGATION_SUCCESS ||
+            state_to_elements(&post, &burnEl) != PROPAGATION_SUCCESS) {
+            return SESSION_ERROR_INVALID_INPUT;
+        }
+        const size_t n = store.steps - first;
+        vector<StateVectorECI> coast(n);
+        offsets[w].resize(n);
+        if (n && (propagate_grid(&coastEl, 1, timesJd.data() + first, n, coast.data()) != PROPAGATION_SUCCESS ||
+                  propagate_grid(&burnEl, 1, timesJd.data() + first, n, offsets[w].data()) != PROPAGATION_SUCCESS)) {
+            return SESSION_ERROR_INVALID_INPUT;
+        }
+        for (size_t k = 0; k < n; ++k) {
+            for (int d = 0; d < 3; ++d) {
+                offsets[w][k].r[d] -= coast[k].r[d];
+                offsets[w][k].v[d] -= coast[k].v[d];
+            }
+        }
+    }
+
+    // Cached states of the object, written back after each what-if
+    vector<State> saved(store.steps);
+    for (size_t k = 0; k < store.steps; ++k) saved[k] = store_state(store, i, k);
+
+    unordered_map<uint64_t, Encounter> current;
+    for (const auto& kv : session.encounters) {
+        if (kv.second.aIndex == i || kv.second.bIndex == i) current.emplace(kv.first, kv.second);
+    }
+
+    const vector<uint32_t> objects = {i};
+    out.resize(maneuvers.size());
+    for (size_t w = 0; w < maneuvers.size(); ++w) {
+        for (size_t k = 0; k < store.steps; ++k) {
+            State s = saved[k];
+            if (k >= firstSteps[w]) {
+                const StateVectorECI& d = offsets[w][k - firstSteps[w]];
+                s.x += d.r[0]; s.y += d.r[1]; s.z += d.r[2];
+                s.vx += d.v[0]; s.vy += d.v[1]; s.vz += d.v[2];
+            }
+            store_set_state(store, i, k, s);
+        }
+        screening_index_update(session.index, store, objects, session.options.threads);
+        out[w].encounters = screen_objects(store, session.index, objects, session.threshold_m,
+                                           session.options);
+        unordered_map<uint64_t, Encounter> before = current;
+        diff_encounters(before, out[w].encounters, out[w].diff);
+    }
+
+    for (size_t k = 0; k < store.steps; ++k) store_set_state(store, i, k, saved[k]);
+    if (!maneuvers.empty()) {
+        screening_index_update(session.index, store, objects, session.options.threads);
+    }
+    return SESSION_SUCCESS;
+}
+
+vector<Encounter> session_encounters(const ScreeningSession& session) {
+    vector<Encounter> out;
+    out.reserve(session.encounters.size());
+    for (const auto& kv : session.encounters) out.push_back(kv.second);
+    sort(out.begin(), out.end(), by_pair);
+    return out;
+}
@@ -0,0 +1,444 @@
+#include "sharding.h"
+#include "ephemeris.h"
+#include "mapped_file.h"
+#include "track_export.h"
+#include "orbit_prefilter.h"
+#include "collision_probability.h"
+#include "parallel.h"
+#include "instrumentation.h"
+#include <cstdlib>
+#include <cstring>
+#include <mutex>
+#include <filesystem>
+
+namespace fs = std::filesystem;
+
+namespace {
+
+const char SHARD_MAGIC[8] = {'O', 'G', 'S', 'H', 'A', 'R', 'D', '\0'};
+
+// Worker config the coordinator writes into the shard directory
+const char* const SHARD_CONFIG = "shard.cfg";
+
+// FNV-1a step over one 64-bit value
+uint64_t mix_key(uint64_t h, uint64_t v) {
+    for (int b = 0; b < 8; ++b) {
+        h ^= (v >> (8 * b)) & 0xff;
+        h *= 1099511628211ull;
+    }
+    return h;
+}
+
+// Key of a run: the inputs and grid behind the ephemeris key, plus the block split
+uint64_t run_key(const PipelineConfig& config, const ShardPlan& plan) {
+    vector<string> paths;
+    for (const CatalogInput& input : config.catalogs) paths.push_back(input.path);
+    uint64_t key = ephemeris_key(paths, config.startEpochMs, config.stepSeconds, config.durationHours);
+    for (size_t begin : plan.blockBegin) key = mix_key(key, begin);
+    return key;
+}
+
+uint64_t block_key(uint64_t runKey, size_t block) {
+    return mix_key(runKey, 0x424c4f434bull + block); // "BLOCK"
+}
+
+size_t block_size(const ShardPlan& plan, size_t b) {
+    return plan.blockBegin[b + 1] - plan.blockBegin[b];
+}
+
+// Objects [begin, end) of a catalog
+PipelineCatalog catalog_slice(const PipelineCatalog& catalog, size_t begin, size_t end) {
+    PipelineCatalog out;
+    out.ids.assign(catalog.ids.begin() + begin, catalog.ids.begin() + end);
+    out.isDebris.assign(catalog.isDebris.begin() + begin, catalog.isDebris.begin() + end);
+    out.catalogNumbers.assign(catalog.catalogNumbers.begin() + begin, catalog.catalogNumbers.begin() + end);
+    out.elements.assign(catalog.elements.begin() + begin, catalog.elements.begin() + end);
+    return out;
+}
+
+// "propagate:B" or "screen:A:B"
+bool parse_task(const string& task, const ShardPlan& plan, bool& screen, size_t& a, size_t& b) {
+    const size_t blocks = plan.blockBegin.size() - 1;
+    unsigned long x = 0, y = 0;
+    char tail = 0;
+    if (sscanf(task.c_str(), "propagate:%lu%c", &x, &tail) == 1) {
+        screen = false;
+        a = b = x;
+        return x < blocks;
+    }
+    if (sscanf(task.c_str(), "screen:%lu:%lu%c", &x, &y, &tail) == 2) {
+        screen = true;
+        a = x;
+        b = y;
+        return x <= y && y < blocks;
+    }
+    return false;
+}
+
+int load_inputs(const PipelineConfig& config, PipelineCatalog& catalog, ShardPlan& plan) {
+    if (load_catalog_inputs(config.catalogs, catalog) != PROPAGATION_SUCCESS) {
+        cout << "Could not open every input catalog" << endl;
+        return SHARD_ERROR_IO;
+    }
+    if (catalog.ids.size() < config.shardBlocks) {
+        cout << "Fewer objects (" << catalog.ids.size() << ") than shards" << endl;
+        return SHARD_ERROR_INVALID_INPUT;
+    }
+    plan_shards(catalog.ids.size(), config.shardBlocks, plan);
+    return SHARD_SUCCESS;
+}
+
+int propagate_block(const PipelineConfig& config, const PipelineCatalog& catalog,
+                    const ShardPlan& plan, uint64_t runKey, size_t b) {
+    NOVA_SCOPE("shard_propagate");
+    const string path = shard_block_path(pipeline_shard_dir(config), b);
+    const uint64_t key = block_key(runKey, b);
+    TrajectoryStore store;
+    if (read_ephemeris(path, store, key) == EPHEMERIS_SUCCESS && store.count == block_size(plan, b)) {
+        cout << "Block " << b << " already propagated in " << path << endl;
+        return SHARD_SUCCESS;
+    }
+
+    const PipelineCatalog slice = catalog_slice(catalog, plan.blockBegin[b], plan.blockBegin[b + 1]);
+    propagate_catalog(slice, config.startEpochMs, config.stepSeconds, config.durationHours,
+                      store, config.threads);
+    const string tmp = temp_file_path(path);
+    if (write_ephemeris(tmp, store, key) != EPHEMERIS_SUCCESS || !commit_file(tmp, path)) {
+        cout << "Could not write " << path << endl;
+        return SHARD_ERROR_IO;
+    }
+    cout << "Propagated block " << b << " (" << store.count << " objects) to " << path << endl;
+    return SHARD_SUCCESS;
+}
+
+// Blocks side by side in one store, ids and flags from the catalog
+int load_blocks(const PipelineConfig& config, const PipelineCatalog& catalog, const ShardPlan& plan,
+                uint64_t runKey, const vector<size_t>& blocks, TrajectoryStore& store) {
+    const string dir = pipeline_shard_dir(config);
+    size_t total = 0;
+    for (size_t b : blocks) total += block_size(plan, b);
+
+    size_t offset = 0;
+    for (size_t n = 0; n < blocks.size(); ++n) {
+        const size_t b = blocks[n];
+        const string path = shard_block_path(dir, b);
+        TrajectoryStore block;
+        if (read_ephemeris(path, block, block_key(runKey, b)) != EPHEMERIS_SUCCESS ||
+            block.count != block_size(plan, b)) {
+            cout << "Missing or stale block " << path << endl;
+            return SHARD_ERROR_FORMAT;
+        }
+        if (n == 0) {
+            store_resize(store, total, block.steps);
+            store.times = block.times;
+        } else if (block.times != store.times) {
+            cout << "Block " << path << " is on a different time grid" << endl;
+            return SHARD_ERROR_FORMAT;
+        }
+        for (int c = 0; c < STORE_COMPONENTS; ++c) {
+            for (size_t k = 0; k < store.steps; ++k) {
+                memcpy(store.row(c, k) + offset, block.row(c, k), block.count * sizeof(double));
+            }
+        }
+        for (size_t i = 0; i < block.count; ++i) {
+            const size_t g = plan.blockBegin[b] + i;
+            store_add_id(store, offset + i, catalog.ids[g], catalog.isDebris[g]);
+        }
+        offset += block.count;
+    }
+    return SHARD_SUCCESS;
+}
+
+int screen_tile(const PipelineConfig& config, const PipelineCatalog& catalog, const ShardPlan& plan,
+                uint64_t runKey, size_t a, size_t b) {
+    NOVA_SCOPE("shard_screen");
+    const vector<size_t> blocks = a == b ? vector<size_t>{a} : vector<size_t>{a, b};
+    TrajectoryStore store;
+    const int status = load_blocks(config, catalog, plan, runKey, blocks, store);
+    if (status != SHARD_SUCCESS) return status;
+
+    vector<OrbitalElements> elements;
+    for (size_t blk : blocks) {
+        elements.insert(elements.end(), catalog.elements.begin() + plan.blockBegin[blk],
+                        catalog.elements.begin() + plan.blockBegin[blk + 1]);
+    }
+
+    // Off-diagonal tiles only own the pairs that cross between the two blocks
+    ScreeningOptions screening;
+    PcOptions probability;
+    pipeline_screening_options(config, probability, screening);
+    screening.splitIndex = a == b ? 0 : static_cast<uint32_t>(block_size(plan, a));
+    PairPrefilter prefilter;
+    if (pipeline_prefilter(config, elements, prefilter)) screening.prefilter = &prefilter;
+
+    vector<EncounterTier> tiers;
+    if (config.jobs.size() == 1) {
+        const double threshold_m = config.jobs[0].threshold_m;
+        tiers.push_back({threshold_m, screen_by_threshold(store, threshold_m, screening)});
+    } else {
+        vector<double> thresholds;
+        for (const ScreeningJob& job : config.jobs) thresholds.push_back(job.threshold_m);
+        tiers = screen_by_thresholds(store, thresholds, screening);
+    }
+
+    // Back to catalog indices
+    const size_t sizeA = block_size(plan, a);
+    auto global = [&](uint32_t local) {
+        return static_cast<uint32_t>(local < sizeA ? plan.blockBegin[a] + local
+                                                   : plan.blockBegin[b] + (local - sizeA));
+    };
+    size_t found = 0;
+    for (EncounterTier& tier : tiers) {
+        for (Encounter& e : tier.encounters) {
+            e.aIndex = global(e.aIndex);
+            e.bIndex = global(e.bIndex);
+        }
+        found += tier.encounters.size();
+    }
+
+    ShardStreamHeader header;
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, SHARD_MAGIC, sizeof(SHARD_MAGIC));
+    header.version = SHARD_STREAM_VERSION;
+    header.tiers = static_cast<uint32_t>(tiers.size());
+    header.key = runKey;
+    header.startMs = store.steps ? store.time(0) : 0.0;
+    header.stopMs = store.steps ? store.time(store.steps - 1) : 0.0;
+    const string path = shard_tile_path(pipeline_shard_dir(config), a, b);
+    if (write_shard_stream(path, header, tiers) != SHARD_SUCCESS) {
+        cout << "Could not write " << path << endl;
+        return SHARD_ERROR_IO;
+    }
+    cout << "Screened tile " << a << "," << b << ": " << found << " encounters to " << path << endl;
+    return SHARD_SUCCESS;
+}
+
+// Single-quoted for /bin/sh
+string shell_quote(const string& text) {
+    string out = "'";
+    for (char c : text) {
+        if (c == '\'') out += "'\\''";
+        else out += c;
+    }
+    return out + "'";
+}
+
+// Run every task as a worker process, up to `parallel` at a time
+bool run_workers(const PipelineConfig& config, const string& program, const string& configPath,
+                 const vector<string>& tasks, unsigned parallel) {
+    const string dir = pipeline_shard_dir(config);
+    mutex lock;
+    vector<string> failed;
+    parallel_for_chunks(tasks.size(), 1, parallel, [&](unsigned, size_t begin, size_t end) {
+        for (size_t t = begin; t < end; ++t) {
+            string log = tasks[t];
+            replace(log.begin(), log.end(), ':', '_');
+            log = (fs::path(dir) / (log + ".log")).string();
+            string command = config.shardLauncher.empty() ? string() : config.shardLauncher + " ";
+            command += shell_quote(program) + " --config " + shell_quote(configPath) +
+                       " --shard-task " + tasks[t] + " > " + shell_quote(log) + " 2>&1";
+            if (system(command.c_str()) != 0) {
+                lock_guard<mutex> guard(lock);
+                failed.push_back(tasks[t] + " (see " + log + ")");
+            }
+        }
+    });
+    sort(failed.begin(), failed.end());
+    for (const string& f : failed) cout << "Worker failed: " << f << endl;
+    return failed.empty();
+}
+
+} // namespace
+
+void plan_shards(size_t objects, size_t blocks, ShardPlan& out) {
+    if (blocks == 0) blocks = 1;
+    if (blocks > objects && objects > 0) blocks = objects;
+    out.blockBegin.resize(blocks + 1);
+    for (size_t b = 0; b <= blocks; ++b) out.blockBegin[b] = objects * b / blocks;
+    out.tiles.clear();
+    for (size_t a = 0; a < blocks; ++a) {
+        for (size_t b = a; b < blocks; ++b) {
+            out.tiles.push_back({static_cast<uint32_t>(a), static_cast<uint32_t>(b)});
+        }
+    }
+}
+
+string shard_block_path(const string& dir, size_t block) {
+    return (fs::path(dir) / ("block_" + to_string(block) + ".eph")).string();
+}
+
+string shard_tile_path(const string& dir, size_t a, size_t b) {
+    return (fs::path(dir) / ("tile_" + to_string(a) + "_" + to_string(b) + ".enc")).string();
+}
+
+int write_shard_stream(const string& path, const ShardStreamHeader& header,
+                       const vector<EncounterTier>& tiers) {
+    const string tmp = temp_file_path(path);
+    {
+        ofstream out(tmp, ios::binary | ios::trunc);
+        if (!out.is_open()) return SHARD_ERROR_IO;
+        out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+        vector<ShardRecord> records;
+        for (const EncounterTier& tier : tiers) {
+            const uint64_t count = tier.encounters.size();
+            out.write(reinterpret_cast<const char*>(&tier.threshold_m), sizeof(double));
+            out.write(reinterpret_cast<const char*>(&count), sizeof(count));
+            records.resize(count);
+            for (size_t e = 0; e < count; ++e) {
+                const Encounter& enc = tier.encounters[e];
+                records[e] = {enc.aIndex, enc.bIndex, enc.t, enc.miss_m, enc.rel_mps, enc.pc,
+                              static_cast<int32_t>(enc.severity), 0};
+            }
+            out.write(reinterpret_cast<const char*>(records.data()), count * sizeof(ShardRecord));
+        }
+        NOVA_COUNT(COUNTER_BYTES_WRITTEN, static_cast<uint64_t>(out.tellp()));
+        out.flush();
+        if (!out) return SHARD_ERROR_IO;
+    }
+    return commit_file(tmp, path) ? SHARD_SUCCESS : SHARD_ERROR_IO;
+}
+
+int read_shard_stream(const string& path, uint64_t expectedKey, ShardStreamHeader& header,
+                      vector<EncounterTier>& tiers) {
+    ifstream in(path, ios::binary);
+    if (!in.is_open()) return SHARD_ERROR_IO;
+    if (!in.read(reinterpret_cast<char*>(&header), sizeof(header)) ||
+        memcmp(header.magic, SHARD_MAGIC, sizeof(SHARD_MAGIC)) != 0 ||
+        header.version != SHARD_STREAM_VERSION || header.key != expectedKey) {
+        return SHARD_ERROR_FORMAT;
+    }
+
+    tiers.assign(header.tiers, EncounterTier());
+    vector<ShardRecord> records;
+    for (EncounterTier& tier : tiers) {
+        uint64_t count = 0;
+        if (!in.read(reinterpret_cast<char*>(&tier.threshold_m), sizeof(double)) ||
+            !in.read(reinterpret_cast<char*>(&count), sizeof(count)) ||
+            count > (1ull << 40) / sizeof(ShardRecord)) {
+            return SHARD_ERROR_FORMAT;
+        }
+        records.resize(count);
+        if (!in.read(reinterpret_cast<char*>(records.data()), count * sizeof(ShardRecord))) {
+            return SHARD_ERROR_FORMAT;
+        }
+        tier.encounters.resize(count);
+        for (size_t e = 0; e < count; ++e) {
+            Encounter& enc = tier.encounters[e];
+            enc.aIndex = records[e].aIndex;
+            enc.bIndex = records[e].bIndex;
+            enc.t = records[e].t;
+            enc.miss_m = records[e].miss_m;
+            enc.rel_mps = records[e].rel_mps;
+            enc.pc = records[e].pc;
+            enc.severity = records[e].severity;
+        }
+    }
+    return SHARD_SUCCESS;
+}
+
+int run_shard_task(const PipelineConfig& config) {
+    NOVA_SCOPE("run_shard_task");
+    PipelineCatalog catalog;
+    ShardPlan plan;
+    int status = load_inputs(config, catalog, plan);
+    if (status != SHARD_SUCCESS) return status;
+
+    bool screen = false;
+    size_t a = 0, b = 0;
+    if (!parse_task(config.shardTask, plan, screen, a, b)) {
+        cout << "Invalid shard task " << config.shardTask << endl;
+        return SHARD_ERROR_INVALID_INPUT;
+    }
+    const uint64_t key = run_key(config, plan);
+    return screen ? screen_tile(config, catalog, plan, key, a, b)
+                  : propagate_block(config, catalog, plan, key, a);
+}
+
+int run_sharded(const PipelineConfig& config, const string& program) {
+    NOVA_SCOPE("run_sharded");
+    PipelineCatalog catalog;
+    ShardPlan plan;
+    int status = load_inputs(config, catalog, plan);
+    if (status != SHARD_SUCCESS) return status;
+    const size_t blocks = plan.blockBegin.size() - 1;
+    cout << "Sharded run: " << catalog.ids.size() << " objects in " << blocks << " blocks, "
+         << plan.tiles.size() << " tiles" << endl;
+
+    // Workers share the coordinator's settings; local workers split the cores
+    const string dir = pipeline_shard_dir(config);
+    error_code ec;
+    fs::create_directories(dir, ec);
+    const unsigned parallel = resolve_thread_count(config.shardParallel);
+    PipelineConfig workerConfig = config;
+    workerConfig.profilePrefix.clear();
+    if (workerConfig.threads == 0 && config.shardLauncher.empty()) {
+        workerConfig.threads = max(1u, resolve_thread_count(0) / parallel);
+    }
+    const string configPath = (fs::path(dir) / SHARD_CONFIG).string();
+    if (write_pipeline_config(configPath, workerConfig) != PIPELINE_SUCCESS) {
+        cout << "Could not write " << configPath << endl;
+        return SHARD_ERROR_IO;
+    }
+
+    vector<string> tasks;
+    for (size_t b = 0; b < blocks; ++b) tasks.push_back("propagate:" + to_string(b));
+    if (!run_workers(config, program, configPath, tasks, parallel)) return SHARD_ERROR_WORKER;
+    tasks.clear();
+    for (const auto& tile : plan.tiles) {
+        tasks.push_back("screen:" + to_string(tile.first) + ":" + to_string(tile.second));
+    }
+    if (!run_workers(config, program, configPath, tasks, parallel)) return SHARD_ERROR_WORKER;
+
+    // Merge: each pair lives in exactly one tile, so concatenating is enough;
+    // the writer puts the result in time, then index, order
+    const uint64_t key = run_key(config, plan);
+    vector<vector<Encounter>> merged(config.jobs.size());
+    double startMs = 0.0, stopMs = 0.0;
+    for (const auto& tile : plan.tiles) {
+        const string path = shard_tile_path(dir, tile.first, tile.second);
+        ShardStreamHeader header;
+        vector<EncounterTier> tiers;
+        if (read_shard_stream(path, key, header, tiers) != SHARD_SUCCESS) {
+            cout << "Missing or stale tile " << path << endl;
+            return SHARD_ERROR_FORMAT;
+        }
+        startMs = header.startMs;
+        stopMs = header.stopMs;
+        for (size_t j = 0; j < config.jobs.size(); ++j) {
+            for (const EncounterTier& tier : tiers) {
+                if (tier.threshold_m != config.jobs[j].threshold_m) continue;
+                merged[j].insert(merged[j].end(), tier.encounters.begin(), tier.encounters.end());
+                break;
+            }
+        }
+    }
+    for (size_t j = 0; j < config.jobs.size(); ++j) {
+        const string path = pipeline_conjunctions_path(config, j);
+        const fs::path parent = fs::path(path).parent_path();
+        if (!parent.empty()) fs::create_directories(parent, ec);
+        const bool ranked = pipeline_rank_encounters(config, merged[j]);
+        if (!writeEncountersJSON(path, merged[j], catalog.ids, startMs, stopMs, !ranked)) {
+            return SHARD_ERROR_IO;
+        }
+        cout << "Wrote " << merged[j].size() << " conjunctions to " << path << endl;
+    }
+
+    if (config.writeTracks) {
+        vector<size_t> all(blocks);
+        for (size_t b = 0; b < blocks; ++b) all[b] = b;
+        TrajectoryStore store;
+        status = load_blocks(config, catalog, plan, key, all, store);
+        if (status != SHARD_SUCCESS) return status;
+        const string json = (fs::path(config.outputDir) / "coordinates.json").string();
+        const string blob = (fs::path(config.outputDir) / "coordinates.bin").string();
+        fs::create_directories(config.outputDir, ec);
+        TrackExportOptions jsonExport;
+        jsonExport.stride = config.trackJsonStride;
+        if (write_tracks_json(json, store, jsonExport) != TRACK_EXPORT_SUCCESS ||
+            write_tracks_blob(blob, store) != TRACK_EXPORT_SUCCESS) {
+            cout << "Could not write " << json << " / " << blob << endl;
+            return SHARD_ERROR_IO;
+        }
+    }
+    return SHARD_SUCCESS;
+}
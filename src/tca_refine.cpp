@@ -0,0 +1,281 @@
+#include "tca_refine.h"
+#include "constants.h"
+#include "distance_kernel.h"
+
+namespace {
+
+// Relative state of j with respect to i at one sample (km, km/s)
+struct Relative {
+    double r[3];
+    double v[3];
+};
+
+bool relative_at(const TrajectoryStore& store, size_t i, size_t j, size_t k, Relative& out) {
+    for (int c = 0; c < 3; ++c) {
+        const double* p = store.row(STORE_X + c, k);
+        const double* v = store.row(STORE_VX + c, k);
+        out.r[c] = p[j] - p[i];
+        out.v[c] = v[j] - v[i];
+        if (!std::isfinite(out.r[c]) || !std::isfinite(out.v[c])) return false;
+    }
+    return true;
+}
+
+double dot3(const double* a, const double* b) {
+    return a[0] * b[0] + a[1] * b[1] + a[2] * b[2];
+}
+
+double length3(const double* a) {
+    return sqrt(dot3(a, a));
+}
+
+// Distance in metres, computed the same way as the screening narrow phase
+double distance_m(const Relative& rel) {
+    return separation_m(rel.r[0], rel.r[1], rel.r[2]);
+}
+
+// Range rate sign at a sample: > 0 receding, <= 0 approaching
+bool receding(const TrajectoryStore& store, size_t i, size_t j, size_t k) {
+    Relative rel;
+    return relative_at(store, i, j, k, rel) && dot3(rel.r, rel.v) > 0.0;
+}
+
+// Cubic Hermite model of relative motion over one step, s in [0, 1]
+struct HermiteSegment {
+    Relative a, b;
+    double h; // step length (s)
+
+    void eval(double s, double* r, double* v) const {
+        const double s2 = s * s, s3 = s2 * s;
+        const double h00 = 2*s3 - 3*s2 + 1, h10 = s3 - 2*s2 + s;
+        const double h01 = -2*s3 + 3*s2,    h11 = s3 - s2;
+        const double d00 = 6*s2 - 6*s,      d10 = 3*s2 - 4*s + 1;
+        const double d01 = -6*s2 + 6*s,     d11 = 3*s2 - 2*s;
+        for (int c = 0; c < 3; ++c) {
+            r[c] = h00 * a.r[c] + h10 * h * a.v[c] + h01 * b.r[c] + h11 * h * b.v[c];
+            v[c] = (d00 * a.r[c] + d01 * b.r[c]) / h + d10 * a.v[c] + d11 * b.v[c];
+        }
+    }
+
+    double range_rate(double s) const {
+        double r[3], v[3];
+        eval(s, r, v);
+        return dot3(r, v);
+    }
+};
+
+// Sample k taken as the closest point
+void sample_estimate(const TrajectoryStore& store, const Relative& rel, size_t k,
+                     size_t passEnd, TcaEstimate& out) {
+    out.t = store.time(k);
+    out.miss_m = distance_m(rel);
+    out.rel_mps = length3(rel.v) * 1000.0;
+    out.passEnd = passEnd;
+}
+
+// Minimum inside [k, k + 1], where the range rate goes from <= 0 to > 0
+void refine_interval(const TrajectoryStore& store, size_t k, const Relative& a,
+                     const Relative& b, TcaEstimate& out) {
+    HermiteSegment seg;
+    seg.a = a;
+    seg.b = b;
+    seg.h = (store.time(k + 1) - store.time(k)) / 1000.0;
+
+    // Illinois (modified regula falsi) on the range rate; converges to well
+    // under a millisecond in a handful of iterations
+    double lo = 0.0, hi = 1.0;
+    double flo = dot3(a.r, a.v), fhi = dot3(b.r, b.v);
+    double s = 0.0;
+    int side = 0;
+    for (int it = 0; it < 60 && flo < 0.0; ++it) {
+        s = (lo * fhi - hi * flo) / (fhi - flo);
+        if (!(s > lo && s < hi)) s = 0.5 * (lo + hi);
+        const double fs = seg.range_rate(s);
+        if (fs > 0.0) {
+            hi = s;
+            fhi = fs;
+            if (side == -1) flo *= 0.5;
+            side = -1;
+        } else {
+            lo = s;
+            flo = fs;
+            if (side == 1) fhi *= 0.5;
+            side = 1;
+        }
+        if ((hi - lo) * seg.h < 1e-4) break;
+    }
+
+    double r[3], v[3];
+    seg.eval(s, r, v);
+    const Relative at = {{r[0], r[1], r[2]}, {v[0], v[1], v[2]}};
+    out.t = store.time(k) + s * seg.h * 1000.0;
+    out.miss_m = distance_m(at);
+    out.rel_mps = length3(v) * 1000.0;
+    out.passEnd = k + 1;
+
+    // The curve is a model: never report worse than the samples themselves
+    const double da = distance_m(a), db = distance_m(b);
+    if (da < out.miss_m) sample_estimate(store, a, k, k + 1, out);
+    if (db < out.miss_m) sample_estimate(store, b, k + 1, k + 1, out);
+}
+
+} // namespace
+
+bool refine_pass_tca(const TrajectoryStore& store, size_t i, size_t j, size_t k,
+                     TcaEstimate& out) {
+    Relative cur;
+    if (k >= store.steps || !relative_at(store, i, j, k, cur)) return false;
+
+    if (dot3(cur.r, cur.v) > 0.0) {
+        // Already receding: the minimum is behind us, if anywhere
+        Relative prev;
+        if (k > 0 && relative_at(store, i, j, k - 1, prev) && dot3(prev.r, prev.v) <= 0.0) {
+            refine_interval(store, k - 1, prev, cur, out);
+        } else {
+            sample_estimate(store, cur, k, k + 1, out);
+        }
+        return true;
+    }
+
+    // Approaching: follow the samples until the range rate turns positive
+    while (k + 1 < store.steps) {
+        Relative next;
+        if (!relative_at(store, i, j, k + 1, next)) break;
+        if (dot3(next.r, next.v) > 0.0) {
+            refine_interval(store, k, cur, next, out);
+            return true;
+        }
+        cur = next;
+        ++k;
+    }
+    sample_estimate(store, cur, k, k + 1, out);
+    return true;
+}
+
+bool find_first_tca(const TrajectoryStore& store, size_t i, size_t j, size_t k,
+                    double threshold_m, double margin_m, TcaEstimate& out,
+                    size_t endStep) {
+    const double candidate_m = threshold_m + margin_m;
+    const size_t last = min(store.steps, endStep);
+    while (k < last) {
+        Relative rel;
+        if (!relative_at(store, i, j, k, rel) || distance_m(rel) > candidate_m) {
+            ++k;
+            continue;
+        }
+        if (!refine_pass_tca(store, i, j, k, out)) return false;
+        if (out.miss_m <= threshold_m) return true;
+
+        // Skip the rest of this pass before looking for the next one
+        k = out.passEnd > k ? out.passEnd : k + 1;
+        while (k < store.steps && receding(store, i, j, k)) ++k;
+    }
+    return false;
+}
+
+size_t find_pass_tcas(const TrajectoryStore& store, size_t i, size_t j, size_t k,
+                      double threshold_m, double margin_m, vector<TcaEstimate>& out,
+                      size_t endStep) {
+    const double candidate_m = threshold_m + margin_m;
+    const size_t last = min(store.steps, endStep);
+    const size_t first = out.size();
+    while (k < last) {
+        Relative rel;
+        if (!relative_at(store, i, j, k, rel) || distance_m(rel) > candidate_m) {
+            ++k;
+            continue;
+        }
+        TcaEstimate tca;
+        if (!refine_pass_tca(store, i, j, k, tca)) break;
+        if (tca.miss_m <= threshold_m) out.push_back(tca);
+
+        k = tca.passEnd > k ? tca.passEnd : k + 1;
+        while (k < store.steps && receding(store, i, j, k)) ++k;
+    }
+    return out.size() - first;
+}
+
+void pass_window(const TrajectoryStore& store, size_t i, size_t j, const TcaEstimate& tca,
+                 double threshold_m, double& entry, double& exit) {
+    entry = exit = tca.t;
+    if (store.steps < 2) return;
+
+    // Sample distance, or +inf where a state is not finite (treated as outside)
+    auto sample_m = [&](size_t k) {
+        Relative rel;
+        return relative_at(store, i, j, k, rel) ? distance_m(rel) : numeric_limits<double>::infinity();
+    };
+
+    // Crossing inside [k, k + 1] between s = in (within threshold) and s = out
+    auto crossing = [&](size_t k, double in, double out) {
+        HermiteSegment seg;
+        seg.h = (store.time(k + 1) - store.time(k)) / 1000.0;
+        if (!relative_at(store, i, j, k, seg.a) || !relative_at(store, i, j, k + 1, seg.b)) {
+            return store.time(k) + in * seg.h * 1000.0;
+        }
+        while (fabs(out - in) * seg.h > 1e-3) {
+            const double s = 0.5 * (in + out);
+            double r[3], v[3];
+            seg.eval(s, r, v);
+            const Relative at = {{r[0], r[1], r[2]}, {v[0], v[1], v[2]}};
+            if (distance_m(at) <= threshold_m) in = s; else out = s;
+        }
+        return store.time(k) + in * seg.h * 1000.0;
+    };
+
+    // Segment [k0, k0 + 1] holding the closest approach
+    size_t k0 = store_step_upper_bound(store, tca.t);
+    k0 = k0 ? k0 - 1 : 0;
+    if (k0 + 1 >= store.steps) k0 = store.steps - 2;
+    const double s0 = (tca.t - store.time(k0)) / (store.time(k0 + 1) - store.time(k0));
+
+    // Entry: walk back over samples still within threshold, then bisect
+    if (s0 > 0.0 && sample_m(k0) > threshold_m) {
+        entry = crossing(k0, s0, 0.0);
+    } else {
+        size_t k = k0;
+        while (k > 0 && sample_m(k - 1) <= threshold_m) --k;
+        entry = k > 0 && std::isfinite(sample_m(k - 1)) ? crossing(k - 1, 1.0, 0.0) : store.time(k);
+    }
+
+    // Exit: the same forward
+    if (s0 < 1.0 && sample_m(k0 + 1) > threshold_m) {
+        exit = crossing(k0, s0, 1.0);
+    } else {
+        size_t k = k0 + 1;
+        while (k + 1 < store.steps && sample_m(k + 1) <= threshold_m) ++k;
+        exit = k + 1 < store.steps && std::isfinite(sample_m(k + 1)) ? crossing(k, 0.0, 1.0) : store.time(k);
+    }
+    entry = min(entry, tca.t);
+    exit = max(exit, tca.t);
+}
+
+bool interpolate_state(const TrajectoryStore& store, size_t i, double t, double r[3], double v[3]) {
+    if (!store.steps || !(t >= store.time(0)) || !(t <= store.time(store.steps - 1))) return false;
+    size_t k = store_step_upper_bound(store, t);
+    k = k ? k - 1 : 0;
+    if (k + 1 >= store.steps) k = store.steps > 1 ? store.steps - 2 : 0;
+
+    // One object against a fixed origin: the same segment model as a pair
+    HermiteSegment seg;
+    for (int c = 0; c < 3; ++c) {
+        seg.a.r[c] = store.row(STORE_X + c, k)[i];
+        seg.a.v[c] = store.row(STORE_VX + c, k)[i];
+        const size_t k1 = store.steps > 1 ? k + 1 : k;
+        seg.b.r[c] = store.row(STORE_X + c, k1)[i];
+        seg.b.v[c] = store.row(STORE_VX + c, k1)[i];
+        if (!std::isfinite(seg.a.r[c]) || !std::isfinite(seg.a.v[c]) ||
+            !std::isfinite(seg.b.r[c]) || !std::isfinite(seg.b.v[c])) return false;
+    }
+    if (store.steps < 2) {
+        for (int c = 0; c < 3; ++c) { r[c] = seg.a.r[c]; v[c] = seg.a.v[c]; }
+        return true;
+    }
+    seg.h = (store.time(k + 1) - store.time(k)) / 1000.0;
+    seg.eval((t - store.time(k)) / (store.time(k + 1) - store.time(k)), r, v);
+    return true;
+}
+
+double refine_margin_for_step(double stepSeconds) {
+    return MAX_RELATIVE_SPEED_KMS * 1000.0 * stepSeconds * 0.5;
+}
@@ -0,0 +1,145 @@
+#include "tle_catalog.h"
+#include "parallel.h"
+#include "instrumentation.h"
+#include <cstring>
+
+namespace {
+
+// One line of the buffer without its terminator (and without a trailing '\r')
+struct LineSpan {
+    const char* p;
+    size_t n;
+    size_t next; // offset of the following line
+};
+
+inline LineSpan line_at(const char* data, size_t size, size_t pos) {
+    const char* nl = static_cast<const char*>(memchr(data + pos, '\n', size - pos));
+    const size_t end = nl ? static_cast<size_t>(nl - data) : size;
+    size_t n = end - pos;
+    if (n > 0 && data[pos + n - 1] == '\r') --n;
+    return {data + pos, n, nl ? end + 1 : size};
+}
+
+inline bool is_name_line(const LineSpan& line) {
+    return line.n > 0 && line.p[0] != '1' && line.p[0] != '2';
+}
+
+// Same state machine as parseTLEfile, over [begin, end) of the buffer; a record
+// belongs to the range its name line starts in
+void index_records(const char* data, size_t size, size_t begin, size_t end,
+                   vector<TLEView>& out) {
+    TLEView current = {nullptr, nullptr, nullptr, 0, 0, 0};
+    auto complete = [&]() {
+        return current.name && current.line1 && current.line2;
+    };
+
+    size_t pos = begin;
+    while (pos < size) {
+        LineSpan line = line_at(data, size, pos);
+        if (line.n == 0) { pos = line.next; continue; }
+
+        if (is_name_line(line)) {
+            if (pos >= end) break; // next range owns this record
+            if (complete()) out.push_back(current);
+            current = {line.p, nullptr, nullptr, static_cast<uint32_t>(line.n), 0, 0};
+        } else if (line.p[0] == '1') {
+            current.line1 = line.p;
+            current.line1Len = static_cast<uint32_t>(line.n);
+        } else {
+            current.line2 = line.p;
+            current.line2Len = static_cast<uint32_t>(line.n);
+        }
+        pos = line.next;
+    }
+    if (complete()) out.push_back(current);
+}
+
+// First name-line start at or after pos (size when there is none)
+size_t next_record_start(const char* data, size_t size, size_t pos) {
+    if (pos == 0) return 0;
+    // move to the start of the next line
+    const char* nl = static_cast<const char*>(memchr(data + pos - 1, '\n', size - pos + 1));
+    if (!nl) return size;
+    pos = static_cast<size_t>(nl - data) + 1;
+    while (pos < size) {
+        LineSpan line = line_at(data, size, pos);
+        if (is_name_line(line)) return pos;
+        pos = line.next;
+    }
+    return size;
+}
+
+size_t copy_to_cbuf(const char* src, size_t n, char* dst, size_t cap) {
+    if (n + 1 > cap) n = cap - 1;
+    memcpy(dst, src, n);
+    dst[n] = '\0';
+    return n;
+}
+
+// Below this size a single parser pass is faster than splitting
+const size_t PARALLEL_PARSE_MIN_BYTES = 1 << 20;
+
+} // namespace
+
+void close_tle_catalog(TLECatalog& cat) {
+    unmap_file(cat.file);
+    cat.records.clear();
+}
+
+bool open_tle_catalog(const string& filename, TLECatalog& out, unsigned threads) {
+    NOVA_SCOPE("index_tle_catalog");
+    close_tle_catalog(out);
+    if (!map_file(filename, out.file)) return false;
+    const char* data = out.file.data;
+    const size_t size = out.file.size;
+    if (size == 0) return true;
+
+    threads = resolve_thread_count(threads);
+    if (threads == 1 || size < PARALLEL_PARSE_MIN_BYTES) {
+        index_records(data, size, 0, size, out.records);
+        NOVA_COUNT(COUNTER_TLE_RECORDS, out.records.size());
+        return true;
+    }
+
+    // Split the buffer into one range per thread, aligned to record starts
+    vector<size_t> bounds(threads + 1);
+    bounds[0] = 0;
+    bounds[threads] = size;
+    for (unsigned t = 1; t < threads; ++t) {
+        bounds[t] = max(bounds[t - 1], next_record_start(data, size, size / threads * t));
+    }
+
+    vector<vector<TLEView>> parts(threads);
+    parallel_for_chunks(threads, 1, threads, [&](unsigned, size_t begin, size_t end) {
+        for (size_t t = begin; t < end; ++t) {
+            if (bounds[t] < bounds[t + 1]) {
+                index_records(data, size, bounds[t], bounds[t + 1], parts[t]);
+            }
+        }
+    });
+
+    size_t total = 0;
+    for (const auto& part : parts) total += part.size();
+    out.records.reserve(total);
+    for (const auto& part : parts) {
+        out.records.insert(out.records.end(), part.begin(), part.end());
+    }
+    NOVA_COUNT(COUNTER_TLE_RECORDS, total);
+    return true;
+}
+
+void index_tle_buffer(const char* data, size_t size, vector<TLEView>& out) {
+    if (size > 0) index_records(data, size, 0, size, out);
+}
+
+TLE tle_from_view(const TLEView& view) {
+    TLE tle{};
+    tle.name = tle_view_name(view);
+    copy_to_cbuf(view.line1, view.line1Len, tle.line1, sizeof(tle.line1));
+    copy_to_cbuf(view.line2, view.line2Len, tle.line2, sizeof(tle.line2));
+    return tle;
+}
+
+string tle_view_name(const TLEView& view) {
+    return string(view.name, view.nameLen);
+}
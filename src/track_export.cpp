@@ -0,0 +1,191 @@
+#include "track_export.h"
+#include "compact_store.h"
+#include "json_writer.h"
+#include "instrumentation.h"
+#include "mapped_file.h"
+#include <cstring>
+
+namespace {
+
+const char TRACK_BLOB_MAGIC[8] = {'O', 'G', 'T', 'R', 'A', 'C', 'K', '\0'};
+
+// Objects transposed from the time-major store per pass
+const size_t OBJECT_BLOCK = 64;
+
+size_t align16(size_t n) {
+    return (n + 15) & ~static_cast<size_t>(15);
+}
+
+size_t sample_count(size_t steps, uint32_t stride) {
+    return (steps + stride - 1) / stride;
+}
+
+uint32_t object_stride(const vector<bool>& isDebris, const TrackExportOptions& options, size_t i) {
+    uint32_t stride = options.stride;
+    if (isDebris[i] && options.debrisStride) stride = options.debrisStride;
+    if (i < options.objectStride.size() && options.objectStride[i]) stride = options.objectStride[i];
+    return stride ? stride : 1;
+}
+
+// Both writers read a TrajectoryStore or a CompactStore through row(c, k)
+template <typename Store>
+int write_blob(const string& path, const Store& store, const TrackExportOptions& options) {
+    if (!host_little_endian()) return TRACK_EXPORT_ERROR_FORMAT;
+
+    const uint32_t components = options.velocities ? 6 : 3;
+
+    TrackBlobHeader header;
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, TRACK_BLOB_MAGIC, sizeof(header.magic));
+    header.version = TRACK_BLOB_VERSION;
+    header.count = static_cast<uint32_t>(store.count);
+    header.steps = static_cast<uint32_t>(store.steps);
+    header.components = components;
+    header.startMs = store.steps ? store.time(0) : 0.0;
+    header.stepMs = store.steps > 1 ? store.time(1) - store.time(0) : 0.0;
+
+    vector<TrackBlobObject> objects(store.count);
+    string names;
+    uint64_t floats = 0;
+    for (size_t i = 0; i < store.count; ++i) {
+        TrackBlobObject& o = objects[i];
+        o.stride = object_stride(store.isDebris, options, i);
+        o.samples = static_cast<uint32_t>(sample_count(store.steps, o.stride));
+        o.firstFloat = static_cast<uint32_t>(floats);
+        o.nameOffset = static_cast<uint32_t>(names.size());
+        o.nameBytes = static_cast<uint32_t>(store.ids[i].size());
+        o.isDebris = store.isDebris[i] ? 1 : 0;
+        names.append(store.ids[i]);
+        floats += static_cast<uint64_t>(o.samples) * components;
+    }
+    if (floats > numeric_limits<uint32_t>::max()) return TRACK_EXPORT_ERROR_FORMAT;
+
+    header.objectsOffset = sizeof(header);
+    header.namesOffset = static_cast<uint32_t>(header.objectsOffset + objects.size() * sizeof(TrackBlobObject));
+    header.namesBytes = static_cast<uint32_t>(names.size());
+    header.samplesOffset = static_cast<uint32_t>(align16(header.namesOffset + names.size()));
+    header.sampleFloats = static_cast<uint32_t>(floats);
+
+    // Write to a temporary name and move it into place, so the viewer never fetches a partial file
+    const string tmp = temp_file_path(path);
+    {
+        ofstream out(tmp, ios::binary | ios::trunc);
+        if (!out.is_open()) return TRACK_EXPORT_ERROR_IO;
+        out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+        out.write(reinterpret_cast<const char*>(objects.data()), objects.size() * sizeof(TrackBlobObject));
+        out.write(names.data(), names.size());
+        const char zeros[16] = {0};
+        out.write(zeros, header.samplesOffset - (header.namesOffset + names.size()));
+
+        // Transpose a block of objects at a time: each step row is read
+        // contiguously and scattered into per-object runs
+        vector<float> block;
+        for (size_t b = 0; b < store.count; b += OBJECT_BLOCK) {
+            const size_t e = min(store.count, b + OBJECT_BLOCK);
+            const size_t base = objects[b].firstFloat;
+            const size_t end = e < store.count ? objects[e].firstFloat : static_cast<size_t>(floats);
+            block.assign(end - base, 0.0f);
+            for (size_t k = 0; k < store.steps; ++k) {
+                for (uint32_t c = 0; c < components; ++c) {
+                    const auto* src = store.row(static_cast<int>(c), k);
+                    for (size_t i = b; i < e; ++i) {
+                        const TrackBlobObject& o = objects[i];
+                        if (k % o.stride) continue;
+                        block[o.firstFloat - base + (k / o.stride) * components + c] =
+                            static_cast<float>(src[i]);
+                    }
+                }
+            }
+            out.write(reinterpret_cast<const char*>(block.data()), block.size() * sizeof(float));
+        }
+        if (!out.good()) return TRACK_EXPORT_ERROR_IO;
+        NOVA_COUNT(COUNTER_BYTES_WRITTEN, out.tellp());
+    }
+    if (!commit_file(tmp, path)) return TRACK_EXPORT_ERROR_IO;
+    return TRACK_EXPORT_SUCCESS;
+}
+
+template <typename Store>
+int write_json(const string& path, const Store& store, const TrackExportOptions& options) {
+    JsonWriter jw;
+    if (!json_open(jw, path)) return TRACK_EXPORT_ERROR_IO;
+
+    const double startMs = store.steps ? store.time(0) : 0.0;
+    const double stopMs = store.steps ? store.time(store.steps - 1) : 0.0;
+    const double stepMs = store.steps > 1 ? store.time(1) - store.time(0) : 0.0;
+
+    json_write(jw, "{\n  \"timestamp_minutes\": ");
+    json_write_fixed(jw, (stopMs - startMs) / 60000.0, 6);
+    json_write(jw, ",\n  \"start_ms\": ");
+    json_write_fixed(jw, startMs, 0);
+    json_write(jw, ",\n  \"step_seconds\": ");
+    json_write_fixed(jw, stepMs / 1000.0, 6);
+    json_write(jw, ",\n  \"satellites\": [\n");
+
+    vector<double> series;
+    for (size_t i = 0; i < store.count && store.steps; ++i) {
+        double position[3], velocity[3];
+        for (int d = 0; d < 3; ++d) {
+            position[d] = store.row(STORE_X + d, store.steps - 1)[i];
+            velocity[d] = store.row(STORE_VX + d, store.steps - 1)[i];
+        }
+
+        json_write(jw, i ? ",\n    {\n      \"name\": " : "    {\n      \"name\": ");
+        json_write_string(jw, store.ids[i]);
+        json_write(jw, store.isDebris[i] ? ",\n      \"kind\": \"debris\"" : ",\n      \"kind\": \"satellite\"");
+        json_write(jw, ",\n      \"position_km\": [");
+        json_write_fixed_list(jw, position, 3, 6);
+        json_write(jw, "],\n      \"velocity_km_s\": [");
+        json_write_fixed_list(jw, velocity, 3, 6);
+        json_write(jw, "]");
+
+        if (options.series) {
+            const uint32_t stride = object_stride(store.isDebris, options, i);
+            series.clear();
+            for (size_t k = 0; k < store.steps; k += stride) {
+                series.push_back(store.row(STORE_X, k)[i]);
+                series.push_back(store.row(STORE_Y, k)[i]);
+                series.push_back(store.row(STORE_Z, k)[i]);
+            }
+            json_write(jw, ",\n      \"stride\": ");
+            json_write_fixed(jw, stride, 0);
+            json_write(jw, ",\n      \"positions_km\": [");
+            json_write_fixed_list(jw, series.data(), series.size(), options.decimals);
+            json_write(jw, "]");
+        }
+        json_write(jw, "\n    }");
+    }
+    json_write(jw, "\n  ]\n}\n");
+
+    return json_close(jw) ? TRACK_EXPORT_SUCCESS : TRACK_EXPORT_ERROR_IO;
+}
+
+} // namespace
+
+uint32_t export_stride(const TrajectoryStore& store, const TrackExportOptions& options, size_t i) {
+    return object_stride(store.isDebris, options, i);
+}
+
+int write_tracks_blob(const string& path, const TrajectoryStore& store,
+                      const TrackExportOptions& options) {
+    NOVA_SCOPE("write_tracks_blob");
+    return write_blob(path, store, options);
+}
+
+int write_tracks_blob(const string& path, const CompactStore& store,
+                      const TrackExportOptions& options) {
+    NOVA_SCOPE("write_tracks_blob");
+    return write_blob(path, store, options);
+}
+
+int write_tracks_json(const string& path, const TrajectoryStore& store,
+                      const TrackExportOptions& options) {
+    NOVA_SCOPE("write_tracks_json");
+    return write_json(path, store, options);
+}
+
+int write_tracks_json(const string& path, const CompactStore& store,
+                      const TrackExportOptions& options) {
+    NOVA_SCOPE("write_tracks_json");
+    return write_json(path, store, options);
+}
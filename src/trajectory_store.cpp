@@ -0,0 +1,130 @@
+#include "simplified_core.h"
+
+void store_resize(TrajectoryStore& store, size_t objects, size_t steps) {
+    store.count = objects;
+    store.steps = steps;
+    store.head = 0;
+    store.times.assign(steps, 0.0);
+    store.ids.assign(objects, string());
+    store.isDebris.assign(objects, false);
+    store.index.clear();
+    store.index.reserve(objects);
+    // single allocation for every plane
+    store.data.assign(static_cast<size_t>(STORE_COMPONENTS) * objects * steps, 0.0);
+}
+
+void store_grow(TrajectoryStore& store, size_t objects) {
+    if (objects <= store.count) return;
+    vector<double> data(static_cast<size_t>(STORE_COMPONENTS) * objects * store.steps,
+                        numeric_limits<double>::quiet_NaN());
+    for (int c = 0; c < STORE_COMPONENTS; ++c) {
+        for (size_t k = 0; k < store.steps; ++k) {
+            const double* src = store.row(c, k);
+            copy(src, src + store.count, data.data() + (c * store.steps + k) * objects);
+        }
+    }
+    store.data.swap(data);
+    store.head = 0;
+    store.count = objects;
+    store.ids.resize(objects);
+    store.isDebris.resize(objects, false);
+}
+
+void store_advance(TrajectoryStore& store, size_t steps) {
+    if (!store.steps) return;
+    if (steps > store.steps) steps = store.steps;
+
+    // New tail steps continue the grid at the current spacing, written into
+    // the slots the dropped steps free up
+    const double stepMs = store.steps > 1 ? store.time(1) - store.time(0) : 0.0;
+    const double last = store.time(store.steps - 1);
+    store.head = store.slot(steps % store.steps);
+    for (size_t s = 1; s <= steps; ++s) store.times[store.slot(store.steps - steps + s - 1)] = last + s * stepMs;
+}
+
+void store_add_id(TrajectoryStore& store, size_t i, const string& id, bool isDebris) {
+    store.ids[i] = id;
+    store.isDebris[i] = isDebris;
+    store.index.emplace(id, i); // keeps the first object when ids repeat
+}
+
+int store_find(const TrajectoryStore& store, const string& id) {
+    auto it = store.index.find(id);
+    return it == store.index.end() ? -1 : static_cast<int>(it->second);
+}
+
+size_t store_step_lower_bound(const TrajectoryStore& store, double t) {
+    size_t lo = 0, hi = store.steps;
+    while (lo < hi) {
+        const size_t mid = lo + (hi - lo) / 2;
+        if (store.time(mid) < t) lo = mid + 1; else hi = mid;
+    }
+    return lo;
+}
+
+size_t store_step_upper_bound(const TrajectoryStore& store, double t) {
+    size_t lo = 0, hi = store.steps;
+    while (lo < hi) {
+        const size_t mid = lo + (hi - lo) / 2;
+        if (!(t < store.time(mid))) lo = mid + 1; else hi = mid;
+    }
+    return lo;
+}
+
+State store_state(const TrajectoryStore& store, size_t i, size_t k) {
+    State s;
+    s.t = store.time(k);
+    s.x = store.row(STORE_X, k)[i];
+    s.y = store.row(STORE_Y, k)[i];
+    s.z = store.row(STORE_Z, k)[i];
+    s.vx = store.row(STORE_VX, k)[i];
+    s.vy = store.row(STORE_VY, k)[i];
+    s.vz = store.row(STORE_VZ, k)[i];
+    s.rad = sqrt(s.x*s.x + s.y*s.y + s.z*s.z); // radial distance; not stored
+    return s;
+}
+
+void store_set_state(TrajectoryStore& store, size_t i, size_t k, const State& s) {
+    store.row(STORE_X, k)[i] = s.x;
+    store.row(STORE_Y, k)[i] = s.y;
+    store.row(STORE_Z, k)[i] = s.z;
+    store.row(STORE_VX, k)[i] = s.vx;
+    store.row(STORE_VY, k)[i] = s.vy;
+    store.row(STORE_VZ, k)[i] = s.vz;
+}
+
+TrajectoryStore store_from_trajectories(const vector<Trajectory>& tracks) {
+    TrajectoryStore store;
+    if (tracks.empty()) return store;
+
+    // Store is rectangular: keep the common prefix of samples
+    size_t minSteps = tracks[0].states.size();
+    for (const auto& track : tracks) {
+        if (track.states.size() < minSteps) minSteps = track.states.size();
+    }
+
+    store_resize(store, tracks.size(), minSteps);
+    for (size_t k = 0; k < minSteps; ++k) {
+        store.times[k] = tracks[0].states[k].t;
+    }
+    for (size_t i = 0; i < tracks.size(); ++i) {
+        store_add_id(store, i, tracks[i].id, tracks[i].isDebris);
+        for (size_t k = 0; k < minSteps; ++k) {
+            store_set_state(store, i, k, tracks[i].states[k]);
+        }
+    }
+    return store;
+}
+
+vector<Trajectory> store_to_trajectories(const TrajectoryStore& store) {
+    vector<Trajectory> tracks(store.count);
+    for (size_t i = 0; i < store.count; ++i) {
+        tracks[i].id = store.ids[i];
+        tracks[i].isDebris = store.isDebris[i];
+        tracks[i].states.reserve(store.steps);
+        for (size_t k = 0; k < store.steps; ++k) {
+            tracks[i].states.push_back(store_state(store, i, k));
+        }
+    }
+    return tracks;
+}
@@ -1,5 +1,8 @@
 #include "types.h"
 #include "simplified_core.h"
+#include "tle_catalog.h"
+#include "json_writer.h"
+#include "instrumentation.h"
 
 //will be used later to determine the risk factor
 string severity_to_string(int level) {
@@ -27,63 +30,18 @@ string severity_to_string(int level) {
 //reading all the TLE data for each satellite
 vector<TLE> parseTLEfile(const string &filename){
     vector<TLE> tles;
-    ifstream file(filename);
+    TLECatalog catalog;
 
-    if(!file.is_open()){
+    if(!open_tle_catalog(filename, catalog)){
         cout<<"ERROR COULD NOT OPEN"<<endl;
         return tles;
     }
-    string line;
-    TLE current_tle{}; // value-initialize; name empty, line1/line2 indeterminate, we'll set them
-    // initialize C-style lines as empty strings
-    current_tle.line1[0] = '\0';
-    current_tle.line2[0] = '\0';
-
-    // small helper to copy std::string into fixed C buffer with truncation and null-termination
-    auto copy_to_cbuf = [](const string &src, char *dst, size_t cap){
-        size_t i = 0;
-        while (i < src.size() && (i + 1) < cap){
-            dst[i] = src[i];
-            ++i;
-        }
-        dst[i] = '\0';
-    };
-
-    while(getline(file,line)){
-        // remove trailing \r if present (Windows line endings)
-        if(!line.empty() && line.back()=='\r'){
-            line.pop_back();
-        }
-
-        // skip empty lines
-        if(line.empty()){continue;}
-
-        // name line (does not start with '1' or '2')
-        if(line[0]!='1' && line[0]!='2'){
-            // if previous TLE is complete, store it
-            if(!current_tle.name.empty() && current_tle.line1[0] != '\0' && current_tle.line2[0] != '\0'){
-                tles.push_back(current_tle);
-            }
-
-            // reset for new TLE
-            current_tle = TLE{};
-            current_tle.name = line; // set new satellite name
-            current_tle.line1[0] = '\0';
-            current_tle.line2[0] = '\0';
-        }
-        else if(line[0]=='1'){
-            copy_to_cbuf(line, current_tle.line1, sizeof(current_tle.line1));
-        }
-        else{ // line[0] == '2'
-            copy_to_cbuf(line, current_tle.line2, sizeof(current_tle.line2));
-        }
 
+    // records are indexed in place; copy them out into owned TLEs
+    tles.reserve(catalog.records.size());
+    for(const auto &view : catalog.records){
+        tles.push_back(tle_from_view(view));
     }
-    // push the final TLE only if complete
-    if(!current_tle.name.empty() && current_tle.line1[0] != '\0' && current_tle.line2[0] != '\0'){
-        tles.push_back(current_tle);
-    }
-    file.close();
 
     return tles;
 }
@@ -111,20 +69,193 @@ void writeTracksJSON(const vector<Trajectory>& tracks, double startMs, double st
     jf << "}\n";
 }
 
-void writeEncountersJSON(const vector<Encounter>& encounters) {
-    ofstream jf("tests/conjunctions.json");
-    jf << "{\n";
-    jf << "  \"timestamp_minutes\": " << fixed << setprecision(6) << 1440.0 << ",\n";
-    jf << "  \"conjunction_pairs\": [\n";
-    
+namespace {
+
+const char* const CONJUNCTIONS_JSON = "tests/conjunctions.json";
+
+// One conjunction_pairs entry; times are minutes after startMs. With a pass,
+// the entry also carries its window.
+void write_conjunction(JsonWriter& jw, const Encounter& enc, const vector<string>& ids,
+                       double startMs, bool first, const EncounterPass* pass = nullptr) {
+    json_write(jw, first ? "    {\n      \"satellite_a\": " : ",\n    {\n      \"satellite_a\": ");
+    json_write_string(jw, ids[enc.aIndex]);
+    json_write(jw, ",\n      \"satellite_b\": ");
+    json_write_string(jw, ids[enc.bIndex]);
+    json_write(jw, ",\n      \"time_minutes\": ");
+    json_write_fixed(jw, (enc.t - startMs) / 60000.0, 6);
+    json_write(jw, ",\n      \"distance_km\": ");
+    json_write_fixed(jw, enc.miss_m / 1000.0, 6);
+    json_write(jw, ",\n      \"relative_velocity_km_s\": ");
+    json_write_fixed(jw, enc.rel_mps / 1000.0, 6);
+    json_write(jw, ",\n      \"severity\": ");
+    json_write_string(jw, severity_to_string(enc.severity));
+
+    // Probabilities span many orders of magnitude, so they are written in
+    // exponent form; null when the probability stage did not run
+    json_write(jw, ",\n      \"collision_probability\": ");
+    if (std::isfinite(enc.pc)) {
+        char text[32];
+        const int n = snprintf(text, sizeof(text), "%.6e", enc.pc);
+        json_write(jw, text, static_cast<size_t>(n));
+    } else {
+        json_write(jw, "null");
+    }
+    if (pass) {
+        json_write(jw, ",\n      \"entry_minutes\": ");
+        json_write_fixed(jw, (pass->entry - startMs) / 60000.0, 6);
+        json_write(jw, ",\n      \"exit_minutes\": ");
+        json_write_fixed(jw, (pass->exit - startMs) / 60000.0, 6);
+    }
+    json_write(jw, "\n    }");
+}
+
+void write_conjunctions_header(JsonWriter& jw, double timestampMinutes) {
+    json_write(jw, "{\n  \"timestamp_minutes\": ");
+    json_write_fixed(jw, timestampMinutes, 6);
+    json_write(jw, ",\n  \"conjunction_pairs\": [\n");
+}
+
+void write_conjunctions_footer(JsonWriter& jw) {
+    json_write(jw, "\n  ]\n}\n");
+}
+
+} // namespace
+
+void writeEncountersJSON(const vector<Encounter>& encounters, const vector<string>& ids,
+                         double startMs) {
+    NOVA_SCOPE("write_encounters_json");
+    JsonWriter jw;
+    if (!json_open(jw, CONJUNCTIONS_JSON)) {
+        cout << "ERROR COULD NOT WRITE " << CONJUNCTIONS_JSON << endl;
+        return;
+    }
+    write_conjunctions_header(jw, 1440.0);
     for (size_t k = 0; k < encounters.size(); ++k) {
-        const auto& enc = encounters[k];
-        jf << "    {\n";
-        jf << "      \"sat1\": { \"name\": \"" << enc.aId << "\", \"position_km\": [0, 0, 0] },\n";
-        jf << "      \"sat2\": { \"name\": \"" << enc.bId << "\", \"position_km\": [0, 0, 0] },\n";
-        jf << "      \"distance_km\": " << fixed << setprecision(6) << enc.miss_m / 1000.0 << "\n";
-        jf << "    }" << (k + 1 < encounters.size() ? ",\n" : "\n");
+        write_conjunction(jw, encounters[k], ids, startMs, k == 0);
     }
-    jf << "  ]\n";
-    jf << "}\n";
-}
\ No newline at end of file
+    write_conjunctions_footer(jw);
+    json_close(jw);
+}
+
+bool writeEncountersJSON(const string& path, const vector<Encounter>& encounters,
+                         const TrajectoryStore& store) {
+    const double startMs = store.steps ? store.time(0) : 0.0;
+    const double stopMs = store.steps ? store.time(store.steps - 1) : 0.0;
+    return writeEncountersJSON(path, encounters, store.ids, startMs, stopMs);
+}
+
+bool writeEncountersJSON(const string& path, const vector<Encounter>& encounters,
+                         const vector<string>& ids, double startMs, double stopMs,
+                         bool timeOrder) {
+    NOVA_SCOPE("write_encounters_json");
+    JsonWriter jw;
+    if (!json_open(jw, path)) {
+        cout << "ERROR COULD NOT WRITE " << path << endl;
+        return false;
+    }
+
+    vector<uint32_t> order(encounters.size());
+    for (size_t e = 0; e < order.size(); ++e) order[e] = static_cast<uint32_t>(e);
+    if (timeOrder) {
+        sort(order.begin(), order.end(), [&](uint32_t a, uint32_t b) {
+            const Encounter& x = encounters[a];
+            const Encounter& y = encounters[b];
+            if (x.t != y.t) return x.t < y.t;
+            if (x.aIndex != y.aIndex) return x.aIndex < y.aIndex;
+            return x.bIndex < y.bIndex;
+        });
+    }
+
+    write_conjunctions_header(jw, (stopMs - startMs) / 60000.0);
+    for (size_t e = 0; e < order.size(); ++e) {
+        write_conjunction(jw, encounters[order[e]], ids, startMs, e == 0);
+    }
+    write_conjunctions_footer(jw);
+    if (!json_close(jw)) {
+        cout << "ERROR COULD NOT WRITE " << path << endl;
+        return false;
+    }
+    return true;
+}
+
+bool writePassesJSON(const string& path, const vector<EncounterPass>& passes,
+                     const TrajectoryStore& store) {
+    NOVA_SCOPE("write_passes_json");
+    JsonWriter jw;
+    if (!json_open(jw, path)) {
+        cout << "ERROR COULD NOT WRITE " << path << endl;
+        return false;
+    }
+
+    vector<uint32_t> order(passes.size());
+    for (size_t p = 0; p < order.size(); ++p) order[p] = static_cast<uint32_t>(p);
+    sort(order.begin(), order.end(), [&](uint32_t a, uint32_t b) {
+        const Encounter& x = passes[a].tca;
+        const Encounter& y = passes[b].tca;
+        if (x.t != y.t) return x.t < y.t;
+        if (x.aIndex != y.aIndex) return x.aIndex < y.aIndex;
+        return x.bIndex < y.bIndex;
+    });
+
+    const double startMs = store.steps ? store.time(0) : 0.0;
+    const double stopMs = store.steps ? store.time(store.steps - 1) : 0.0;
+    write_conjunctions_header(jw, (stopMs - startMs) / 60000.0);
+    for (size_t p = 0; p < order.size(); ++p) {
+        const EncounterPass& pass = passes[order[p]];
+        write_conjunction(jw, pass.tca, store.ids, startMs, p == 0, &pass);
+    }
+    write_conjunctions_footer(jw);
+    if (!json_close(jw)) {
+        cout << "ERROR COULD NOT WRITE " << path << endl;
+        return false;
+    }
+    return true;
+}
+
+size_t streamConjunctionsJSON(const TrajectoryStore& store, double threshold_m,
+                              const ScreeningOptions& options) {
+    size_t count = 0;
+    streamConjunctionsJSON(CONJUNCTIONS_JSON, store, threshold_m, options, &count);
+    return count;
+}
+
+bool streamConjunctionsJSON(const string& path, const TrajectoryStore& store, double threshold_m,
+                            const ScreeningOptions& options, size_t* count) {
+    NOVA_SCOPE("stream_conjunctions_json");
+    if (count) *count = 0;
+    JsonWriter jw;
+    if (!json_open(jw, path)) {
+        cout << "ERROR COULD NOT WRITE " << path << endl;
+        return false;
+    }
+
+    const double startMs = store.steps ? store.time(0) : 0.0;
+    const double stopMs = store.steps ? store.time(store.steps - 1) : 0.0;
+    write_conjunctions_header(jw, (stopMs - startMs) / 60000.0);
+    json_flush(jw);
+
+    // Each batch is written and flushed as soon as screening produces it, so a
+    // reader polling the file sees encounters while the pass is still running
+    bool first = true;
+    const size_t total = screen_by_threshold_streaming(store, threshold_m, options,
+        [&](const Encounter* batch, size_t n) {
+            for (size_t e = 0; e < n; ++e) {
+                write_conjunction(jw, batch[e], store.ids, startMs, first);
+                first = false;
+            }
+            json_flush(jw);
+        });
+
+    if (count) *count = total;
+    write_conjunctions_footer(jw);
+    if (!json_close(jw)) {
+        cout << "ERROR COULD NOT WRITE " << path << endl;
+        return false;
+    }
+    cout << "Streamed " << total << " conjunctions to " << path << endl;
+    return true;
+}
+
+size_t streamConjunctionsJSON(const vector<Trajectory>& tracks, double threshold_m) {
+    return streamConjunctionsJSON(store_from_trajectories(tracks), threshold_m);
+}
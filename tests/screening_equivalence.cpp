@@ -0,0 +1,515 @@
+// Screening checks on the built-in catalogs:
+//  - screen_by_threshold's grid broad phase finds exactly the first samples of
+//    a brute-force all-pairs loop
+//  - screen_by_threshold and screen_by_thresholds give the same result on one
+//    thread as on several
+//  - screen_passes finds exactly the runs of samples within the threshold of
+//    a brute-force walk of every pair, on one thread and on several
+//  - the alternative screens (adaptive pair walk, lazy ephemeris, compact
+//    store, streaming) report exactly its encounters, with and without the
+//    prefilter, refinement and Pc
+//  - a rolling window reports every pass start screen_passes finds over the
+//    window it ends on, and keeps its screened boundary near the horizon end
+//  - a screening session updated with a few TLEs holds, and its diff turns
+//    the previous encounters into, a fresh screen of the updated catalog
+// Run from the source tree (ctest sets the working directory), since the
+// catalogs are read from data/.
+
+#include "simplified_core.h"
+#include "propagation.h"
+#include "orbit_prefilter.h"
+#include "collision_probability.h"
+#include "tca_refine.h"
+#include "lazy_ephemeris.h"
+#include "compact_store.h"
+#include "distance_kernel.h"
+#include "rolling_screen.h"
+#include "screening_session.h"
+#include <cstring>
+#include <map>
+
+namespace {
+
+// 2024-12-23 18:40 UTC, the pipeline's default start; a short window keeps
+// the Debug build quick
+const double START_MS = 1734979200000.0;
+const double STEP_SECONDS = 60.0;
+const double DURATION_HOURS = 4.0;
+
+bool same_encounter(const Encounter& a, const Encounter& b) {
+    return a.aIndex == b.aIndex && a.bIndex == b.bIndex && a.t == b.t && a.miss_m == b.miss_m &&
+           a.rel_mps == b.rel_mps && a.severity == b.severity &&
+           (a.pc == b.pc || (std::isnan(a.pc) && std::isnan(b.pc)));
+}
+
+// Element-by-element match, order included; reports the first difference
+bool check(const string& label, const vector<Encounter>& expected, const vector<Encounter>& got) {
+    if (expected.size() != got.size()) {
+        cout << "FAIL " << label << ": " << got.size() << " encounters, expected "
+             << expected.size() << endl;
+        return false;
+    }
+    for (size_t e = 0; e < expected.size(); ++e) {
+        if (!same_encounter(expected[e], got[e])) {
+            cout << "FAIL " << label << ": encounter " << e << " (" << got[e].aIndex << ", "
+                 << got[e].bIndex << ") differs" << endl;
+            return false;
+        }
+    }
+    return true;
+}
+
+// The O(N^2 T) loop the grid replaced: each pair's first sample within
+// threshold_m, in (i, j) order, with the fields an unrefined screen reports
+vector<Encounter> brute_force_first_hits(const TrajectoryStore& store, double threshold_m) {
+    const size_t n = store.count;
+    vector<uint32_t> first(n * n, UINT32_MAX);
+    for (size_t k = 0; k < store.steps; ++k) {
+        const double* xs = store.row(STORE_X, k);
+        const double* ys = store.row(STORE_Y, k);
+        const double* zs = store.row(STORE_Z, k);
+        for (size_t i = 0; i < n; ++i) {
+            for (size_t j = i + 1; j < n; ++j) {
+                if (first[i * n + j] != UINT32_MAX) continue;
+                const double distance_m = separation_m(xs[i] - xs[j], ys[i] - ys[j], zs[i] - zs[j]);
+                if (distance_m <= threshold_m) first[i * n + j] = static_cast<uint32_t>(k);
+            }
+        }
+    }
+
+    vector<Encounter> out;
+    for (size_t i = 0; i < n; ++i) {
+        for (size_t j = i + 1; j < n; ++j) {
+            const uint32_t k = first[i * n + j];
+            if (k == UINT32_MAX) continue;
+            double dv2 = 0.0;
+            for (int c = STORE_VX; c <= STORE_VZ; ++c) {
+                const double d = store.row(c, k)[j] - store.row(c, k)[i];
+                dv2 += d * d;
+            }
+            Encounter e;
+            e.t = store.time(k);
+            e.miss_m = separation_m(store.row(STORE_X, k)[i] - store.row(STORE_X, k)[j],
+                                    store.row(STORE_Y, k)[i] - store.row(STORE_Y, k)[j],
+                                    store.row(STORE_Z, k)[i] - store.row(STORE_Z, k)[j]);
+            e.rel_mps = sqrt(dv2) * 1000.0;
+            e.severity = severity_level(e.miss_m, threshold_m);
+            e.aIndex = static_cast<uint32_t>(i);
+            e.bIndex = static_cast<uint32_t>(j);
+            out.push_back(e);
+        }
+    }
+    return out;
+}
+
+// Every pair's runs of consecutive samples within threshold_m, walked step by
+// step: entry and exit at the run's first and last sample and the closest
+// (earliest if tied) sample as its encounter, in (pair, entry) order
+vector<EncounterPass> brute_force_runs(const TrajectoryStore& store, double threshold_m) {
+    const size_t n = store.count;
+    vector<uint32_t> first(n * n, UINT32_MAX);
+    vector<uint32_t> closest(n * n);
+    vector<double> closest_m(n * n);
+    vector<EncounterPass> out;
+    auto close = [&](size_t i, size_t j, size_t last) {
+        const size_t p = i * n + j;
+        const size_t k = closest[p];
+        double dv2 = 0.0;
+        for (int c = STORE_VX; c <= STORE_VZ; ++c) {
+            const double d = store.row(c, k)[j] - store.row(c, k)[i];
+            dv2 += d * d;
+        }
+        EncounterPass pass;
+        pass.tca.t = store.time(k);
+        pass.tca.miss_m = closest_m[p];
+        pass.tca.rel_mps = sqrt(dv2) * 1000.0;
+        pass.tca.severity = severity_level(closest_m[p], threshold_m);
+        pass.tca.aIndex = static_cast<uint32_t>(i);
+        pass.tca.bIndex = static_cast<uint32_t>(j);
+        pass.entry = store.time(first[p]);
+        pass.exit = store.time(last);
+        out.push_back(pass);
+        first[p] = UINT32_MAX;
+    };
+    for (size_t k = 0; k < store.steps; ++k) {
+        const double* xs = store.row(STORE_X, k);
+        const double* ys = store.row(STORE_Y, k);
+        const double* zs = store.row(STORE_Z, k);
+        for (size_t i = 0; i < n; ++i) {
+            for (size_t j = i + 1; j < n; ++j) {
+                const size_t p = i * n + j;
+                const double distance_m = separation_m(xs[i] - xs[j], ys[i] - ys[j], zs[i] - zs[j]);
+                if (!(distance_m <= threshold_m)) {
+                    if (first[p] != UINT32_MAX) close(i, j, k - 1);
+                    continue;
+                }
+                if (first[p] == UINT32_MAX) {
+                    first[p] = static_cast<uint32_t>(k);
+                } else if (!(distance_m < closest_m[p])) {
+                    continue;
+                }
+                closest[p] = static_cast<uint32_t>(k);
+                closest_m[p] = distance_m;
+            }
+        }
+    }
+    for (size_t i = 0; i < n; ++i) {
+        for (size_t j = i + 1; j < n; ++j) {
+            if (first[i * n + j] != UINT32_MAX) close(i, j, store.steps - 1);
+        }
+    }
+    sort(out.begin(), out.end(), [](const EncounterPass& a, const EncounterPass& b) {
+        if (a.tca.aIndex != b.tca.aIndex) return a.tca.aIndex < b.tca.aIndex;
+        if (a.tca.bIndex != b.tca.bIndex) return a.tca.bIndex < b.tca.bIndex;
+        return a.entry < b.entry;
+    });
+    return out;
+}
+
+// check() for approach windows: closest approach, entry and exit
+bool check_passes(const string& label, const vector<EncounterPass>& expected,
+                  const vector<EncounterPass>& got) {
+    if (expected.size() != got.size()) {
+        cout << "FAIL " << label << ": " << got.size() << " passes, expected " << expected.size() << endl;
+        return false;
+    }
+    for (size_t p = 0; p < expected.size(); ++p) {
+        if (!same_encounter(expected[p].tca, got[p].tca) || expected[p].entry != got[p].entry ||
+            expected[p].exit != got[p].exit) {
+            cout << "FAIL " << label << ": pass " << p << " (" << got[p].tca.aIndex << ", "
+                 << got[p].tca.bIndex << ") differs" << endl;
+            return false;
+        }
+    }
+    return true;
+}
+
+// Pair and time of an encounter, in (pair, time) order
+typedef tuple<uint32_t, uint32_t, double> PassStart;
+
+// Opens a rolling window over the check window and advances it a few times.
+// Without refinement, the pass starts reported along the way that fall in the
+// final window must be exactly the entries screen_passes finds there (a pass
+// entering at step 0 may have started before it, and the last step is not
+// screened yet). With refinement, passes still open at the horizon end may
+// hold the screened boundary back by at most ROLLING_MAX_HOLD_STEPS, and the
+// boundary must never move back in time. Returns the number of failures.
+size_t check_rolling(const PipelineCatalog& catalog, double threshold_m, size_t& checks) {
+    const size_t ADVANCE_STEPS = 10;
+    const double stepMs = STEP_SECONDS * 1000.0;
+    size_t failures = 0;
+    for (bool refine : {false, true}) {
+        const string label = "rolling " + to_string(static_cast<int>(threshold_m)) + " m" +
+                             (refine ? " refine" : "");
+        ScreeningOptions options;
+        options.threads = 2;
+        options.refineTca = refine;
+        options.refineMargin_m = refine ? refine_margin_for_step(STEP_SECONDS) : 0.0;
+
+        RollingScreen window;
+        vector<Encounter> found;
+        if (rolling_open(window, catalog, START_MS, STEP_SECONDS, DURATION_HOURS, threshold_m,
+                         options, found) != ROLLING_SUCCESS) {
+            cout << "FAIL " << label << ": could not open the window" << endl;
+            return failures + 1;
+        }
+        vector<Encounter> reported = found;
+        double boundary = -HUGE_VAL;
+        for (int advance = 0; advance <= 3; ++advance) {
+            if (advance) {
+                rolling_advance(window, window.store.time(0) + ADVANCE_STEPS * stepMs, found);
+                reported.insert(reported.end(), found.begin(), found.end());
+            }
+            const TrajectoryStore& store = window.store;
+            const size_t ready = store.steps - 1;
+            const size_t lag = refine ? ROLLING_MAX_HOLD_STEPS : 0;
+            const double screenedUntil = store.time(window.screenedSteps);
+            if (window.screenedSteps + lag < ready || window.screenedSteps > ready ||
+                screenedUntil < boundary) {
+                cout << "FAIL " << label << ": screened to step " << window.screenedSteps << " of "
+                     << store.steps << " after " << advance << " advances" << endl;
+                ++failures;
+            }
+            boundary = screenedUntil;
+            ++checks;
+        }
+        if (refine) continue;
+
+        const TrajectoryStore& store = window.store;
+        vector<PassStart> expected;
+        for (const EncounterPass& pass : screen_passes(store, threshold_m, options)) {
+            const size_t entry = store_step_lower_bound(store, pass.entry);
+            if (entry >= 1 && entry + 1 < store.steps) {
+                expected.emplace_back(pass.tca.aIndex, pass.tca.bIndex, pass.entry);
+            }
+        }
+        vector<PassStart> got;
+        for (const Encounter& e : reported) {
+            if (e.t >= store.time(1) && e.t < store.time(store.steps - 1)) {
+                got.emplace_back(e.aIndex, e.bIndex, e.t);
+            }
+        }
+        sort(expected.begin(), expected.end());
+        sort(got.begin(), got.end());
+        if (expected.empty() || got != expected) {
+            cout << "FAIL " << label << ": " << got.size() << " pass starts, expected "
+                 << expected.size() << endl;
+            ++failures;
+        }
+        ++checks;
+    }
+    return failures;
+}
+
+// TLE of another object renumbered as catalogNumber, so an update moves it
+// onto a different orbit
+TLE renumbered(const TLE& source, uint32_t catalogNumber) {
+    TLE tle = source;
+    char number[8];
+    snprintf(number, sizeof(number), "%05u", catalogNumber);
+    memcpy(tle.line1 + 2, number, 5);
+    memcpy(tle.line2 + 2, number, 5);
+    return tle;
+}
+
+// Opens a session, moves two objects that have encounters onto other orbits
+// and adds one new object. Returns the number of failures.
+size_t check_session(const PipelineCatalog& catalog, double threshold_m, size_t& checks) {
+    const string label = "session " + to_string(static_cast<int>(threshold_m)) + " m";
+    PcOptions probability;
+    ScreeningOptions options;
+    options.threads = 2;
+    options.refineTca = true;
+    options.refineMargin_m = refine_margin_for_step(STEP_SECONDS);
+    options.probability = &probability;
+
+    ScreeningSession session;
+    if (session_open(session, catalog, START_MS, STEP_SECONDS, DURATION_HOURS, threshold_m,
+                     options) != SESSION_SUCCESS) {
+        cout << "FAIL " << label << ": could not open the session" << endl;
+        return 1;
+    }
+    const vector<Encounter> before = session_encounters(session);
+    if (before.empty()) {
+        cout << "FAIL " << label << ": no encounters to update" << endl;
+        return 1;
+    }
+
+    // Source records by catalog number; the first free number is the new object's
+    unordered_map<uint32_t, TLE> records;
+    for (const CatalogInput& input : default_catalog_inputs()) {
+        for (const TLE& tle : parseTLEfile(input.path)) {
+            records.emplace(tle_catalog_number(tle.line1, strnlen(tle.line1, sizeof(tle.line1))), tle);
+        }
+    }
+    uint32_t fresh = 1;
+    while (records.count(fresh)) ++fresh;
+
+    const uint32_t a = catalog.catalogNumbers[before.front().aIndex];
+    const uint32_t b = catalog.catalogNumbers[before.back().bIndex];
+    const uint32_t source = catalog.catalogNumbers[before.front().bIndex];
+    if (!records.count(a) || !records.count(b) || !records.count(source)) {
+        cout << "FAIL " << label << ": missing source TLEs" << endl;
+        return 1;
+    }
+    TLE added = renumbered(records[a], fresh);
+    memcpy(added.line2 + 7, records[source].line2 + 7, sizeof(added.line2) - 7);
+    const vector<TLE> updates = {renumbered(records[source], a), renumbered(records[a], b), added};
+
+    // Reference: the same update applied to the catalog and screened from scratch
+    PipelineCatalog updated = catalog;
+    for (const TLE& tle : updates) {
+        const uint32_t number = tle_catalog_number(tle.line1, strnlen(tle.line1, sizeof(tle.line1)));
+        OrbitalElements elements;
+        if (tle_to_elements(&tle, &elements) != PROPAGATION_SUCCESS) {
+            cout << "FAIL " << label << ": could not parse an update" << endl;
+            return 1;
+        }
+        const auto known = session.byCatalogNumber.find(number);
+        if (known != session.byCatalogNumber.end()) {
+            updated.elements[known->second] = elements;
+            continue;
+        }
+        updated.elements.push_back(elements);
+        updated.ids.push_back(tle.name);
+        updated.isDebris.push_back(false);
+        updated.catalogNumbers.push_back(number);
+    }
+    TrajectoryStore store;
+    if (propagate_catalog(updated, START_MS, STEP_SECONDS, DURATION_HOURS, store) != PROPAGATION_SUCCESS) {
+        cout << "FAIL " << label << ": could not propagate the updated catalog" << endl;
+        return 1;
+    }
+    const vector<Encounter> expected = screen_by_threshold(store, threshold_m, options);
+
+    EncounterDiff diff;
+    if (session_update(session, updates, diff) != SESSION_SUCCESS) {
+        cout << "FAIL " << label << ": update rejected" << endl;
+        return 1;
+    }
+    size_t failures = !check(label + " update", expected, session_encounters(session));
+
+    // Previous encounters with the diff applied; removed and previous entries
+    // must be the encounters they replace
+    const size_t n = updated.elements.size();
+    map<uint64_t, Encounter> applied;
+    for (const Encounter& e : before) applied[pair_key(e.aIndex, e.bIndex, n)] = e;
+    bool consistent = diff.changed.size() == diff.previous.size() &&
+                      diff.added.size() + diff.removed.size() + diff.changed.size() > 0;
+    for (const Encounter& e : diff.removed) {
+        const auto it = applied.find(pair_key(e.aIndex, e.bIndex, n));
+        consistent = consistent && it != applied.end() && same_encounter(it->second, e);
+        if (it != applied.end()) applied.erase(it);
+    }
+    for (size_t c = 0; consistent && c < diff.changed.size(); ++c) {
+        const auto it = applied.find(pair_key(diff.changed[c].aIndex, diff.changed[c].bIndex, n));
+        consistent = it != applied.end() && same_encounter(it->second, diff.previous[c]);
+        if (consistent) it->second = diff.changed[c];
+    }
+    for (const Encounter& e : diff.added) {
+        consistent = consistent && applied.emplace(pair_key(e.aIndex, e.bIndex, n), e).second;
+    }
+    if (!consistent) {
+        cout << "FAIL " << label << ": diff does not match the previous encounters" << endl;
+        ++failures;
+    }
+    vector<Encounter> patched;
+    for (const auto& entry : applied) patched.push_back(entry.second);
+    failures += !check(label + " diff", expected, patched);
+    checks += 3;
+    return failures;
+}
+
+} // namespace
+
+int main() {
+    PipelineCatalog catalog;
+    if (load_catalog_inputs(default_catalog_inputs(), catalog) != PROPAGATION_SUCCESS ||
+        catalog.elements.size() < 2) {
+        cout << "FAIL could not load the built-in catalogs from data/" << endl;
+        return 1;
+    }
+
+    TrajectoryStore store;
+    CompactStore compact;
+    if (propagate_catalog(catalog, START_MS, STEP_SECONDS, DURATION_HOURS, store) != PROPAGATION_SUCCESS ||
+        compact_store_propagate(catalog, START_MS, STEP_SECONDS, DURATION_HOURS, compact) !=
+            COMPACT_STORE_SUCCESS) {
+        cout << "FAIL could not propagate the built-in catalogs" << endl;
+        return 1;
+    }
+
+    size_t checks = 0;
+    size_t failures = 0;
+    size_t flagged = 0;
+    for (double threshold_m : {5000.0, 50000.0}) {
+        PairPrefilter prefilter;
+        if (build_pair_prefilter(catalog.elements, START_MS, DURATION_HOURS,
+                                 threshold_m + PREFILTER_PAD_M, prefilter) != PREFILTER_SUCCESS) {
+            cout << "FAIL could not build the prefilter" << endl;
+            return 1;
+        }
+        // Broad phase and approach windows against brute-force references
+        {
+            ScreeningOptions options;
+            options.threads = 2;
+            const vector<Encounter> reference = brute_force_first_hits(store, threshold_m);
+            const vector<Encounter> screened = screen_by_threshold(store, threshold_m, options);
+            failures += !check("threshold " + to_string(static_cast<int>(threshold_m)) + " m brute force",
+                               reference, screened);
+            flagged += reference.size();
+            ++checks;
+
+            // Every window, including runs that cross the workers' step chunks
+            const vector<EncounterPass> runs = brute_force_runs(store, threshold_m);
+            for (unsigned threads : {1u, 4u}) {
+                ScreeningOptions passOptions;
+                passOptions.threads = threads;
+                failures += !check_passes("threshold " + to_string(static_cast<int>(threshold_m)) +
+                                              " m passes " + to_string(threads) + " threads",
+                                          runs, screen_passes(store, threshold_m, passOptions));
+            }
+            flagged += runs.size();
+            checks += 2;
+        }
+
+        for (int flags = 0; flags < 8; ++flags) {
+            const bool usePrefilter = (flags & 1) != 0;
+            const bool refine = (flags & 2) != 0;
+            const bool pc = (flags & 4) != 0;
+            if (pc && !refine) continue; // Pc is scored at the refined closest approach
+
+            PcOptions probability;
+            ScreeningOptions options;
+            options.threads = 2;
+            options.refineTca = refine;
+            options.refineMargin_m = refine ? refine_margin_for_step(STEP_SECONDS) : 0.0;
+            if (usePrefilter) options.prefilter = &prefilter;
+            if (pc) options.probability = &probability;
+
+            const string label = "threshold " + to_string(static_cast<int>(threshold_m)) + " m" +
+                                 (usePrefilter ? " prefilter" : "") + (refine ? " refine" : "") +
+                                 (pc ? " pc" : "");
+            const vector<Encounter> expected = screen_by_threshold(store, threshold_m, options);
+            flagged += expected.size();
+
+            // Parallel runs must match the serial path exactly, order included
+            ScreeningOptions serial = options;
+            serial.threads = 1;
+            ScreeningOptions wide = options;
+            wide.threads = 4;
+            failures += !check(label + " 1 thread", expected, screen_by_threshold(store, threshold_m, serial));
+            failures += !check(label + " 4 threads", expected, screen_by_threshold(store, threshold_m, wide));
+            const vector<double> tiers = {threshold_m, threshold_m / 2.0};
+            const vector<EncounterTier> serialTiers = screen_by_thresholds(store, tiers, serial);
+            for (unsigned threads : {2u, 4u}) {
+                ScreeningOptions parallel = options;
+                parallel.threads = threads;
+                const vector<EncounterTier> parallelTiers = screen_by_thresholds(store, tiers, parallel);
+                for (size_t t = 0; t < tiers.size(); ++t) {
+                    failures += !check(label + " tier " + to_string(t) + " " + to_string(threads) + " threads",
+                                       serialTiers[t].encounters, parallelTiers[t].encounters);
+                }
+            }
+
+            failures += !check(label + " adaptive", expected,
+                               screen_by_threshold_adaptive(store, threshold_m, options));
+            failures += !check(label + " compact", expected, screen_compact(compact, threshold_m, options));
+
+            // Streaming delivers the same encounters in the conjunction writers' order
+            vector<Encounter> timeOrdered = expected;
+            sort_encounters_by_time(timeOrdered.data(), timeOrdered.size());
+            vector<Encounter> streamed;
+            screen_by_threshold_streaming(store, threshold_m, options,
+                [&](const Encounter* batch, size_t n) { streamed.insert(streamed.end(), batch, batch + n); });
+            failures += !check(label + " streaming", timeOrdered, streamed);
+
+            // A roomy cache and one too small for a chunk per object
+            for (size_t cacheBytes : {size_t(64) << 20, size_t(256) << 10}) {
+                LazyEphemeris eph;
+                if (lazy_ephemeris_open(eph, catalog, START_MS, STEP_SECONDS, DURATION_HOURS,
+                                        cacheBytes) != LAZY_EPHEMERIS_SUCCESS) {
+                    cout << "FAIL could not open the lazy ephemeris" << endl;
+                    return 1;
+                }
+                failures += !check(label + " lazy " + to_string(cacheBytes >> 10) + " KB", expected,
+                                   screen_lazy(eph, threshold_m, options));
+            }
+            checks += 11;
+        }
+    }
+
+    // Wide enough that some pairs stay within the screening distance for the
+    // whole window, as co-orbiting objects do over longer horizons
+    failures += check_rolling(catalog, 200000.0, checks);
+    failures += check_session(catalog, 50000.0, checks);
+
+    // Equal empty results would prove nothing
+    if (!flagged) {
+        cout << "FAIL no encounters flagged by any configuration" << endl;
+        return 1;
+    }
+    cout << checks - failures << " of " << checks << " screening checks passed (" << flagged
+         << " reference encounters)" << endl;
+    return failures ? 1 : 0;
+}